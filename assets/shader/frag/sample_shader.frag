@@ -1,6 +1,6 @@
 #version 460
 
-layout(binding = 3) uniform sampler2D texSampler;
+layout(binding = 3) uniform sampler2DArray texSampler;
 
 layout(binding = 4) uniform Timer {
   float time;
@@ -10,6 +10,12 @@ layout(binding = 5) uniform Mouse {
   vec2 pos;
 } mouse;
 
+// where the image sits in the atlas: rect in UV units and layer
+layout(binding = 6) uniform AtlasRegion {
+  vec4 uvRect;
+  uint layer;
+} atlasRegion;
+
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 layout(location = 2) in vec3 fragPosition;
@@ -436,6 +442,8 @@ void main()
   color = CreateCanvas(st);
   color = CreateCanvas(_st);
 
+  // the quad does not repeat its texture, so the coordinate is clamped rather than wrapped into the region
+  vec2 atlasTexCoord = atlasRegion.uvRect.xy + clamp(fragTexCoord, 0., 1.) * atlasRegion.uvRect.zw;
   outColor = sin(timer.time * 0.7f) * vec4(color, 1.)
-          + cos(timer.time * 0.8f) * texture(texSampler, fragTexCoord);
+          + cos(timer.time * 0.8f) * texture(texSampler, vec3(atlasTexCoord, float(atlasRegion.layer)));
 }
\ No newline at end of file
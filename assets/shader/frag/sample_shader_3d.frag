@@ -2,6 +2,11 @@
 
 layout(binding = 1) uniform sampler2D texSampler;
 
+layout(push_constant) uniform MaterialConstants
+{
+    vec4 diffuseColor;
+} material;
+
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 
@@ -9,5 +14,5 @@ layout(location = 0) out vec4 outColor;
 
 void main()
 {
-    outColor = texture(texSampler, fragTexCoord);
+    outColor = texture(texSampler, fragTexCoord) * vec4(fragColor, 1.0) * material.diffuseColor;
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 460
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    vec4 texCoordTransform; // xy: offset, zw: scale
+} ubo;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = ubo.texCoordTransform.xy + inTexCoord * ubo.texCoordTransform.zw;
+}
\ No newline at end of file
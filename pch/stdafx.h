@@ -9,8 +9,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/hash.hpp>
+#include <glm/gtc/packing.hpp>
 
-#define TINYOBJLOADER_USE_DOUBLE
 #include <tiny_obj_loader.h>
 
 #include <opencv2/opencv.hpp>
@@ -37,6 +37,17 @@
 #include <cstdlib>
 #include <array>
 #include <variant>
+#include <tuple>
 #include <optional>
 #include <random>
 #include <numbers>
+#include <span>
+#include <limits>
+#include <bit>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <deque>
+#include <atomic>
+#include <charconv>
+#include <numeric>
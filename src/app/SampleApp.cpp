@@ -10,7 +10,7 @@ void SampleApp::Initialize()
 	const auto& window = hephics::window::Manager::GetWindow();
 
 	hephics::GPUHandler::AddGraphicPurpose({ "render", "copy" });
-	hephics::GPUHandler::AddComputePurpose({ "particle" });
+	hephics::GPUHandler::AddComputePurpose({ "particle", "meshlet_cull" });
 	hephics::GPUHandler::InitializeInstance();
 
 	m_sceneDictionary.emplace("first", [] { return std::make_shared<SampleScene>("first"); });
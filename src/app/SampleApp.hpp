@@ -61,12 +61,25 @@ public:
 class SampleActor : public hephics::actor::Actor
 {
 private:
+	hephics::asset::AssetHandle<cv::Mat> m_cvMatHandle;
+	hephics::asset::AssetHandle<hephics::asset::Texture> m_textureHandle;
+	hephics::asset::AssetHandle<hephics::asset::Object3D> m_object3DHandle;
+	uint32_t m_lodIdx = 0U;
+	uint32_t m_materialSetNum = 1U; // descriptor sets per frame: the actor's texture, then one per material
+	std::shared_ptr<hephics::culling::MeshletCuller> m_ptrMeshletCuller = nullptr; // compute path, else m_visibleRanges
+	std::vector<hephics::asset::DrawRange> m_visibleRanges;
+
 	virtual void LoadData() override;
 	virtual void SetPipeline() override;
 
 public:
 	SampleActor() {}
-	~SampleActor() {}
+	~SampleActor()
+	{
+		hephics::asset::Manager::Release(m_cvMatHandle);
+		hephics::asset::Manager::Release(m_textureHandle);
+		hephics::asset::Manager::Release(m_object3DHandle);
+	}
 
 	virtual void Initialize() override;
 	virtual void Update() override;
@@ -76,12 +89,22 @@ public:
 class SampleActorAnother : public hephics::actor::Actor
 {
 private:
+	hephics::asset::AssetHandle<hephics::asset::TextureAtlas> m_textureAtlasHandle;
+	hephics::asset::AssetHandle<hephics::asset::Texture3D> m_texture3DHandle;
+
 	virtual void LoadData() override;
 	virtual void SetPipeline() override;
 
 public:
 	SampleActorAnother() = default;
-	~SampleActorAnother() {}
+	~SampleActorAnother()
+	{
+		hephics::asset::Manager::Release(m_textureAtlasHandle);
+		hephics::asset::Manager::Release(m_texture3DHandle);
+	}
+
+	// also known before any actor exists, so a scene can pre-warm the pipeline; adds the shaders
+	static vk_interface::graphic::PipelineBuilder GetPipelineBuilder();
 
 	virtual void Initialize() override;
 	virtual void Update() override;
@@ -9,24 +9,38 @@ void SampleActor::LoadData()
 	const auto& swap_chain = gpu_instance->GetSwapChain();
 	const auto& ref_descriptor_set = m_ptrRenderer->GetDescriptorSet();
 
-	hephics::asset::Manager::RegistTexture("sample_3d.png", "room");
-	hephics::asset::Manager::RegistObject3D("sample_3d.obj", "room");
-
-	vk::DescriptorSetLayoutBinding vertex_uniform_layout_binding(0, vk::DescriptorType::eUniformBuffer,
-		1, vk::ShaderStageFlagBits::eVertex, nullptr);
-	vk::DescriptorSetLayoutBinding fragment_sampler_layout_binding(1, vk::DescriptorType::eCombinedImageSampler,
-		1, vk::ShaderStageFlagBits::eFragment, nullptr);
-	auto desc_layout_bindings = std::vector{ vertex_uniform_layout_binding, fragment_sampler_layout_binding };
-	ref_descriptor_set->SetDescriptorSetLayout(logical_device, desc_layout_bindings);
-
-	vk::DescriptorPoolSize uniform_desc_pool_size(vk::DescriptorType::eUniformBuffer, hephics::BUFFERING_FRAME_NUM);
-	vk::DescriptorPoolSize  sampler_desc_pool_size(vk::DescriptorType::eCombinedImageSampler, hephics::BUFFERING_FRAME_NUM);
-	auto desc_pool_size_list = std::vector{ uniform_desc_pool_size, sampler_desc_pool_size };
-	vk::DescriptorPoolCreateInfo desc_pool_create_info(
-		vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, hephics::BUFFERING_FRAME_NUM, desc_pool_size_list);
-	ref_descriptor_set->SetDescriptorPool(logical_device, desc_pool_create_info);
-
-	ref_descriptor_set->SetDescriptorSet(logical_device, hephics::BUFFERING_FRAME_NUM);
+	m_textureHandle = hephics::asset::Manager::RegistTexture("sample_3d.png", "room");
+	m_cvMatHandle = hephics::asset::Manager::FindHandle<cv::Mat>("room");
+	// the cooker's default levels of detail and meshlets, a pack cooked with other ones is not used for this mesh
+	hephics::asset::ModelLoadSettings load_settings{};
+	load_settings.vertex_layout = hephics::asset::VertexLayoutType::compact;
+	load_settings.lod_num = 4U;
+	load_settings.use_meshlets = true;
+	m_object3DHandle = hephics::asset::Manager::RegistObject3D("sample_3d.obj", "room", load_settings);
+
+	// quantized layouts carry no vertex color and need the texcoord transform
+	const auto vert_shader_path =
+		hephics::asset::Manager::GetObject3D(m_object3DHandle)->GetVertexLayoutType() == hephics::asset::VertexLayoutType::standard
+		? "vert/sample_shader_3d.vert" : "vert/sample_shader_3d_quantized.vert";
+	auto shader_futures = vk_interface::component::ShaderProvider::AddShaders(logical_device,
+		{ vert_shader_path, "frag/sample_shader_3d.frag" }, "room");
+	for (auto& shader_future : shader_futures)
+		shader_future.get();
+
+	// the layout is the one the shaders declare
+	ref_descriptor_set->SetDescriptorSetLayout(logical_device, vk_interface::component::ShaderProvider::GetLayoutBindings(
+		{ vk_interface::component::ShaderProvider::GetShader("vert", "room"),
+		vk_interface::component::ShaderProvider::GetShader("frag", "room") }));
+
+	// one set per frame and material: the first one samples the actor's texture, the others a material texture,
+	// which is a white one for a material without a diffuse map
+	const auto& material_texture_handles = hephics::asset::Manager::GetObject3D(m_object3DHandle)->GetMaterialTextureHandles();
+	m_materialSetNum = static_cast<uint32_t>(material_texture_handles.size()) + 1U;
+	const auto desc_set_num = hephics::BUFFERING_FRAME_NUM * m_materialSetNum;
+
+	ref_descriptor_set->SetDescriptorPool(logical_device, desc_set_num);
+
+	ref_descriptor_set->SetDescriptorSet(logical_device, desc_set_num);
 
 	const auto position_uniform_buffer_size = sizeof(decltype(*m_ptrPosition));
 	auto& uniform_buffers_map = m_ptrRenderer->GetUniformBuffersMap();
@@ -34,13 +48,16 @@ void SampleActor::LoadData()
 	for (auto& uniform_buffer : uniform_buffers_map.at("position"))
 		uniform_buffer.reset(new hephics_helper::UniformBuffer(gpu_instance, position_uniform_buffer_size));
 
-	for (size_t idx = 0; idx < hephics::BUFFERING_FRAME_NUM; idx++)
+	for (size_t idx = 0; idx < desc_set_num; idx++)
 	{
 		const auto& uniform_buffers = uniform_buffers_map.at("position");
 		vk::DescriptorBufferInfo buffer_info(
-			uniform_buffers.at(idx)->GetBuffer().get(), 0, position_uniform_buffer_size);
+			uniform_buffers.at(idx / m_materialSetNum)->GetBuffer().get(), 0, position_uniform_buffer_size);
 
-		const auto& texture = hephics::asset::Manager::GetTexture("room");
+		const auto material_set_idx = idx % m_materialSetNum;
+		const auto& texture = material_set_idx > 0U
+			? hephics::asset::Manager::GetTexture(material_texture_handles.at(material_set_idx - 1U))
+			: hephics::asset::Manager::GetTexture(m_textureHandle);
 		vk::DescriptorImageInfo image_info(texture->GetSampler().get(),
 			texture->GetImage()->GetView().get(), vk::ImageLayout::eShaderReadOnlyOptimal);
 
@@ -56,59 +73,22 @@ void SampleActor::SetPipeline()
 	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	const auto& render_pass = gpu_instance->GetSwapChain()->GetRenderPass();
-	auto& ref_descriptor_set = m_ptrRenderer->GetDescriptorSet();
-	auto& ref_graphic_pipeline = m_ptrRenderer->GetGraphicPipeline();
 
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "vert/sample_shader_3d.vert", "room");
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "frag/sample_shader_3d.frag", "room");
+	const auto& object_3d = hephics::asset::Manager::GetObject3D(m_object3DHandle);
 
+	// added by LoadData
 	const auto& vert_shader_module = vk_interface::component::ShaderProvider::GetShader("vert", "room");
 	const auto& frag_shader_module = vk_interface::component::ShaderProvider::GetShader("frag", "room");
 
-	vk::PipelineShaderStageCreateInfo vert_shader_stage_info({}, vk::ShaderStageFlagBits::eVertex,
-		vert_shader_module->GetModule().get(), "main");
-	vk::PipelineShaderStageCreateInfo frag_shader_stage_info({}, vk::ShaderStageFlagBits::eFragment,
-		frag_shader_module->GetModule().get(), "main");
-
-	const auto shader_stages = { vert_shader_stage_info, frag_shader_stage_info };
-
-	auto vertex_binding_descs = std::vector{ hephics::asset::VertexData::get_binding_description() };
-	auto vertex_attribute_descs = hephics::asset::VertexData::get_attribute_descriptions();
-	vk::PipelineVertexInputStateCreateInfo vertex_input_info({}, vertex_binding_descs, vertex_attribute_descs);
-
-	vk::PipelineInputAssemblyStateCreateInfo input_assembly({}, vk::PrimitiveTopology::eTriangleList, VK_FALSE);
-
-	vk::PipelineViewportStateCreateInfo viewport_state({}, 1, {}, 1, {});
-
-	vk::PipelineRasterizationStateCreateInfo rasterizer({}, VK_FALSE, VK_FALSE,
-		vk::PolygonMode::eFill, vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise,
-		VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f);
-
-	vk::PipelineMultisampleStateCreateInfo multisampling({}, gpu_instance->GetMultiSampleCount(), VK_FALSE);
-
-	vk::PipelineDepthStencilStateCreateInfo depth_stencil({}, VK_TRUE, VK_TRUE,
-		vk::CompareOp::eLess, VK_FALSE, VK_FALSE);
-
-	vk::PipelineColorBlendAttachmentState color_blend_attachment(VK_FALSE);
-	color_blend_attachment.setColorWriteMask(
-		vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
-		| vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
-
-	vk::PipelineColorBlendStateCreateInfo color_blending({}, VK_FALSE, vk::LogicOp::eCopy, 1, &color_blend_attachment);
-
-	std::vector<vk::DynamicState> dynamic_states =
-	{
-		vk::DynamicState::eScissor, vk::DynamicState::eViewport
-	};
-	vk::PipelineDynamicStateCreateInfo dynamic_state_info({}, dynamic_states);
-
-	vk::PipelineLayoutCreateInfo pipeline_layout_info({}, ref_descriptor_set->GetDescriptorSetLayout().get());
-	ref_graphic_pipeline->SetLayout(logical_device, pipeline_layout_info);
-
-	vk::GraphicsPipelineCreateInfo pipeline_info({}, shader_stages, &vertex_input_info, &input_assembly, {},
-		&viewport_state, &rasterizer, &multisampling, &depth_stencil, &color_blending, &dynamic_state_info,
-		ref_graphic_pipeline->GetLayout().get(), render_pass.get());
-	ref_graphic_pipeline->SetPipeline(logical_device, pipeline_info);
+	// actors of one vertex layout share the pipeline, it compiles on a worker while the scene loads
+	vk_interface::graphic::PipelineBuilder pipeline_builder;
+	pipeline_builder.AddShaderStage(vk::ShaderStageFlagBits::eVertex, vert_shader_module->GetModule().get())
+		.AddShaderStage(vk::ShaderStageFlagBits::eFragment, frag_shader_module->GetModule().get())
+		.SetVertexInput({ object_3d->GetVertexBindingDescription() }, object_3d->GetVertexAttributeDescriptions())
+		.SetSampleCount(gpu_instance->GetMultiSampleCount())
+		.SetLayout(logical_device, { vert_shader_module, frag_shader_module })
+		.SetRenderPass(render_pass.get());
+	m_ptrRenderer->SetGraphicPipeline(pipeline_builder.BuildAsync(logical_device, gpu_instance->GetPipelineCache()));
 }
 
 void SampleActor::Initialize()
@@ -120,19 +100,34 @@ void SampleActor::Initialize()
 	LoadData();
 	SetPipeline();
 
+	{
+		const auto& object_3d = hephics::asset::Manager::GetObject3D(m_object3DHandle);
+		// the compute path draws every meshlet with one descriptor set
+		if (!object_3d->GetMeshlets().empty() && m_materialSetNum == 1U
+			&& hephics::GPUHandler::GetComputePurpose().contains("meshlet_cull"))
+		{
+			m_ptrMeshletCuller = std::make_shared<hephics::culling::MeshletCuller>(object_3d);
+			m_ptrMeshletCuller->Initialize();
+		}
+	}
+
 	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 
 	{
-		const auto& texture = hephics::asset::Manager::GetTexture("room");
-		const auto& cv_mat = hephics::asset::Manager::GetCvMat("room");
-		texture->CopyTexture(cv_mat);
+		// a texture shared with an earlier scene is uploaded already and its image may be trimmed
+		const auto& texture = hephics::asset::Manager::GetTexture(m_textureHandle);
+		if (texture->IsCooked())
+			texture->CopyTexture();
+		else if (!texture->IsTextureCopied())
+			texture->CopyTexture(hephics::asset::Manager::GetCvMat(m_cvMatHandle));
 	}
 
 	{
-		const auto& object_3d = hephics::asset::Manager::GetObject3D("room");
+		const auto& object_3d = hephics::asset::Manager::GetObject3D(m_object3DHandle);
 		object_3d->CopyVertexBuffer();
 		object_3d->CopyIndexBuffer();
+		object_3d->CopyMaterialTextures();
 	}
 
 	for (const auto& attachment : m_attachments)
@@ -162,12 +157,29 @@ void SampleActor::Update()
 	const auto& mouse_scroll = hephics::window::Manager::GetMouseScroll();
 	scroll += mouse_scroll;
 
-	m_ptrPosition->model = glm::rotate(glm::mat4(1.0), glm::radians(60.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	const auto& object_3d = hephics::asset::Manager::GetObject3D(m_object3DHandle);
+	const auto& vertex_quantization = object_3d->GetVertexQuantization();
+
+	const auto model = glm::rotate(glm::mat4(1.0), glm::radians(60.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	m_ptrPosition->model = model * vertex_quantization.GetDequantizationMatrix();
+	m_ptrPosition->tex_coord_transform = vertex_quantization.GetTexCoordTransform();
 	m_ptrPosition->view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f + scroll[1] / 500.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 	m_ptrPosition->projection = glm::perspective(glm::radians(45.0f + scroll[0] / 200.0f),
 		swap_chain->GetExtent2D().width / static_cast<float_t>(swap_chain->GetExtent2D().height), 0.1f, 10.0f);
 	m_ptrPosition->projection[1][1] *= -1;
 
+	m_lodIdx = object_3d->SelectLod(m_ptrPosition->view * model, m_ptrPosition->projection,
+		static_cast<float_t>(swap_chain->GetExtent2D().height));
+
+	// meshlets cover the full mesh only
+	if (m_lodIdx == 0U && !object_3d->GetMeshlets().empty())
+	{
+		if (m_ptrMeshletCuller)
+			m_ptrMeshletCuller->Update(this);
+		else
+			object_3d->CullMeshlets(m_ptrPosition->view * model, m_ptrPosition->projection, m_visibleRanges);
+	}
+
 	std::memcpy(uniform_address, m_ptrPosition.get(), sizeof(decltype(*m_ptrPosition)));
 	uniform_buffer->Unmapping(logical_device);
 }
@@ -179,18 +191,59 @@ void SampleActor::Render()
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	const auto& swap_chain = gpu_instance->GetSwapChain();
 	const auto& render_command_buffer = gpu_instance->GetGraphicCommandBuffer("render")->GetCommandBuffer();
-	const auto& pipeline = m_ptrRenderer->GetGraphicPipeline();
-	const auto& desc_set =
-		m_ptrRenderer->GetDescriptorSet()->GetDescriptorSet(swap_chain->GetCurrentFrameId());
-
-	const auto& object_3d = hephics::asset::Manager::GetObject3D("room");
-
-	render_command_buffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline().get());
-	render_command_buffer->bindVertexBuffers(0, { object_3d->GetVertexBuffer()->GetBuffer().get() }, { 0 });
-	render_command_buffer->bindIndexBuffer(object_3d->GetIndexBuffer()->GetBuffer().get(), 0, vk::IndexType::eUint32);
-	render_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-		pipeline->GetLayout().get(), 0, desc_set.get(), nullptr);
-	render_command_buffer->drawIndexed(static_cast<uint32_t>(object_3d->GetIndices().size()), 1, 0, 0, 0);
+	const auto& pipeline = m_ptrRenderer->GetReadyGraphicPipeline();
+	const auto& ref_descriptor_set = m_ptrRenderer->GetDescriptorSet();
+	const auto frame_set_idx = swap_chain->GetCurrentFrameId() * m_materialSetNum;
+
+	const auto& object_3d = hephics::asset::Manager::GetObject3D(m_object3DHandle);
+	const auto& materials = object_3d->GetMaterials();
+
+	// still compiling: the actor sits this frame out, its attachments do not
+	if (pipeline)
+	{
+		// every range shares the vertex and index buffer, only the material's descriptor set and color change between draws
+		render_command_buffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline().get());
+		render_command_buffer->bindVertexBuffers(0, { object_3d->GetVertexBuffer()->GetBuffer().get() }, { 0 });
+		render_command_buffer->bindIndexBuffer(object_3d->GetIndexBuffer()->GetBuffer().get(), 0, object_3d->GetIndexType());
+
+		if (m_lodIdx == 0U && m_ptrMeshletCuller)
+		{
+			render_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+				pipeline->GetLayout().get(), 0, ref_descriptor_set->GetDescriptorSet(frame_set_idx).get(), nullptr);
+			render_command_buffer->pushConstants<glm::vec4>(pipeline->GetLayout().get(),
+				vk::ShaderStageFlagBits::eFragment, 0U, glm::vec4(1.0f));
+			m_ptrMeshletCuller->DrawIndirect(render_command_buffer);
+		}
+		else
+		{
+			const auto draw_ranges = m_lodIdx == 0U && !object_3d->GetMeshlets().empty()
+				? std::span<const hephics::asset::DrawRange>(m_visibleRanges) : object_3d->GetDrawRanges(m_lodIdx);
+
+			auto bound_set_idx = std::numeric_limits<size_t>::max();
+			for (const auto& draw_range : draw_ranges)
+			{
+				// a range without a material, or with one the library no longer defines, falls back to the actor's texture in white
+				const auto material_set_idx = static_cast<uint32_t>(draw_range.material_id + 1);
+				const auto is_material_found = material_set_idx > 0U && material_set_idx < m_materialSetNum;
+				const auto set_idx = frame_set_idx + (is_material_found ? material_set_idx : 0U);
+				if (set_idx != bound_set_idx)
+				{
+					render_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+						pipeline->GetLayout().get(), 0, ref_descriptor_set->GetDescriptorSet(set_idx).get(), nullptr);
+
+					// the material's Kd, pushed for the fragment shader as the compact layout has no vertex color
+					const auto diffuse_color = is_material_found
+						? glm::vec4(materials.at(material_set_idx - 1U).diffuse[0], materials.at(material_set_idx - 1U).diffuse[1],
+							materials.at(material_set_idx - 1U).diffuse[2], 1.0f)
+						: glm::vec4(1.0f);
+					render_command_buffer->pushConstants<glm::vec4>(pipeline->GetLayout().get(),
+						vk::ShaderStageFlagBits::eFragment, 0U, diffuse_color);
+					bound_set_idx = set_idx;
+				}
+				render_command_buffer->drawIndexed(draw_range.index_count, 1, draw_range.first_index, draw_range.vertex_offset, 0);
+			}
+		}
+	}
 
 	for (const auto& attachment : m_attachments)
 		attachment->Render();
@@ -1,5 +1,19 @@
 #include "../SampleApp.hpp"
 
+// the descriptor set layout is reflected from them, so they are added before any descriptor set exists;
+// the calling thread compiles too, so this also runs on a worker for Prewarm
+static std::vector<std::shared_ptr<vk_interface::component::Shader>> add_shaders(const vk::UniqueDevice& logical_device)
+{
+	static const std::array<std::string, 2> shader_code_paths{ "vert/sample_shader.vert", "frag/sample_shader.frag" };
+	hephics_helper::WorkerPool::ParallelFor(shader_code_paths.size(), [&logical_device](const size_t& path_idx)
+		{
+			vk_interface::component::ShaderProvider::AddShader(logical_device, shader_code_paths.at(path_idx), "lenna");
+		});
+
+	return { vk_interface::component::ShaderProvider::GetShader("vert", "lenna"),
+		vk_interface::component::ShaderProvider::GetShader("frag", "lenna") };
+}
+
 void SampleActorAnother::LoadData()
 {
 	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
@@ -9,9 +23,8 @@ void SampleActorAnother::LoadData()
 	const auto& swap_chain = gpu_instance->GetSwapChain();
 	const auto& ref_descriptor_set = m_ptrRenderer->GetDescriptorSet();
 
-	auto lenna_image = cv::imread("assets/img/sample_2d.png");
-	cv::cvtColor(lenna_image, lenna_image, cv::COLOR_BGR2RGBA);
-	hephics::asset::Manager::RegistTexture("lenna", lenna_image);
+	// lenna is sampled from an atlas layer, the shader maps the quad's texcoords into its region
+	m_textureAtlasHandle = hephics::asset::Manager::RegistTextureAtlas({ "sample_2d.png" }, "sample_atlas");
 
 	static const auto vertices = std::vector<hephics::asset::VertexData>{
 		{{-0.5f, -0.5f, 0.f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
@@ -32,26 +45,11 @@ void SampleActorAnother::LoadData()
 	};
 
 	const hephics::asset::Texture3D texture_3d = hephics::asset::Texture3D(vertices, indices);
-	hephics::asset::Manager::RegistTexture3D(texture_3d, "lenna");
-
-	vk::DescriptorSetLayoutBinding vertex_uniform_layout_binding(2, vk::DescriptorType::eUniformBuffer,
-		1, vk::ShaderStageFlagBits::eVertex, nullptr);
-	vk::DescriptorSetLayoutBinding fragment_sampler_layout_binding(3, vk::DescriptorType::eCombinedImageSampler,
-		1, vk::ShaderStageFlagBits::eFragment, nullptr);
-	vk::DescriptorSetLayoutBinding fragment_timer_layout_binding(4, vk::DescriptorType::eUniformBuffer,
-		1, vk::ShaderStageFlagBits::eFragment, nullptr);
-	vk::DescriptorSetLayoutBinding fragment_mouse_layout_binding(5, vk::DescriptorType::eUniformBuffer,
-		1, vk::ShaderStageFlagBits::eFragment, nullptr);
-	auto desc_layout_bindings = std::vector
-	{ vertex_uniform_layout_binding, fragment_sampler_layout_binding, fragment_timer_layout_binding, fragment_mouse_layout_binding };
-	ref_descriptor_set->SetDescriptorSetLayout(logical_device, desc_layout_bindings);
-
-	vk::DescriptorPoolSize uniform_desc_pool_size(vk::DescriptorType::eUniformBuffer, hephics::BUFFERING_FRAME_NUM);
-	vk::DescriptorPoolSize  sampler_desc_pool_size(vk::DescriptorType::eCombinedImageSampler, hephics::BUFFERING_FRAME_NUM);
-	auto desc_pool_size_list = std::vector{ uniform_desc_pool_size, sampler_desc_pool_size, uniform_desc_pool_size, uniform_desc_pool_size };
-	vk::DescriptorPoolCreateInfo desc_pool_create_info(
-		vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, hephics::BUFFERING_FRAME_NUM, desc_pool_size_list);
-	ref_descriptor_set->SetDescriptorPool(logical_device, desc_pool_create_info);
+	m_texture3DHandle = hephics::asset::Manager::RegistTexture3D(texture_3d, "lenna");
+
+	ref_descriptor_set->SetDescriptorSetLayout(logical_device,
+		vk_interface::component::ShaderProvider::GetLayoutBindings(add_shaders(logical_device)));
+	ref_descriptor_set->SetDescriptorPool(logical_device, hephics::BUFFERING_FRAME_NUM);
 
 	ref_descriptor_set->SetDescriptorSet(logical_device, hephics::BUFFERING_FRAME_NUM);
 
@@ -71,6 +69,24 @@ void SampleActorAnother::LoadData()
 	for (auto& uniform_buffer : uniform_buffers_map.at("cursor"))
 		uniform_buffer.reset(new hephics_helper::UniformBuffer(gpu_instance, cursor_uniform_buffer_size));
 
+	// std140: the rect, then the layer; it never changes, so every frame's buffer is written once here
+	const auto& texture_atlas = hephics::asset::Manager::GetTextureAtlas(m_textureAtlasHandle);
+	const auto& atlas_region = texture_atlas->GetRegion("sample_2d.png");
+	struct
+	{
+		glm::vec4 uv_rect;
+		uint32_t layer;
+	} atlas_region_block{ atlas_region.uv_rect, atlas_region.layer };
+
+	const auto atlas_region_uniform_buffer_size = sizeof(atlas_region_block);
+	uniform_buffers_map["atlas_region"] = {};
+	for (auto& uniform_buffer : uniform_buffers_map.at("atlas_region"))
+	{
+		uniform_buffer.reset(new hephics_helper::UniformBuffer(gpu_instance, atlas_region_uniform_buffer_size));
+		std::memcpy(uniform_buffer->Mapping(logical_device), &atlas_region_block, atlas_region_uniform_buffer_size);
+		uniform_buffer->Unmapping(logical_device);
+	}
+
 	for (size_t idx = 0; idx < hephics::BUFFERING_FRAME_NUM; idx++)
 	{
 		const auto& position_uniform_buffers = uniform_buffers_map.at("position");
@@ -85,78 +101,51 @@ void SampleActorAnother::LoadData()
 		vk::DescriptorBufferInfo cursor_buffer_info(
 			cursor_uniform_buffers.at(idx)->GetBuffer().get(), 0, cursor_uniform_buffer_size);
 
-		const auto& texture = hephics::asset::Manager::GetTexture("lenna");
-		vk::DescriptorImageInfo image_info(texture->GetSampler().get(),
-			texture->GetImage()->GetView().get(), vk::ImageLayout::eShaderReadOnlyOptimal);
+		const auto& atlas_region_uniform_buffers = uniform_buffers_map.at("atlas_region");
+		vk::DescriptorBufferInfo atlas_region_buffer_info(
+			atlas_region_uniform_buffers.at(idx)->GetBuffer().get(), 0, atlas_region_uniform_buffer_size);
+
+		vk::DescriptorImageInfo image_info(texture_atlas->GetSampler().get(),
+			texture_atlas->GetImage()->GetView().get(), vk::ImageLayout::eShaderReadOnlyOptimal);
 
 		vk::WriteDescriptorSet position_buffer_write_desc_set({}, 2, 0, vk::DescriptorType::eUniformBuffer, nullptr, position_buffer_info, nullptr);
 		vk::WriteDescriptorSet image_write_desc_set({}, 3, 0, vk::DescriptorType::eCombinedImageSampler, image_info, nullptr, nullptr);
 		vk::WriteDescriptorSet timer_write_desc_set({}, 4, 0, vk::DescriptorType::eUniformBuffer, nullptr, timer_buffer_info, nullptr);
 		vk::WriteDescriptorSet cursor_write_desc_set({}, 5, 0, vk::DescriptorType::eUniformBuffer, nullptr, cursor_buffer_info, nullptr);
+		vk::WriteDescriptorSet atlas_region_write_desc_set({}, 6, 0, vk::DescriptorType::eUniformBuffer, nullptr, atlas_region_buffer_info, nullptr);
 		auto write_descriptor_sets = std::vector
-		{ position_buffer_write_desc_set, image_write_desc_set, timer_write_desc_set, cursor_write_desc_set };
+		{ position_buffer_write_desc_set, image_write_desc_set, timer_write_desc_set, cursor_write_desc_set,
+			atlas_region_write_desc_set };
 		ref_descriptor_set->UpdateDescriptorSet(logical_device, idx, std::move(write_descriptor_sets));
 	}
 }
 
-void SampleActorAnother::SetPipeline()
+vk_interface::graphic::PipelineBuilder SampleActorAnother::GetPipelineBuilder()
 {
 	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	const auto& render_pass = gpu_instance->GetSwapChain()->GetRenderPass();
-	const auto& ref_descriptor_set = m_ptrRenderer->GetDescriptorSet();
-	const auto& ref_graphic_pipeline = m_ptrRenderer->GetGraphicPipeline();
-
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "vert/sample_shader.vert", "lenna");
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "frag/sample_shader.frag", "lenna");
-
-	const auto& vert_shader_module = vk_interface::component::ShaderProvider::GetShader("vert", "lenna");
-	const auto& frag_shader_module = vk_interface::component::ShaderProvider::GetShader("frag", "lenna");
-
-	vk::PipelineShaderStageCreateInfo vert_shader_stage_info({}, vk::ShaderStageFlagBits::eVertex,
-		vert_shader_module->GetModule().get(), "main");
-	vk::PipelineShaderStageCreateInfo frag_shader_stage_info({}, vk::ShaderStageFlagBits::eFragment,
-		frag_shader_module->GetModule().get(), "main");
-
-	const auto shader_stages = { vert_shader_stage_info, frag_shader_stage_info };
 
-	auto vertex_binding_descs = std::vector{ hephics::asset::VertexData::get_binding_description() };
-	auto vertex_attribute_descs = hephics::asset::VertexData::get_attribute_descriptions();
-	vk::PipelineVertexInputStateCreateInfo vertex_input_info({}, vertex_binding_descs, vertex_attribute_descs);
+	const auto shaders = add_shaders(logical_device);
 
-	vk::PipelineInputAssemblyStateCreateInfo input_assembly({}, vk::PrimitiveTopology::eTriangleList, VK_FALSE);
+	vk_interface::graphic::PipelineBuilder pipeline_builder;
+	pipeline_builder.AddShaderStage(vk::ShaderStageFlagBits::eVertex, shaders.at(0)->GetModule().get())
+		.AddShaderStage(vk::ShaderStageFlagBits::eFragment, shaders.at(1)->GetModule().get())
+		.SetVertexInput({ hephics::asset::VertexData::get_binding_description() },
+			hephics::asset::VertexData::get_attribute_descriptions())
+		.SetSampleCount(gpu_instance->GetMultiSampleCount())
+		.SetLayout(logical_device, shaders)
+		.SetRenderPass(render_pass.get());
 
-	vk::PipelineViewportStateCreateInfo viewport_state({}, 1, {}, 1, {});
-
-	vk::PipelineRasterizationStateCreateInfo rasterizer({}, VK_FALSE, VK_FALSE,
-		vk::PolygonMode::eFill, vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise,
-		VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f);
-
-	vk::PipelineMultisampleStateCreateInfo multisampling({}, gpu_instance->GetMultiSampleCount(), VK_FALSE);
-
-	vk::PipelineDepthStencilStateCreateInfo depth_stencil({}, VK_TRUE, VK_TRUE,
-		vk::CompareOp::eLess, VK_FALSE, VK_FALSE);
-
-	vk::PipelineColorBlendAttachmentState color_blend_attachment(VK_FALSE);
-	color_blend_attachment.setColorWriteMask(
-		vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
-		| vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
-
-	vk::PipelineColorBlendStateCreateInfo color_blending({}, VK_FALSE, vk::LogicOp::eCopy, 1, &color_blend_attachment);
-
-	std::vector<vk::DynamicState> dynamic_states =
-	{
-		vk::DynamicState::eScissor, vk::DynamicState::eViewport
-	};
-	vk::PipelineDynamicStateCreateInfo dynamic_state_info({}, dynamic_states);
+	return pipeline_builder;
+}
 
-	vk::PipelineLayoutCreateInfo pipeline_layout_info({}, ref_descriptor_set->GetDescriptorSetLayout().get());
-	ref_graphic_pipeline->SetLayout(logical_device, pipeline_layout_info);
+void SampleActorAnother::SetPipeline()
+{
+	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
 
-	vk::GraphicsPipelineCreateInfo pipeline_info({}, shader_stages, &vertex_input_info, &input_assembly, {},
-		&viewport_state, &rasterizer, &multisampling, &depth_stencil, &color_blending, &dynamic_state_info,
-		ref_graphic_pipeline->GetLayout().get(), render_pass.get());
-	ref_graphic_pipeline->SetPipeline(logical_device, pipeline_info);
+	m_ptrRenderer->SetGraphicPipeline(GetPipelineBuilder().BuildAsync(logical_device, gpu_instance->GetPipelineCache()));
 }
 
 void SampleActorAnother::Initialize()
@@ -170,14 +159,10 @@ void SampleActorAnother::Initialize()
 	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 
-	{
-		const auto& texture = hephics::asset::Manager::GetTexture("lenna");
-		const auto& cv_mat = hephics::asset::Manager::GetCvMat("lenna");
-		texture->CopyTexture(cv_mat);
-	}
+	hephics::asset::Manager::GetTextureAtlas(m_textureAtlasHandle)->CopyTexture();
 
 	{
-		const auto& texture_3d = hephics::asset::Manager::GetTexture3D("lenna");
+		const auto& texture_3d = hephics::asset::Manager::GetTexture3D(m_texture3DHandle);
 		texture_3d->CopyVertexBuffer();
 		texture_3d->CopyIndexBuffer();
 	}
@@ -251,18 +236,22 @@ void SampleActorAnother::Render()
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	const auto& swap_chain = gpu_instance->GetSwapChain();
 	const auto& render_command_buffer = gpu_instance->GetGraphicCommandBuffer("render")->GetCommandBuffer();
-	const auto& pipeline = m_ptrRenderer->GetGraphicPipeline();
+	const auto& pipeline = m_ptrRenderer->GetReadyGraphicPipeline();
 	const auto& desc_set =
 		m_ptrRenderer->GetDescriptorSet()->GetDescriptorSet(swap_chain->GetCurrentFrameId());
 
-	const auto& texture_3d = hephics::asset::Manager::GetTexture3D("lenna");
+	const auto& texture_3d = hephics::asset::Manager::GetTexture3D(m_texture3DHandle);
 
-	render_command_buffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline().get());
-	render_command_buffer->bindVertexBuffers(0, { texture_3d->GetVertexBuffer()->GetBuffer().get() }, { 0 });
-	render_command_buffer->bindIndexBuffer(texture_3d->GetIndexBuffer()->GetBuffer().get(), 0, vk::IndexType::eUint32);
-	render_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-		pipeline->GetLayout().get(), 0, desc_set.get(), nullptr);
-	render_command_buffer->drawIndexed(static_cast<uint32_t>(texture_3d->GetIndices().size()), 1, 0, 0, 0);
+	if (pipeline)
+	{
+		render_command_buffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline().get());
+		render_command_buffer->bindVertexBuffers(0, { texture_3d->GetVertexBuffer()->GetBuffer().get() }, { 0 });
+		render_command_buffer->bindIndexBuffer(texture_3d->GetIndexBuffer()->GetBuffer().get(), 0, texture_3d->GetIndexType());
+		render_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+			pipeline->GetLayout().get(), 0, desc_set.get(), nullptr);
+		for (const auto& draw_range : texture_3d->GetDrawRanges())
+			render_command_buffer->drawIndexed(draw_range.index_count, 1, draw_range.first_index, draw_range.vertex_offset, 0);
+	}
 
 	for (auto& attachment : m_attachments)
 		attachment->Render();
@@ -24,6 +24,11 @@ void SampleScene::Initialize()
 		});
 	m_actors.emplace_back(std::make_shared<SampleActor>());
 
+	// the next scene's shaders and pipeline compile in the background while this one loads and runs
+	const auto& gpu_instance = hephics::GPUHandler::GetInstance();
+	vk_interface::graphic::PipelineBuilder::Prewarm(gpu_instance->GetLogicalDevice(), gpu_instance->GetPipelineCache(),
+		{ SampleActorAnother::GetPipelineBuilder });
+
 	Scene::Initialize();
 }
 
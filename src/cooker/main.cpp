@@ -0,0 +1,202 @@
+#include "../hephics/Hephics.hpp"
+
+// cooks assets/img, assets/model and assets/shader into one pack archive,
+// run from the directory holding "assets" like the engine itself
+struct CookSettings
+{
+	std::filesystem::path output_path = hephics::ASSET_PACK_PATH;
+	hephics_helper::PackArchive::Compression compression = hephics_helper::PackArchive::Compression::none;
+	// a cooked mesh only matches the same optimization, levels of detail and meshlets at runtime, the defaults are
+	// the sample room's: 4 levels of detail and meshlets. The vertex layout is applied at upload, any one fits
+	hephics::asset::ModelLoadSettings load_settings = []
+		{
+			hephics::asset::ModelLoadSettings load_settings{};
+			load_settings.lod_num = 4U;
+			load_settings.use_meshlets = true;
+			return load_settings;
+		}();
+	// by model path below assets/model, for meshes registered with other settings than the defaults
+	std::map<std::string, hephics::asset::ModelLoadSettings> model_load_settings;
+	vk_interface::component::ShaderProvider::Optimization shader_optimization =
+		vk_interface::component::ShaderProvider::GetOptimization();
+};
+
+static void print_usage()
+{
+	std::cout << "usage: HephicsCooker [--output <path>] [--lz4] [--shader-opt <none|performance|size>] [<mesh options>]"
+		" [--model <path> <mesh options>]...\n"
+		"mesh options: [--optimize] [--lod <num>] [--no-meshlets]\n"
+		"meshes are cooked with the ModelLoadSettings they are registered with at runtime, the defaults are --lod 4"
+		" with meshlets; options after --model <path below assets/model> apply to that model only, on top of the"
+		" defaults given before it\n";
+}
+
+static vk_interface::component::ShaderProvider::Optimization parse_shader_optimization(const std::string_view& value)
+{
+	using Optimization = vk_interface::component::ShaderProvider::Optimization;
+
+	if (value == "none")
+		return Optimization::none;
+	if (value == "performance")
+		return Optimization::performance;
+	if (value == "size")
+		return Optimization::size;
+
+	throw std::runtime_error(std::format("cooker: unknown shader optimization {}", value));
+}
+
+static CookSettings parse_arguments(const int32_t& argc, char* argv[])
+{
+	CookSettings cook_settings;
+	auto ptr_load_settings = &cook_settings.load_settings; // the defaults until the first --model
+
+	for (int32_t arg_idx = 1; arg_idx < argc; arg_idx++)
+	{
+		const std::string_view argument = argv[arg_idx];
+		const auto has_value = arg_idx + 1 < argc;
+
+		if (argument == "--output" && has_value)
+			cook_settings.output_path = argv[++arg_idx];
+		else if (argument == "--lz4")
+			cook_settings.compression = hephics_helper::PackArchive::Compression::lz4;
+		else if (argument == "--model" && has_value)
+		{
+			const auto model_name = std::filesystem::path(argv[++arg_idx]).lexically_normal().generic_string();
+			ptr_load_settings =
+				&cook_settings.model_load_settings.insert_or_assign(model_name, cook_settings.load_settings).first->second;
+		}
+		else if (argument == "--optimize")
+			ptr_load_settings->is_optimized = true;
+		else if (argument == "--no-meshlets")
+			ptr_load_settings->use_meshlets = false;
+		else if (argument == "--lod" && has_value)
+			ptr_load_settings->lod_num = static_cast<uint32_t>(std::max(1, std::atoi(argv[++arg_idx])));
+		else if (argument == "--shader-opt" && has_value)
+			cook_settings.shader_optimization = parse_shader_optimization(argv[++arg_idx]);
+		else
+			throw std::runtime_error(std::format("cooker: unknown argument {}", argument));
+	}
+
+	if (!hephics_helper::PackArchive::IsCompressionSupported(cook_settings.compression))
+		throw std::runtime_error("cooker: built without lz4");
+	if (!vk_interface::component::ShaderProvider::IsOptimizationSupported(cook_settings.shader_optimization))
+		throw std::runtime_error("cooker: built without SPIRV-Tools");
+
+	return cook_settings;
+}
+
+// sorted, so the same sources always give the same archive
+static std::vector<std::filesystem::path> list_files(const std::filesystem::path& dir_path,
+	const std::set<std::string>& extensions)
+{
+	std::vector<std::filesystem::path> file_paths;
+
+	std::error_code error_code;
+	if (!std::filesystem::is_directory(dir_path, error_code))
+		return file_paths;
+
+	for (const auto& dir_entry : std::filesystem::recursive_directory_iterator(dir_path))
+	{
+		if (dir_entry.is_regular_file() && extensions.contains(dir_entry.path().extension().string()))
+			file_paths.push_back(dir_entry.path().lexically_normal());
+	}
+
+	std::sort(file_paths.begin(), file_paths.end());
+	return file_paths;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		const auto cook_settings = parse_arguments(argc, argv);
+		vk_interface::component::ShaderProvider::SetOptimization(cook_settings.shader_optimization);
+
+		const auto image_paths = list_files("assets/img", { ".png", ".jpg", ".jpeg", ".bmp", ".tga" });
+		const auto model_paths = list_files("assets/model", { ".obj" });
+		const auto shader_paths = list_files("assets/shader", { ".vert", ".frag", ".comp", ".rgen", ".rmiss", ".rchit", ".rahit" });
+
+		for (const auto& [model_name, load_settings] : cook_settings.model_load_settings)
+		{
+			if (std::find(model_paths.begin(), model_paths.end(), std::filesystem::path("assets/model") / model_name)
+				== model_paths.end())
+				throw std::runtime_error("cooker: no model " + model_name);
+		}
+
+		std::vector<hephics_helper::PackArchive::SourceEntry> entries(
+			image_paths.size() + model_paths.size() + shader_paths.size());
+		for (auto& entry : entries)
+			entry.compression = cook_settings.compression;
+		std::vector<std::string> entry_notes(entries.size()); // what the report tells besides the size
+
+		// images, meshes and shaders cook in parallel, glslang is set up once and shared by every compile
+		hephics_helper::WorkerPool::ParallelFor(entries.size(), [&](const size_t& path_idx)
+			{
+				auto& entry = entries.at(path_idx);
+				if (path_idx < image_paths.size())
+				{
+					const auto& image_path = image_paths.at(path_idx);
+					auto image = cv::imread(image_path.string());
+					if (image.empty())
+						throw std::runtime_error("cooker: failed to read " + image_path.string());
+
+					cv::cvtColor(image, image, cv::COLOR_BGR2RGBA);
+					entry.name = hephics_helper::PackArchive::GetEntryName(image_path);
+					entry.data = hephics::asset::Texture::Cook(image);
+				}
+				else if (path_idx < image_paths.size() + model_paths.size())
+				{
+					const auto& model_path = model_paths.at(path_idx - image_paths.size());
+					entry.name = hephics_helper::PackArchive::GetEntryName(model_path);
+					// registrations hash the material library without decoding the cooked mesh
+					hephics_helper::MappedFile model_file(model_path);
+					if (model_file.GetSize() > 0U)
+						entry.dependency = hephics::asset::obj_parser::find_material_library(std::string_view(
+							reinterpret_cast<const char*>(model_file.GetData()), model_file.GetSize()));
+					const auto model_name = model_path.lexically_relative("assets/model").generic_string();
+					const auto load_settings_it = cook_settings.model_load_settings.find(model_name);
+					const auto& load_settings = load_settings_it != cook_settings.model_load_settings.end()
+						? load_settings_it->second : cook_settings.load_settings;
+					entry.data = hephics::asset::Object3D::Cook(model_path.generic_string(), load_settings);
+				}
+				else
+				{
+					const auto& shader_path = shader_paths.at(path_idx - image_paths.size() - model_paths.size());
+					vk_interface::component::ShaderProvider::CompileStat compile_stat;
+					const auto spv_binary = vk_interface::component::ShaderProvider::CompileShader(
+						shader_path.lexically_relative("assets/shader").generic_string(), compile_stat);
+					entry_notes.at(path_idx) = compile_stat.is_cached
+						? std::format(" ({} instructions, cached)", compile_stat.instruction_num)
+						: std::format(" ({} -> {} instructions)", compile_stat.compiled_instruction_num, compile_stat.instruction_num);
+
+					entry.name = hephics_helper::PackArchive::GetEntryName(shader_path);
+					entry.data.resize(sizeof(uint32_t) * spv_binary.size());
+					std::memcpy(entry.data.data(), spv_binary.data(), entry.data.size());
+				}
+			});
+
+		hephics_helper::PackArchive::Write(cook_settings.output_path, entries);
+
+		size_t source_size = 0U;
+		for (size_t entry_idx = 0U; entry_idx < entries.size(); entry_idx++)
+		{
+			const auto& entry = entries.at(entry_idx);
+			std::cout << std::format("{:>12} {}{}\n", entry.data.size(), entry.name, entry_notes.at(entry_idx));
+			source_size += entry.data.size();
+		}
+		std::cout << std::format("cooked {} entries, {} bytes into {} ({} bytes)\n", entries.size(), source_size,
+			cook_settings.output_path.string(), std::filesystem::file_size(cook_settings.output_path));
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << exception.what() << "\n";
+		print_usage();
+		hephics_helper::WorkerPool::Shutdown();
+		vk_interface::component::ShaderProvider::Reset();
+		return 1;
+	}
+
+	hephics_helper::WorkerPool::Shutdown();
+	vk_interface::component::ShaderProvider::Reset();
+	return 0;
+}
\ No newline at end of file
@@ -6,6 +6,8 @@
 namespace hephics
 {
 	constexpr auto BUFFERING_FRAME_NUM = 2;
+	constexpr auto ASSET_PACK_PATH = "assets/assets.hpak"; // written by HephicsCooker, optional
+	constexpr auto PIPELINE_CACHE_PATH = "output/cache/pipeline.bin";
 
 	namespace window
 	{
@@ -91,6 +93,7 @@ namespace hephics
 		std::vector<vk::UniqueSemaphore> m_semaphores;
 
 		uint32_t m_currentFrameId = 0U;
+		bool m_isSemaphoreSignaled = false; // by a submission of the current frame, the render submission waits on it
 
 	public:
 		ComputingSyncObject() = default;
@@ -98,8 +101,10 @@ namespace hephics
 
 		void SetSyncObjects(const vk::UniqueDevice& logical_device, const int32_t& buffering_num);
 
-		vk::SubmitInfo GetComputingSubmitInfo(
-			const std::vector<vk::CommandBuffer>& submitted_command_buffers) const;
+		// only the first submission of a frame signals the semaphore, later ones are ordered behind it on the queue
+		vk::SubmitInfo GetComputingSubmitInfo(const std::vector<vk::CommandBuffer>& submitted_command_buffers);
+
+		const auto& IsSemaphoreSignaled() const { return m_isSemaphoreSignaled; }
 
 		const auto& GetCurrentFrameId() const { return m_currentFrameId; }
 
@@ -142,19 +147,31 @@ namespace hephics
 		virtual void SetCommandPools();
 		virtual void SetCommandBuffers();
 
+		// seeded from PIPELINE_CACHE_PATH when the file was written by this device and driver, else empty
+		virtual void SetPipelineCache();
+		void SavePipelineCache() const;
+
 	public:
 
 		VkInstance();
 		~VkInstance()
 		{
 			if (m_logicalDevice)
+			{
 				m_logicalDevice->waitIdle();
+				SavePipelineCache();
+			}
 		}
 
 		void ResetSwapChain(::GLFWwindow* const window);
 
 		void SubmitCopyGraphicResource(const vk::SubmitInfo& submit_info);
 
+		// records into a command buffer of its own and waits for its fence, for uploads that release their
+		// staging memory before the scene's copy submission, like the windows of a streamed mesh
+		void SubmitOneTimeCommands(
+			const std::function<void(const std::shared_ptr<vk_interface::component::CommandBuffer>&)>& record_commands);
+
 		void SubmitRenderingCommand(const vk::SubmitInfo& submit_info);
 
 		void PresentFrame(const vk::PresentInfoKHR& present_info);
@@ -180,14 +197,47 @@ namespace hephics
 
 	namespace asset
 	{
+		// index into the storage of one asset type, the generation tells a released and reused slot apart
+		template<typename T>
+		struct AssetHandle
+		{
+			static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+			uint32_t index = INVALID_INDEX;
+			uint32_t generation = 0U;
+
+			bool IsValid() const { return index != INVALID_INDEX; }
+			bool operator==(const AssetHandle& other) const = default;
+		};
+
 		class Texture
 		{
 		private:
+			// cooked texture: this header, then the RGBA8 levels from the largest down
+			struct CookedHeader
+			{
+				uint32_t magic;
+				uint32_t version;
+				uint32_t width;
+				uint32_t height;
+				uint32_t mip_num;
+				uint32_t reserved;
+			};
+
+			static constexpr uint32_t COOKED_MAGIC = 0x58455448U; // "HTEX"
+			static constexpr uint32_t COOKED_VERSION = 1U;
+
 			std::shared_ptr<vk_interface::component::Image> m_ptrImage;
 			vk::UniqueSampler m_sampler;
 			uint32_t m_miplevel = 0U;
+			size_t m_residentSize = 0U; // RGBA8 over every mip level
+			bool m_isCooked = false;
+			bool m_isTextureCopied = false; // textures shared by several names or scenes upload once
+			std::optional<hephics_helper::PackArchive::EntryData> m_cookedImage; // until CopyTexture
 
+			void CreateImage(const uint32_t& width, const uint32_t& height);
 			void GenerateMipmaps(const uint32_t& width, const uint32_t& height);
+			void SetResidentSize(const uint32_t& width, const uint32_t& height);
 
 		public:
 			Texture()
@@ -196,6 +246,7 @@ namespace hephics
 			}
 			Texture(const std::string& path, const std::string& cv_mat_key);
 			Texture(const std::shared_ptr<cv::Mat>& cv_mat);
+			Texture(hephics_helper::PackArchive::EntryData&& cooked_image);
 			~Texture() {}
 
 			Texture(Texture&& other) noexcept
@@ -217,8 +268,74 @@ namespace hephics
 			const auto& GetSampler() const { return m_sampler; }
 
 			void CopyTexture(const std::shared_ptr<cv::Mat>& cv_mat);
+			// uploads the cooked levels as they are, no blits
+			void CopyTexture();
+
+			const auto& IsCooked() const { return m_isCooked; }
+			const auto& IsTextureCopied() const { return m_isTextureCopied; }
+
+			// RGBA8 image with every mip level precomputed, for a pack archive
+			static std::vector<std::byte> Cook(const cv::Mat& rgba_image);
+			// area filtered like the blits of an sRGB image: color is averaged in linear space, alpha as it is
+			static cv::Mat ResizeSrgb(const cv::Mat& rgba_image, const cv::Size& level_size);
 
 			const auto& GetMiplevel() const { return m_miplevel; }
+			const auto& GetResidentSize() const { return m_residentSize; }
+		};
+
+		// where an image was packed: the layer of the atlas and its rect there in UV units,
+		// sample with vec3(uv_rect.xy + fract(uv) * uv_rect.zw, layer)
+		struct AtlasRegion
+		{
+			uint32_t layer = 0U;
+			glm::vec4 uv_rect{};
+		};
+
+		// packs small RGBA8 images into the layers of one 2D array image, so every actor sampling them shares
+		// one image, sampler and descriptor; rects are aligned to and padded by PADDING texels of their own edge,
+		// so none of the MIP_NUM levels blends a neighbour in. Layers are only as large as the fullest one needs,
+		// at most LAYER_SIZE
+		class TextureAtlas
+		{
+		private:
+			std::shared_ptr<vk_interface::component::Image> m_ptrImage;
+			vk::UniqueSampler m_sampler;
+			uint32_t m_layerNum = 0U;
+			vk::Extent2D m_layerExtent; // multiples of PADDING, so every level halves exactly
+			size_t m_residentSize = 0U; // RGBA8 over every layer and mip level
+			bool m_isTextureCopied = false;
+			std::unordered_map<std::string, AtlasRegion> m_regions;
+			std::vector<cv::Mat> m_levels; // layer major, MIP_NUM per layer, until CopyTexture
+
+			void CreateImage();
+
+		public:
+			static constexpr uint32_t LAYER_SIZE = 2048U;
+			static constexpr uint32_t MIP_NUM = 5U;
+			static constexpr uint32_t PADDING = 1U << (MIP_NUM - 1U);
+			static constexpr uint32_t MAX_IMAGE_SIZE = LAYER_SIZE / 4U; // larger images stay separate Textures
+
+			// "images": name and RGBA8 image, each at most MAX_IMAGE_SIZE on a side
+			TextureAtlas(const std::vector<std::pair<std::string, std::shared_ptr<cv::Mat>>>& images);
+			~TextureAtlas() {}
+
+			static bool IsPackable(const cv::Mat& image)
+			{
+				return image.type() == CV_8UC4 && image.cols > 0 && image.rows > 0
+					&& static_cast<uint32_t>(std::max(image.cols, image.rows)) <= MAX_IMAGE_SIZE;
+			}
+
+			// uploads every layer with its precomputed levels, once
+			void CopyTexture();
+
+			bool Contains(const std::string& key) const { return m_regions.contains(key); }
+			const AtlasRegion& GetRegion(const std::string& key) const;
+
+			auto& GetImage() { return m_ptrImage; }
+			const auto& GetSampler() const { return m_sampler; }
+			const auto& GetLayerNum() const { return m_layerNum; }
+			const auto& GetLayerExtent() const { return m_layerExtent; }
+			const auto& GetResidentSize() const { return m_residentSize; }
 		};
 
 		struct VertexData
@@ -254,25 +371,680 @@ namespace hephics
 			}
 		};
 
+		struct BoundingBox
+		{
+			glm::vec3 min = glm::vec3(std::numeric_limits<float_t>::max());
+			glm::vec3 max = glm::vec3(std::numeric_limits<float_t>::lowest());
+
+			void Expand(const glm::vec3& point)
+			{
+				min = glm::min(min, point);
+				max = glm::max(max, point);
+			}
+
+			glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+			glm::vec3 GetExtent() const { return (max - min) * 0.5f; }
+		};
+
+		// a simplified copy of the mesh inside the shared index buffer, level 0 is the full mesh
+		struct LodLevel
+		{
+			uint32_t first_index;
+			uint32_t index_count;
+			float_t error; // largest surface deviation from the full mesh, in model units
+		};
+
+		// the triangles of one material, contiguous inside a level of detail
+		struct MaterialRange
+		{
+			uint32_t first_index;
+			uint32_t index_count;
+			int32_t material_id; // into Object3D::GetMaterials, -1 without a material
+		};
+
+		// a cluster of the full mesh with its culling bounds, laid out for a std430 storage buffer
+		struct Meshlet
+		{
+			glm::vec3 center;
+			float_t radius;
+			glm::vec3 cone_axis;
+			float_t cone_cutoff; // sine of the normal cone spread, 1 disables the backface test
+			uint32_t first_index;
+			uint32_t index_count;
+			int32_t vertex_offset;
+			uint32_t vertex_count;
+		};
+
+		// maps encoded attributes back to model space: value = offset + scale * encoded
+		struct VertexQuantization
+		{
+			glm::vec3 position_offset = glm::vec3(0.0f);
+			glm::vec3 position_scale = glm::vec3(1.0f);
+			glm::vec2 tex_coord_offset = glm::vec2(0.0f);
+			glm::vec2 tex_coord_scale = glm::vec2(1.0f);
+
+			// folded into the model matrix, so quantized positions need no shader change
+			glm::mat4 GetDequantizationMatrix() const
+			{
+				return glm::scale(glm::translate(glm::mat4(1.0f), position_offset), position_scale);
+			}
+
+			// xy: offset, zw: scale
+			glm::vec4 GetTexCoordTransform() const { return glm::vec4(tex_coord_offset, tex_coord_scale); }
+		};
+
+		// one vertex attribute: shader location, Vulkan format, encoded size and encoder
+		namespace vertex_attribute
+		{
+			struct PositionFloat3
+			{
+				static constexpr uint32_t LOCATION = 0U;
+				static constexpr vk::Format FORMAT = vk::Format::eR32G32B32Sfloat;
+				static constexpr uint32_t SIZE = sizeof(glm::vec3);
+				static constexpr bool IS_POSITION_QUANTIZED = false;
+				static constexpr bool IS_TEX_COORD_QUANTIZED = false;
+
+				static void Encode(const VertexData& vertex, const VertexQuantization&, std::byte* ptr_dst)
+				{
+					std::memcpy(ptr_dst, &vertex.pos, SIZE);
+				}
+			};
+
+			// [-1, 1] over the bounding box, w is padding
+			struct PositionSnorm16
+			{
+				static constexpr uint32_t LOCATION = 0U;
+				static constexpr vk::Format FORMAT = vk::Format::eR16G16B16A16Snorm;
+				static constexpr uint32_t SIZE = sizeof(uint64_t);
+				static constexpr bool IS_POSITION_QUANTIZED = true;
+				static constexpr bool IS_TEX_COORD_QUANTIZED = false;
+
+				static void Encode(const VertexData& vertex, const VertexQuantization& quantization, std::byte* ptr_dst)
+				{
+					const auto normalized = (vertex.pos - quantization.position_offset) / quantization.position_scale;
+					const auto packed = glm::packSnorm4x16(glm::vec4(normalized, 0.0f));
+					std::memcpy(ptr_dst, &packed, SIZE);
+				}
+			};
+
+			// [-1, 1] over the bounding box as half floats, w is padding
+			struct PositionHalf
+			{
+				static constexpr uint32_t LOCATION = 0U;
+				static constexpr vk::Format FORMAT = vk::Format::eR16G16B16A16Sfloat;
+				static constexpr uint32_t SIZE = sizeof(uint64_t);
+				static constexpr bool IS_POSITION_QUANTIZED = true;
+				static constexpr bool IS_TEX_COORD_QUANTIZED = false;
+
+				static void Encode(const VertexData& vertex, const VertexQuantization& quantization, std::byte* ptr_dst)
+				{
+					const auto normalized = (vertex.pos - quantization.position_offset) / quantization.position_scale;
+					const auto packed = glm::packHalf4x16(glm::vec4(normalized, 0.0f));
+					std::memcpy(ptr_dst, &packed, SIZE);
+				}
+			};
+
+			struct ColorFloat3
+			{
+				static constexpr uint32_t LOCATION = 1U;
+				static constexpr vk::Format FORMAT = vk::Format::eR32G32B32Sfloat;
+				static constexpr uint32_t SIZE = sizeof(glm::vec3);
+				static constexpr bool IS_POSITION_QUANTIZED = false;
+				static constexpr bool IS_TEX_COORD_QUANTIZED = false;
+
+				static void Encode(const VertexData& vertex, const VertexQuantization&, std::byte* ptr_dst)
+				{
+					std::memcpy(ptr_dst, &vertex.color, SIZE);
+				}
+			};
+
+			struct TexCoordFloat2
+			{
+				static constexpr uint32_t LOCATION = 2U;
+				static constexpr vk::Format FORMAT = vk::Format::eR32G32Sfloat;
+				static constexpr uint32_t SIZE = sizeof(glm::vec2);
+				static constexpr bool IS_POSITION_QUANTIZED = false;
+				static constexpr bool IS_TEX_COORD_QUANTIZED = false;
+
+				static void Encode(const VertexData& vertex, const VertexQuantization&, std::byte* ptr_dst)
+				{
+					std::memcpy(ptr_dst, &vertex.tex_coord, SIZE);
+				}
+			};
+
+			// [0, 1] over the texcoord bounds
+			struct TexCoordUnorm16
+			{
+				static constexpr uint32_t LOCATION = 2U;
+				static constexpr vk::Format FORMAT = vk::Format::eR16G16Unorm;
+				static constexpr uint32_t SIZE = sizeof(uint32_t);
+				static constexpr bool IS_POSITION_QUANTIZED = false;
+				static constexpr bool IS_TEX_COORD_QUANTIZED = true;
+
+				static void Encode(const VertexData& vertex, const VertexQuantization& quantization, std::byte* ptr_dst)
+				{
+					const auto normalized = (vertex.tex_coord - quantization.tex_coord_offset) / quantization.tex_coord_scale;
+					const auto packed = glm::packUnorm2x16(normalized);
+					std::memcpy(ptr_dst, &packed, SIZE);
+				}
+			};
+		};
+
+		// tightly packed interleaved vertex made of "Attributes", encoded from VertexData on upload
+		template<typename... Attributes>
+		class VertexLayout
+		{
+		public:
+			static constexpr uint32_t STRIDE = (Attributes::SIZE + ...);
+			static constexpr bool IS_POSITION_QUANTIZED = (Attributes::IS_POSITION_QUANTIZED || ...);
+			static constexpr bool IS_TEX_COORD_QUANTIZED = (Attributes::IS_TEX_COORD_QUANTIZED || ...);
+
+			VertexLayout() = delete;
+			~VertexLayout() = delete;
+
+			static auto get_binding_description()
+			{
+				return vk::VertexInputBindingDescription(0, STRIDE, vk::VertexInputRate::eVertex);
+			}
+
+			static auto get_attribute_descriptions()
+			{
+				std::array<vk::VertexInputAttributeDescription, sizeof...(Attributes)> attribute_descriptions;
+				size_t attribute_idx = 0U;
+				uint32_t offset = 0U;
+				((attribute_descriptions.at(attribute_idx++) =
+					vk::VertexInputAttributeDescription(Attributes::LOCATION, 0, Attributes::FORMAT, offset),
+					offset += Attributes::SIZE), ...);
+
+				return attribute_descriptions;
+			}
+
+			static VertexQuantization get_quantization(const BoundingBox& position_bounds, const BoundingBox& tex_coord_bounds)
+			{
+				constexpr auto MIN_SCALE = std::numeric_limits<float_t>::min();
+				VertexQuantization quantization{};
+
+				if constexpr (IS_POSITION_QUANTIZED)
+				{
+					quantization.position_offset = position_bounds.GetCenter();
+					quantization.position_scale = glm::max(position_bounds.GetExtent(), glm::vec3(MIN_SCALE));
+				}
+
+				if constexpr (IS_TEX_COORD_QUANTIZED)
+				{
+					quantization.tex_coord_offset = glm::vec2(tex_coord_bounds.min);
+					quantization.tex_coord_scale = glm::max(glm::vec2(tex_coord_bounds.max - tex_coord_bounds.min), glm::vec2(MIN_SCALE));
+				}
+
+				return quantization;
+			}
+
+			// "ptr_dst" may alias the source vertices: every vertex is read before its slot is written
+			static void encode(const std::span<const VertexData>& vertices, const VertexQuantization& quantization,
+				std::byte* ptr_dst)
+			{
+				static_assert(STRIDE <= sizeof(VertexData));
+
+				for (size_t vertex_idx = 0U; vertex_idx < vertices.size(); vertex_idx++)
+				{
+					VertexData vertex;
+					std::memcpy(&vertex, &vertices[vertex_idx], sizeof(VertexData));
+
+					((Attributes::Encode(vertex, quantization, ptr_dst), ptr_dst += Attributes::SIZE), ...);
+				}
+			}
+		};
+
+		using StandardVertexLayout = VertexLayout<vertex_attribute::PositionFloat3,
+			vertex_attribute::ColorFloat3, vertex_attribute::TexCoordFloat2>; // 32 bytes, same as VertexData
+		using CompactVertexLayout = VertexLayout<vertex_attribute::PositionSnorm16, vertex_attribute::TexCoordUnorm16>; // 12 bytes
+		using HalfVertexLayout = VertexLayout<vertex_attribute::PositionHalf, vertex_attribute::TexCoordUnorm16>; // 12 bytes
+
+		enum class VertexLayoutType
+		{
+			standard,
+			compact,
+			half,
+		};
+
+		// calls "function" with std::type_identity of the layout selected at runtime
+		template<typename F>
+		decltype(auto) visit_vertex_layout(const VertexLayoutType& vertex_layout_type, F&& function)
+		{
+			switch (vertex_layout_type)
+			{
+			case VertexLayoutType::compact:
+				return function(std::type_identity<CompactVertexLayout>());
+			case VertexLayoutType::half:
+				return function(std::type_identity<HalfVertexLayout>());
+			default:
+				return function(std::type_identity<StandardVertexLayout>());
+			}
+		}
+
+		namespace obj_parser
+		{
+			// 0-based attribute indices, -1: not present
+			struct Index
+			{
+				int32_t vertex_index = -1;
+				int32_t texcoord_index = -1;
+				int32_t normal_index = -1;
+			};
+
+			struct ParseResult
+			{
+				std::vector<float_t> positions; // xyz
+				std::vector<float_t> texcoords; // uv
+				size_t normal_num = 0U; // no vertex layout has a normal, they are counted to check the indices
+				std::vector<Index> indices; // three per triangle, polygons are fan-triangulated
+				std::vector<int32_t> material_ids; // one per triangle, index into material_names or -1
+				std::vector<std::string> material_names;
+				std::string material_library;
+			};
+
+			// splits the file into line-aligned chunks and parses them on the worker pool
+			ParseResult parse(const std::string& path);
+
+			// parses the file in line-aligned windows of about "window_size" bytes and calls "on_window" after each:
+			// faces may refer to any earlier attribute, so positions and texcoords accumulate over the windows,
+			// indices and material_ids only hold the faces of the last window
+			void parse_streaming(const std::string& path, const size_t& window_size,
+				const std::function<void(const ParseResult&)>& on_window);
+
+			// the first "mtllib" of the text like parse keeps it, empty without one
+			std::string find_material_library(const std::string_view& obj_text);
+
+			// decimal float with optional sign and exponent, advances "ptr" past the number
+			bool parse_float(const char*& ptr, const char* const end, float_t& value);
+		};
+
+		// binary glTF 2.0 (.glb): accessors are views into the mapped BIN chunk, nothing is copied while parsing
+		namespace gltf_parser
+		{
+			// component types, as the GL enums glTF uses
+			constexpr uint32_t COMPONENT_BYTE = 5120U;
+			constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121U;
+			constexpr uint32_t COMPONENT_SHORT = 5122U;
+			constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123U;
+			constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125U;
+			constexpr uint32_t COMPONENT_FLOAT = 5126U;
+
+			struct Accessor
+			{
+				const std::byte* ptr_data = nullptr; // first element
+				size_t count = 0U;
+				size_t stride = 0U; // bytes between elements, larger than the element for interleaved streams
+				uint32_t component_type = COMPONENT_FLOAT;
+				uint32_t component_num = 1U; // 1: SCALAR ... 4: VEC4
+				bool is_normalized = false;
+
+				bool operator==(const Accessor& other) const = default;
+
+				size_t GetComponentSize() const;
+				// converted to float, normalized integers are mapped to [0, 1] or [-1, 1]
+				float_t ReadFloat(const size_t& element_idx, const uint32_t& component_idx) const;
+				uint32_t ReadIndex(const size_t& element_idx) const;
+			};
+
+			// triangle list, the attributes hold "position.count" elements
+			struct Primitive
+			{
+				Accessor position;
+				std::optional<Accessor> tex_coord;
+				std::optional<Accessor> color;
+				std::optional<Accessor> indices; // nullopt: not indexed
+				BoundingBox bounds; // from the accessor min and max
+			};
+
+			struct ParseResult
+			{
+				std::shared_ptr<hephics_helper::MappedFile> ptr_mapped_file; // owns the memory of every accessor
+				std::vector<Primitive> primitives; // of every mesh, in file order
+			};
+
+			// only the GLB container is read, buffers referenced by uri are rejected
+			ParseResult parse(const std::string& path);
+		};
+
+		namespace mesh_optimizer
+		{
+			constexpr uint32_t DEFAULT_CACHE_SIZE = 16U;
+			constexpr uint32_t MESHLET_MAX_VERTEX_NUM = 64U;
+			constexpr uint32_t MESHLET_MAX_TRIANGLE_NUM = 124U;
+
+			struct Report
+			{
+				float_t acmr_before;
+				float_t acmr_after;
+				size_t cluster_num;
+			};
+
+			// average cache miss ratio: transformed vertices per triangle with a FIFO post-transform cache
+			float_t compute_acmr(const std::span<const uint32_t>& indices, const size_t& vertex_num,
+				const uint32_t& cache_size = DEFAULT_CACHE_SIZE);
+
+			// Tipsify reordering, returns the first triangle of every cluster (restart after a dead end)
+			std::vector<uint32_t> optimize_vertex_cache(std::vector<uint32_t>& indices, const size_t& vertex_num,
+				const uint32_t& cache_size = DEFAULT_CACHE_SIZE);
+
+			// splits the clusters where the cache is still warm enough, then sorts them outside-in;
+			// "threshold": tolerated ACMR relative to the vertex cache order
+			void optimize_overdraw(std::vector<uint32_t>& indices, const std::span<const VertexData>& vertices,
+				const std::vector<uint32_t>& cluster_starts, const uint32_t& cache_size = DEFAULT_CACHE_SIZE,
+				const float_t& threshold = 1.05f);
+
+			void optimize_vertex_fetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices);
+
+			// all of the above, in that order
+			Report optimize(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices);
+
+			// quadric error edge collapse onto existing vertices, the vertex data stays untouched; stops at
+			// "target_index_num" or before a collapse moves the surface further than "target_error" (model units).
+			// "result_error": the largest deviation of the returned mesh
+			std::vector<uint32_t> simplify(const std::span<const uint32_t>& indices, const std::span<const VertexData>& vertices,
+				const size_t& target_index_num, const float_t& target_error, float_t& result_error);
+
+			// reorders the triangles into meshlets of at most MESHLET_MAX_VERTEX_NUM vertices and MESHLET_MAX_TRIANGLE_NUM triangles
+			std::vector<Meshlet> build_meshlets(std::vector<uint32_t>& indices, const std::span<const VertexData>& vertices);
+		};
+
+		// what stays in host memory of an asset once its upload has finished
+		enum class CpuResidency
+		{
+			release, // dropped; a released image is decoded again when it is registered again
+			compressed, // images as PNG, meshes as LZ4 blocks, until Manager::RestoreCpuCopy
+			keep,
+		};
+
+		struct ModelLoadSettings
+		{
+			bool use_mesh_cache = true;
+			bool is_optimized = false; // vertex cache, overdraw and vertex fetch order, not applied when streaming
+			VertexLayoutType vertex_layout = VertexLayoutType::standard;
+			// meshes over 65536 vertices are cut into 16-bit indexable draw ranges, not applied when streaming
+			bool is_index_split = false;
+			// levels of detail including the full mesh, each with half the triangles of the previous one, not applied when streaming
+			uint32_t lod_num = 1U;
+			// clusters of the full mesh for per-cluster culling, not applied when streaming
+			bool use_meshlets = false;
+			// parse in windows, copy every finished window to the GPU and release its staging memory before the next
+			// one, instead of building the whole mesh on the heap. The file is parsed twice, the first pass sizes the
+			// buffers; the OBJ positions and texcoords and the vertex dedup table still grow with the file. Triangles
+			// keep their file order, without material ranges or material textures
+			bool is_streaming = false;
+			size_t window_size = 16U << 20; // bytes of OBJ text per window
+			// vertices and indices after the upload, GetVertices and GetIndices are empty once released
+			CpuResidency cpu_residency = CpuResidency::release;
+		};
+
+		// binary image of a parsed mesh, stored next to the build output and mapped on later loads,
+		// or cooked into a pack archive
+		class MeshCache
+		{
+		private:
+			struct Header
+			{
+				uint32_t magic;
+				uint32_t version;
+				uint32_t vertex_stride;
+				uint32_t flags;
+				uint64_t source_size;
+				int64_t source_write_time;
+				uint64_t source_hash;
+				uint64_t vertex_count;
+				uint64_t index_count;
+				uint64_t vertex_offset;
+				uint64_t index_offset;
+				uint64_t lod_count;
+				uint64_t lod_offset;
+				uint64_t meshlet_count;
+				uint64_t meshlet_offset;
+				uint64_t material_count;
+				uint64_t material_offset;
+				uint64_t material_library_size; // name of the .mtl file, so materials load with the cached mesh
+				uint64_t material_library_offset;
+				float_t bounds_min[3];
+				float_t bounds_max[3];
+			};
+
+			static constexpr uint32_t MAGIC = 0x48534D48U; // "HMSH"
+			static constexpr uint32_t VERSION = 5U;
+
+			hephics_helper::MappedFile m_mappedFile; // loose cache file
+			std::optional<hephics_helper::PackArchive::EntryData> m_packedData; // cooked mesh of a mounted pack
+			std::span<const std::byte> m_data;
+			Header m_header{};
+
+			static Header MakeHeader(const std::string& source_path, const size_t& vertex_num, const size_t& index_num,
+				const size_t& lod_num, const size_t& meshlet_num, const size_t& material_num, const size_t& material_library_size,
+				const BoundingBox& bounds, const uint32_t& flags);
+
+			// false when the image is broken or was built with other flags
+			bool ParseHeader(const uint32_t& flags);
+
+			// a failed write leaves the old time, the source is only hashed again on the next load
+			static void RefreshSourceWriteTime(const std::filesystem::path& cache_path, const int64_t& write_time);
+
+			template<typename T>
+			std::span<const T> GetSpan(const size_t& byte_offset, const size_t& count) const
+			{
+				if (byte_offset + sizeof(T) * count > m_data.size())
+					throw std::runtime_error("mesh_cache: out of range");
+
+				return { reinterpret_cast<const T*>(m_data.data() + byte_offset), count };
+			}
+
+		public:
+			// processing applied before the mesh was written, a cache only matches the same flags
+			static constexpr uint32_t FLAG_OPTIMIZED = 1U << 0;
+			static constexpr uint32_t FLAG_MESHLETS = 1U << 1;
+			static constexpr uint32_t LOD_NUM_SHIFT = 8U; // requested level count, from this bit on
+
+			MeshCache() = default;
+			~MeshCache() {}
+
+			static uint32_t GetFlags(const ModelLoadSettings& load_settings);
+			// one file per source and flags, so loads with other settings keep their own cache
+			static std::filesystem::path GetCachePath(const std::string& source_path, const uint32_t& flags);
+
+			// nullptr: cache file is missing, broken, older than the source or built with other flags
+			static std::shared_ptr<MeshCache> Load(const std::string& source_path, const uint32_t& flags = 0U);
+			// nullptr: no mounted pack holds the cooked mesh, or it was cooked with other flags
+			static std::shared_ptr<MeshCache> LoadPacked(const std::string& source_path, const uint32_t& flags = 0U);
+
+			static void Write(const std::string& source_path, const std::span<const VertexData>& vertices,
+				const std::span<const uint32_t>& indices, const std::span<const LodLevel>& lod_levels,
+				const std::span<const Meshlet>& meshlets, const std::span<const MaterialRange>& material_ranges,
+				const std::string& material_library, const BoundingBox& bounds, const uint32_t& flags = 0U);
+			// the same image in memory, for the asset cooker
+			static std::vector<std::byte> Encode(const std::string& source_path, const std::span<const VertexData>& vertices,
+				const std::span<const uint32_t>& indices, const std::span<const LodLevel>& lod_levels,
+				const std::span<const Meshlet>& meshlets, const std::span<const MaterialRange>& material_ranges,
+				const std::string& material_library, const BoundingBox& bounds, const uint32_t& flags = 0U);
+
+			std::span<const VertexData> GetVertices() const
+			{
+				return GetSpan<VertexData>(m_header.vertex_offset, m_header.vertex_count);
+			}
+
+			std::span<const uint32_t> GetIndices() const
+			{
+				return GetSpan<uint32_t>(m_header.index_offset, m_header.index_count);
+			}
+
+			std::span<const LodLevel> GetLodLevels() const
+			{
+				return GetSpan<LodLevel>(m_header.lod_offset, m_header.lod_count);
+			}
+
+			std::span<const Meshlet> GetMeshlets() const
+			{
+				return GetSpan<Meshlet>(m_header.meshlet_offset, m_header.meshlet_count);
+			}
+
+			std::span<const MaterialRange> GetMaterialRanges() const
+			{
+				return GetSpan<MaterialRange>(m_header.material_offset, m_header.material_count);
+			}
+
+			std::string GetMaterialLibrary() const
+			{
+				const auto material_library = GetSpan<char>(m_header.material_library_offset, m_header.material_library_size);
+				return std::string(material_library.begin(), material_library.end());
+			}
+
+			BoundingBox GetBounds() const
+			{
+				return BoundingBox{
+					glm::vec3(m_header.bounds_min[0], m_header.bounds_min[1], m_header.bounds_min[2]),
+					glm::vec3(m_header.bounds_max[0], m_header.bounds_max[1], m_header.bounds_max[2]) };
+			}
+		};
+
+		// one drawIndexed call: indices are relative to "vertex_offset"
+		struct DrawRange
+		{
+			uint32_t first_index;
+			uint32_t index_count;
+			int32_t vertex_offset;
+			int32_t material_id = -1; // a range never spans two materials
+		};
+
 		class Asset3D
 		{
 		protected:
+			static constexpr size_t MAX_UINT16_VERTEX_NUM = size_t(1U) << 16;
+
+			// a piece of a staged mesh, waiting in host-visible memory for its copy into the GPU buffer
+			struct StagedChunk
+			{
+				std::shared_ptr<hephics_helper::StagingBuffer> ptr_staging_buffer;
+				size_t dst_offset;
+				size_t size;
+			};
+
 			std::vector<VertexData> m_vertices;
 			std::vector<uint32_t> m_indices;
+			std::shared_ptr<MeshCache> m_ptrMeshCache; // when set, vertices and indices live in the mapped cache file
+			std::vector<StagedChunk> m_stagedVertexChunks; // when set, vertices and indices were staged by the loader
+			std::vector<StagedChunk> m_stagedIndexChunks;
+			BoundingBox m_bounds;
+			VertexLayoutType m_vertexLayoutType = VertexLayoutType::standard;
+			VertexQuantization m_vertexQuantization;
+			vk::IndexType m_indexType = vk::IndexType::eUint32;
+			std::vector<DrawRange> m_drawRanges;
+			std::vector<LodLevel> m_lodLevels;
+			std::vector<size_t> m_lodDrawRangeStarts; // first draw range of every level, then the total count
+			std::vector<Meshlet> m_meshlets; // cover level 0 in index order
+			std::vector<MaterialRange> m_materialRanges; // every level in index order, empty: one range without material
 			std::shared_ptr<hephics_helper::GPUBuffer> m_ptrVertexBuffer;
 			std::shared_ptr<hephics_helper::GPUBuffer> m_ptrIndexBuffer;
+			// a resident asset shared by the next scene is not uploaded again, staged chunks are gone by then
+			bool m_isVertexBufferCopied = false;
+			bool m_isIndexBufferCopied = false;
+
+			// quantization ranges come from m_bounds and "tex_coord_bounds"
+			void SetVertexLayout(const VertexLayoutType& vertex_layout_type, const BoundingBox& tex_coord_bounds);
+			void SetVertexLayout(const VertexLayoutType& vertex_layout_type);
+
+			void EncodeVertices(const std::span<const VertexData>& vertices, std::byte* ptr_dst) const;
+
+			// picks 16-bit indices when every draw range allows it, after an optional split
+			void PrepareIndices(const bool& is_index_split);
+			void SplitIndexRanges();
+			void EncodeIndices(const std::span<const uint32_t>& indices, std::byte* ptr_dst) const;
+
+			void CopyStagedChunks(std::vector<StagedChunk>& staged_chunks,
+				const std::shared_ptr<hephics_helper::GPUBuffer>& dst_buffer);
+
+			void OptimizeMesh();
+			// appends the simplified levels to m_indices
+			void GenerateLods(const uint32_t& lod_num, const bool& is_optimized);
+			// before GenerateLods: reorders m_indices
+			void BuildMeshlets(const bool& is_optimized);
+			// the material ranges of one level, or the whole level as one range
+			std::vector<MaterialRange> GetLevelMaterialRanges(const LodLevel& lod_level) const;
 
 		public:
 			Asset3D() = default;
 			~Asset3D() {}
 
-			const auto& GetVertices() const { return m_vertices; }
-			const auto& GetIndices() const { return m_indices; }
+			std::span<const VertexData> GetVertices() const
+			{
+				if (m_ptrMeshCache)
+					return m_ptrMeshCache->GetVertices();
+				return m_vertices;
+			}
+
+			std::span<const uint32_t> GetIndices() const
+			{
+				if (m_ptrMeshCache)
+					return m_ptrMeshCache->GetIndices();
+				return m_indices;
+			}
+
+			// also valid for streamed meshes, whose indices are only held by the GPU buffer
+			uint32_t GetIndexCount() const
+			{
+				return static_cast<uint32_t>(m_ptrIndexBuffer->GetSize() / GetIndexSize());
+			}
+
+			size_t GetIndexSize() const { return m_indexType == vk::IndexType::eUint16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+			const auto& GetIndexType() const { return m_indexType; }
+
+			// draw ranges of one level of detail
+			std::span<const DrawRange> GetDrawRanges(const uint32_t& lod_idx = 0U) const
+			{
+				if (lod_idx + 1U >= m_lodDrawRangeStarts.size())
+					return {};
+
+				const auto& first_draw_range = m_lodDrawRangeStarts.at(lod_idx);
+				return std::span(m_drawRanges).subspan(first_draw_range, m_lodDrawRangeStarts.at(lod_idx + 1U) - first_draw_range);
+			}
+
+			const auto& GetLodLevels() const { return m_lodLevels; }
+			uint32_t GetLodNum() const { return static_cast<uint32_t>(m_lodLevels.size()); }
+
+			// coarsest level whose error projects to at most "pixel_error" pixels, "model_view" without dequantization
+			uint32_t SelectLod(const glm::mat4& model_view, const glm::mat4& projection,
+				const float_t& viewport_height, const float_t& pixel_error = 1.0f) const;
+
+			const auto& GetMeshlets() const { return m_meshlets; }
+			const auto& GetMaterialRanges() const { return m_materialRanges; }
+
+			// left, right, bottom, top, near and far as (normal, distance) with the normal pointing inside
+			static std::array<glm::vec4, 6> GetFrustumPlanes(const glm::mat4& model_view_projection);
+
+			// frustum and normal cone test of every meshlet, neighboring visible meshlets share one range
+			void CullMeshlets(const glm::mat4& model_view, const glm::mat4& projection,
+				std::vector<DrawRange>& visible_ranges) const;
+
+			const auto& GetBounds() const { return m_bounds; }
+			const auto& GetVertexLayoutType() const { return m_vertexLayoutType; }
+			const auto& GetVertexQuantization() const { return m_vertexQuantization; }
+
+			uint32_t GetVertexStride() const;
+			vk::VertexInputBindingDescription GetVertexBindingDescription() const;
+			std::vector<vk::VertexInputAttributeDescription> GetVertexAttributeDescriptions() const;
+
 			const auto& GetVertexBuffer() const { return m_ptrVertexBuffer; }
 			const auto& GetIndexBuffer() const { return m_ptrIndexBuffer; }
 
-			void CopyVertexBuffer() const;
-			void CopyIndexBuffer() const;
+			// GPU buffers and the CPU copies on the heap, mapped cache files are not counted
+			size_t GetResidentSize() const
+			{
+				return (m_ptrVertexBuffer ? m_ptrVertexBuffer->GetSize() : 0U) + (m_ptrIndexBuffer ? m_ptrIndexBuffer->GetSize() : 0U)
+					+ sizeof(VertexData) * m_vertices.size() + sizeof(uint32_t) * m_indices.size();
+			}
+
+			void CopyVertexBuffer();
+			void CopyIndexBuffer();
+
+			// drops the vertices, indices and mapped cache once both buffers are uploaded, false before;
+			// "compressed_copy" receives them for CpuResidency::compressed, unless built without lz4
+			bool TrimCpuCopy(const CpuResidency& cpu_residency, std::vector<std::byte>& compressed_copy);
+			void RestoreCpuCopy(const std::vector<std::byte>& compressed_copy);
 		};
 
 		class Texture3D : public Asset3D
@@ -292,23 +1064,58 @@ namespace hephics
 		class Object3D : public Asset3D
 		{
 		protected:
-			std::shared_ptr<tinyobj::attrib_t> m_ptrAttribute;
-			std::vector<tinyobj::shape_t> m_shapes;
 			std::vector<tinyobj::material_t> m_materials;
+			std::string m_materialLibrary;
+			// diffuse texture of every material, a 1x1 white one when it has none; shared with other meshes by content
+			std::vector<AssetHandle<Texture>> m_materialTextureHandles;
+			std::vector<AssetHandle<cv::Mat>> m_materialCvMatHandles; // invalid for cooked textures
+
+			// triangles are sorted by material into m_materialRanges
+			void LoadObj(const std::string& path);
+			void LoadObjStreaming(const std::string& path, const ModelLoadSettings& load_settings);
+			// name to material id
+			std::map<std::string, int32_t> LoadMaterials(const std::string& path, const std::string& material_library);
+			void RegistMaterialTextures(const std::string& path);
+			// parses and applies optimization, meshlets and levels of detail, CPU only
+			void LoadProcessed(const std::string& path, const ModelLoadSettings& load_settings);
 
 		public:
 			Object3D()
 			{
 				m_ptrVertexBuffer = std::make_shared<hephics_helper::GPUBuffer>();
 				m_ptrIndexBuffer = std::make_shared<hephics_helper::GPUBuffer>();
-				m_ptrAttribute = std::make_shared<tinyobj::attrib_t>();
 			}
-			Object3D(const std::string& path);
-			~Object3D() {}
+			Object3D(const std::string& path, const ModelLoadSettings& load_settings = {});
+			~Object3D();
 
-			const auto& GetAttribute() const { return m_ptrAttribute; }
-			const auto& GetShapes() const { return m_shapes; }
+			// empty when the material library is missing, the mesh is then drawn with the actor's textures
 			const auto& GetMaterials() const { return m_materials; }
+			const auto& GetMaterialTextureHandles() const { return m_materialTextureHandles; }
+
+			// once per material texture, before the first draw
+			void CopyMaterialTextures();
+
+			// mesh cache image for a pack archive, without a GPU
+			static std::vector<std::byte> Cook(const std::string& path, const ModelLoadSettings& load_settings);
+		};
+
+		// vertices are encoded and indices copied straight from the mapped file into staging memory,
+		// mesh processing settings (cache, optimization, splitting, levels of detail, meshlets) are not applied
+		class Gltf3D : public Asset3D
+		{
+		protected:
+			void StageVertices(const gltf_parser::ParseResult& parse_result, const std::vector<int32_t>& vertex_offsets,
+				const size_t& vertex_num);
+			void StageIndices(const gltf_parser::ParseResult& parse_result, const size_t& index_num);
+
+		public:
+			Gltf3D()
+			{
+				m_ptrVertexBuffer = std::make_shared<hephics_helper::GPUBuffer>();
+				m_ptrIndexBuffer = std::make_shared<hephics_helper::GPUBuffer>();
+			}
+			Gltf3D(const std::string& path, const ModelLoadSettings& load_settings = {});
+			~Gltf3D() {}
 		};
 
 		class Fbx3D : public Asset3D
@@ -325,35 +1132,460 @@ namespace hephics
 			~Fbx3D() {}
 		};
 
-		using AssetVariant = std::variant
-			<std::shared_ptr<cv::Mat>, std::shared_ptr<Texture>, std::shared_ptr<Texture3D>,
-			std::shared_ptr<Object3D>, std::shared_ptr<Fbx3D>>;
+		// how long an asset stays resident once nothing references it
+		enum class AssetScope
+		{
+			global, // until Manager::Reset
+			scene, // until the next scene is initialized, or earlier when over the memory budget
+			transient, // until the next Manager::Trim
+		};
+
+		// an unreferenced asset the memory budget may release
+		struct EvictionCandidate
+		{
+			uint64_t last_use_frame;
+			size_t resident_size;
+			std::function<void()> evict;
+		};
+
+		// storage of one asset type, names only map to handles and are meant to be resolved at load time,
+		// slots live in a deque so references returned by Get survive later inserts; several names alias one
+		// slot when their content hashes match
+		template<typename T>
+		class AssetPool
+		{
+		private:
+			struct Slot
+			{
+				std::shared_ptr<T> ptr_asset;
+				uint32_t generation = 0U;
+				uint32_t ref_count = 0U;
+				AssetScope scope = AssetScope::scene;
+				size_t resident_size = 0U;
+				mutable uint64_t last_use_frame = 0U;
+				std::vector<std::string> asset_keys;
+				std::optional<uint64_t> content_hash;
+				CpuResidency cpu_residency = CpuResidency::release;
+				bool is_cpu_trimmed = false;
+				std::vector<std::byte> cpu_copy; // compressed CPU copy, counted in resident_size
+			};
+
+			std::deque<Slot> m_slots;
+			std::vector<uint32_t> m_freeIndices;
+			std::unordered_map<std::string, AssetHandle<T>> m_handleMap;
+			std::unordered_map<uint64_t, AssetHandle<T>> m_contentMap;
+			size_t m_residentSize = 0U;
+
+			void Free(const uint32_t& slot_idx)
+			{
+				auto& slot = m_slots[slot_idx];
+				m_residentSize -= slot.resident_size;
+				for (const auto& asset_key : slot.asset_keys)
+					m_handleMap.erase(asset_key);
+				if (slot.content_hash)
+					m_contentMap.erase(*slot.content_hash);
+
+				slot = Slot{ nullptr, slot.generation + 1U };
+				m_freeIndices.push_back(slot_idx);
+			}
+
+		public:
+			AssetPool() = default;
+			~AssetPool() {}
+
+			// the new asset starts without references
+			AssetHandle<T> Insert(const std::string& asset_key, std::shared_ptr<T>&& ptr_asset,
+				const AssetScope& scope, const size_t& resident_size, const uint64_t& frame_idx,
+				const std::optional<uint64_t>& content_hash = std::nullopt)
+			{
+				AssetHandle<T> asset_handle;
+				if (m_freeIndices.empty())
+				{
+					asset_handle.index = static_cast<uint32_t>(m_slots.size());
+					m_slots.emplace_back();
+				}
+				else
+				{
+					asset_handle.index = m_freeIndices.back();
+					m_freeIndices.pop_back();
+				}
+
+				auto& slot = m_slots[asset_handle.index];
+				slot.ptr_asset = std::move(ptr_asset);
+				slot.scope = scope;
+				slot.resident_size = resident_size;
+				slot.last_use_frame = frame_idx;
+				slot.asset_keys = { asset_key };
+				slot.content_hash = content_hash;
+				asset_handle.generation = slot.generation;
+
+				m_residentSize += resident_size;
+				m_handleMap.insert_or_assign(asset_key, asset_handle);
+				if (content_hash)
+					m_contentMap.insert_or_assign(*content_hash, asset_handle);
+				return asset_handle;
+			}
+
+			// one more name for a resident asset, without a reference
+			void Alias(const std::string& asset_key, const AssetHandle<T>& asset_handle)
+			{
+				if (!Contains(asset_handle))
+					throw std::runtime_error("asset_pool: stale handle");
+
+				m_slots[asset_handle.index].asset_keys.push_back(asset_key);
+				m_handleMap.insert_or_assign(asset_key, asset_handle);
+			}
+
+			// invalid handle when the name is not registered
+			AssetHandle<T> Find(const std::string& asset_key) const
+			{
+				const auto handle_iter = m_handleMap.find(asset_key);
+				return handle_iter != m_handleMap.end() ? handle_iter->second : AssetHandle<T>{};
+			}
+
+			// invalid handle when no resident asset has the content
+			AssetHandle<T> FindContent(const uint64_t& content_hash) const
+			{
+				const auto handle_iter = m_contentMap.find(content_hash);
+				return handle_iter != m_contentMap.end() ? handle_iter->second : AssetHandle<T>{};
+			}
+
+			std::optional<uint64_t> GetContentHash(const AssetHandle<T>& asset_handle) const
+			{
+				return Contains(asset_handle) ? m_slots[asset_handle.index].content_hash : std::nullopt;
+			}
+
+			bool Contains(const AssetHandle<T>& asset_handle) const
+			{
+				return asset_handle.index < m_slots.size() && m_slots[asset_handle.index].generation == asset_handle.generation
+					&& m_slots[asset_handle.index].ptr_asset != nullptr;
+			}
+
+			// records no use, nullptr for a stale handle
+			std::shared_ptr<T> Peek(const AssetHandle<T>& asset_handle) const
+			{
+				return Contains(asset_handle) ? m_slots[asset_handle.index].ptr_asset : nullptr;
+			}
+
+			const std::shared_ptr<T>& Get(const AssetHandle<T>& asset_handle, const uint64_t& frame_idx) const
+			{
+				if (!Contains(asset_handle))
+					throw std::runtime_error("asset_pool: stale handle");
+
+				const auto& slot = m_slots[asset_handle.index];
+				slot.last_use_frame = frame_idx;
+				return slot.ptr_asset;
+			}
+
+			// a shared asset keeps the longest scope and CPU residency it was registered with
+			void Acquire(const AssetHandle<T>& asset_handle, const AssetScope& scope,
+				const CpuResidency& cpu_residency = CpuResidency::keep)
+			{
+				if (!Contains(asset_handle))
+					throw std::runtime_error("asset_pool: stale handle");
+
+				auto& slot = m_slots[asset_handle.index];
+				slot.ref_count++;
+				slot.scope = std::min(slot.scope, scope);
+				slot.cpu_residency = std::max(slot.cpu_residency, cpu_residency);
+			}
+
+			// true when the last reference of a transient asset is gone, stale handles are ignored
+			bool Release(const AssetHandle<T>& asset_handle)
+			{
+				if (!Contains(asset_handle))
+					return false;
+
+				auto& slot = m_slots[asset_handle.index];
+				if (slot.ref_count > 0U)
+					slot.ref_count--;
+
+				return slot.ref_count == 0U && slot.scope == AssetScope::transient;
+			}
+
+			// unreferenced assets of "released_scope" or shorter, true when some were kept for being used
+			// at or after "safe_frame_idx"
+			bool ReleaseUnreferenced(const AssetScope& released_scope, const uint64_t& safe_frame_idx)
+			{
+				bool is_deferred = false;
+				for (uint32_t slot_idx = 0U; slot_idx < m_slots.size(); slot_idx++)
+				{
+					const auto& slot = m_slots[slot_idx];
+					if (slot.ptr_asset == nullptr || slot.ref_count > 0U || slot.scope < released_scope)
+						continue;
+
+					if (slot.last_use_frame < safe_frame_idx)
+						Free(slot_idx);
+					else
+						is_deferred = true;
+				}
+				return is_deferred;
+			}
+
+			void CollectEvictionCandidates(const uint64_t& safe_frame_idx, std::vector<EvictionCandidate>& candidates)
+			{
+				for (uint32_t slot_idx = 0U; slot_idx < m_slots.size(); slot_idx++)
+				{
+					const auto& slot = m_slots[slot_idx];
+					if (slot.ptr_asset == nullptr || slot.ref_count > 0U || slot.scope == AssetScope::global
+						|| slot.last_use_frame >= safe_frame_idx)
+						continue;
+
+					candidates.emplace_back(EvictionCandidate{ slot.last_use_frame, slot.resident_size,
+						[this, slot_idx] { Free(slot_idx); } });
+				}
+			}
+
+			// after an upload: "trim" drops the CPU copy of an asset as its residency asks and returns the new
+			// resident size without "cpu_copy", nullopt while the asset is not uploaded yet; the slot and its
+			// handles stay either way
+			template<typename Trimmer>
+			void TrimCpuCopies(Trimmer&& trim)
+			{
+				for (auto& slot : m_slots)
+				{
+					if (slot.ptr_asset == nullptr || slot.is_cpu_trimmed || slot.cpu_residency == CpuResidency::keep)
+						continue;
+
+					const auto resident_size = trim(*slot.ptr_asset, slot.cpu_residency, slot.cpu_copy, slot.content_hash);
+					if (!resident_size)
+						continue;
+
+					m_residentSize = m_residentSize - slot.resident_size + resident_size.value() + slot.cpu_copy.size();
+					slot.resident_size = resident_size.value() + slot.cpu_copy.size();
+					slot.is_cpu_trimmed = true;
+				}
+			}
+
+			bool IsCpuReleased(const AssetHandle<T>& asset_handle) const
+			{
+				return Contains(asset_handle) && m_slots[asset_handle.index].is_cpu_trimmed
+					&& m_slots[asset_handle.index].cpu_residency == CpuResidency::release;
+			}
+
+			// "restore" rebuilds the CPU copy from "cpu_copy", empty for a released one, and returns the new
+			// resident size; it stays until the next TrimCpuCopies
+			template<typename Restorer>
+			void RestoreCpuCopy(const AssetHandle<T>& asset_handle, Restorer&& restore)
+			{
+				if (!Contains(asset_handle))
+					throw std::runtime_error("asset_pool: stale handle");
+
+				auto& slot = m_slots[asset_handle.index];
+				if (!slot.is_cpu_trimmed)
+					return;
+
+				const size_t resident_size = restore(*slot.ptr_asset, slot.cpu_copy);
+				m_residentSize = m_residentSize - slot.resident_size + resident_size;
+				slot.resident_size = resident_size;
+				slot.cpu_copy = {};
+				slot.is_cpu_trimmed = false;
+			}
+
+			const auto& GetResidentSize() const { return m_residentSize; }
+
+			// every handle given out so far becomes stale
+			void Clear()
+			{
+				for (uint32_t slot_idx = 0U; slot_idx < m_slots.size(); slot_idx++)
+				{
+					if (m_slots[slot_idx].ptr_asset != nullptr)
+						Free(slot_idx);
+				}
+			}
+		};
 
 		class Manager
 		{
 		private:
-			static std::unordered_map<std::string, std::unordered_map<std::string, AssetVariant>> s_assetDictionaries;
+			static std::tuple<AssetPool<cv::Mat>, AssetPool<Texture>, AssetPool<TextureAtlas>, AssetPool<Texture3D>,
+				AssetPool<Object3D>, AssetPool<Gltf3D>, AssetPool<Fbx3D>> s_assetPools;
+			static size_t s_memoryBudget;
+			static uint64_t s_frameIdx;
+			static bool s_isTrimPending;
 
 			Manager() = delete;
 			~Manager() = delete;
 
+			template<typename T>
+			static AssetPool<T>& GetPool() { return std::get<AssetPool<T>>(s_assetPools); }
+
+			static size_t GetResidentSize(const cv::Mat& cv_mat) { return cv_mat.total() * cv_mat.elemSize(); }
+			static size_t GetResidentSize(const Texture& texture) { return texture.GetResidentSize(); }
+			static size_t GetResidentSize(const TextureAtlas& texture_atlas) { return texture_atlas.GetResidentSize(); }
+			static size_t GetResidentSize(const Asset3D& asset_3d) { return asset_3d.GetResidentSize(); }
+
+			// Asset3D trims itself, cv::Mat goes through these
+			static void EncodeCpuCopy(cv::Mat& cv_mat, std::vector<std::byte>& cpu_copy);
+			static void DecodeCpuCopy(cv::Mat& cv_mat, const std::vector<std::byte>& cpu_copy);
+			static void DecodeCpuCopy(Asset3D& asset_3d, const std::vector<std::byte>& cpu_copy) { asset_3d.RestoreCpuCopy(cpu_copy); }
+
+			// frames up to BUFFERING_FRAME_NUM back may still be executing on the GPU
+			static uint64_t GetSafeFrameIdx() { return s_frameIdx > BUFFERING_FRAME_NUM ? s_frameIdx - BUFFERING_FRAME_NUM : 0U; }
+
+			// the pixels of an image for a new upload, "reload" decodes a released one from its source again
+			template<typename Reloader>
+			static void RestoreCvMat(const AssetHandle<cv::Mat>& asset_handle, Reloader&& reload)
+			{
+				auto& cv_mat_pool = GetPool<cv::Mat>();
+				if (!cv_mat_pool.IsCpuReleased(asset_handle))
+				{
+					RestoreCpuCopy(asset_handle);
+					return;
+				}
+
+				cv_mat_pool.RestoreCpuCopy(asset_handle, [&reload](cv::Mat& cv_mat, const std::vector<std::byte>&)
+					{
+						cv_mat = reload();
+						return GetResidentSize(cv_mat);
+					});
+			}
+
+			// evicts least recently used, unreferenced assets until "incoming_size" more bytes fit the budget
+			static void EvictToBudget(const size_t& incoming_size);
+
+			// acquires a reference for the caller, "load" only runs when the name is not resident
+			template<typename T, typename Loader>
+			static AssetHandle<T> Regist(const std::string& asset_key, const AssetScope& scope, Loader&& load,
+				const CpuResidency& cpu_residency = CpuResidency::keep)
+			{
+				auto& asset_pool = GetPool<T>();
+				auto asset_handle = asset_pool.Find(asset_key);
+				if (!asset_handle.IsValid())
+				{
+					std::shared_ptr<T> ptr_asset = load();
+					const auto resident_size = GetResidentSize(*ptr_asset);
+					EvictToBudget(resident_size);
+					asset_handle = asset_pool.Insert(asset_key, std::move(ptr_asset), scope, resident_size, s_frameIdx);
+				}
+
+				asset_pool.Acquire(asset_handle, scope, cpu_residency);
+				return asset_handle;
+			}
+
+			// like Regist, but a name whose content is already resident becomes one more name of that asset;
+			// "fingerprint" hashes the content and only runs when the name is not resident
+			template<typename T, typename Fingerprint, typename Loader>
+			static AssetHandle<T> RegistUnique(const std::string& asset_key, const AssetScope& scope,
+				Fingerprint&& fingerprint, Loader&& load, const CpuResidency& cpu_residency = CpuResidency::keep)
+			{
+				auto& asset_pool = GetPool<T>();
+				auto asset_handle = asset_pool.Find(asset_key);
+				if (!asset_handle.IsValid())
+				{
+					const uint64_t content_hash = fingerprint();
+					asset_handle = asset_pool.FindContent(content_hash);
+					if (asset_handle.IsValid())
+					{
+						asset_pool.Alias(asset_key, asset_handle);
+#ifdef _DEBUG
+						std::cout << std::format("asset: {} shares the content {:016x}\n", asset_key, content_hash);
+#endif
+					}
+					else
+					{
+						std::shared_ptr<T> ptr_asset = load();
+						const auto resident_size = GetResidentSize(*ptr_asset);
+						EvictToBudget(resident_size);
+						asset_handle = asset_pool.Insert(asset_key, std::move(ptr_asset), scope, resident_size, s_frameIdx,
+							content_hash);
+					}
+				}
+
+				asset_pool.Acquire(asset_handle, scope, cpu_residency);
+				return asset_handle;
+			}
+
 		public:
-			static void RegistCvMat(const std::string& asset_path, const std::string& asset_key);
-			static void RegistCvMat(const std::string& asset_key, const cv::Mat& cv_mat);
-			static void RegistObject3D(const std::string& asset_path, const std::string& asset_key);
-			static void RegistFbx3D(const std::string& asset_path, const std::string& asset_key);
+			// registering a name again returns the resident asset and counts one more reference, so does a new
+			// name for content that is already resident: images hash their decoded pixels, meshes their source
+			// or cooked bytes together with the load settings
+			static AssetHandle<cv::Mat> RegistCvMat(const std::string& asset_path, const std::string& asset_key,
+				const AssetScope& scope = AssetScope::scene, const CpuResidency& cpu_residency = CpuResidency::keep);
+			static AssetHandle<cv::Mat> RegistCvMat(const std::string& asset_key, const cv::Mat& cv_mat,
+				const AssetScope& scope = AssetScope::scene, const CpuResidency& cpu_residency = CpuResidency::keep);
+			static AssetHandle<Object3D> RegistObject3D(const std::string& asset_path, const std::string& asset_key,
+				const ModelLoadSettings& load_settings = {}, const AssetScope& scope = AssetScope::scene);
+			static AssetHandle<Gltf3D> RegistGltf3D(const std::string& asset_path, const std::string& asset_key,
+				const ModelLoadSettings& load_settings = {}, const AssetScope& scope = AssetScope::scene);
+			static AssetHandle<Fbx3D> RegistFbx3D(const std::string& asset_path, const std::string& asset_key,
+				const AssetScope& scope = AssetScope::scene);
+
+			// the image is registered under the same name with "cpu_residency", the caller holds a reference to
+			// both; a texture cooked into a mounted pack registers no image, neither does one still resident by
+			// name whose image was evicted, FindHandle<cv::Mat> is invalid then
+			static AssetHandle<Texture> RegistTexture(const std::string& asset_path, const std::string& asset_key,
+				const AssetScope& scope = AssetScope::scene, const CpuResidency& cpu_residency = CpuResidency::release);
+			static AssetHandle<Texture> RegistTexture(const std::string& asset_key, const cv::Mat& cv_mat,
+				const AssetScope& scope = AssetScope::scene, const CpuResidency& cpu_residency = CpuResidency::release);
+			// packs the images under "assets/img", each also registered under its path and released again;
+			// regions are looked up by those paths
+			static AssetHandle<TextureAtlas> RegistTextureAtlas(const std::vector<std::string>& asset_paths,
+				const std::string& asset_key, const AssetScope& scope = AssetScope::scene);
+			static AssetHandle<Texture3D> RegistTexture3D(const Texture3D& texture_3d, const std::string& asset_key,
+				const AssetScope& scope = AssetScope::scene, const CpuResidency& cpu_residency = CpuResidency::release);
+
+			// one call per Regist, the asset stays resident until its scope ends or the budget evicts it
+			template<typename T>
+			static void Release(const AssetHandle<T>& asset_handle)
+			{
+				if (GetPool<T>().Release(asset_handle))
+					s_isTrimPending = true;
+			}
 
-			static void RegistTexture(const std::string& asset_path, const std::string& asset_key);
-			static void RegistTexture(const std::string& asset_key, const cv::Mat& cv_mat);
-			static void RegistTexture3D(const Texture3D& texture_3d, const std::string& asset_key);
+			// hashes the name, resolve it once and keep the handle
+			template<typename T>
+			static AssetHandle<T> FindHandle(const std::string& asset_key) { return GetPool<T>().Find(asset_key); }
 
 			static const std::shared_ptr<cv::Mat>& GetCvMat(const std::string& asset_key);
 			static const std::shared_ptr<Texture>& GetTexture(const std::string& asset_key);
+			static const std::shared_ptr<TextureAtlas>& GetTextureAtlas(const std::string& asset_key);
 			static const std::shared_ptr<Texture3D>& GetTexture3D(const std::string& asset_key);
 			static const std::shared_ptr<Object3D>& GetObject3D(const std::string& asset_key);
+			static const std::shared_ptr<Gltf3D>& GetGltf3D(const std::string& asset_key);
 			static const std::shared_ptr<Fbx3D>& GetFbx3D(const std::string& asset_key);
 
-			static void Reset() { s_assetDictionaries.clear(); }
+			static const auto& GetCvMat(const AssetHandle<cv::Mat>& asset_handle) { return GetPool<cv::Mat>().Get(asset_handle, s_frameIdx); }
+			static const auto& GetTexture(const AssetHandle<Texture>& asset_handle) { return GetPool<Texture>().Get(asset_handle, s_frameIdx); }
+			static const auto& GetTextureAtlas(const AssetHandle<TextureAtlas>& asset_handle) { return GetPool<TextureAtlas>().Get(asset_handle, s_frameIdx); }
+			static const auto& GetTexture3D(const AssetHandle<Texture3D>& asset_handle) { return GetPool<Texture3D>().Get(asset_handle, s_frameIdx); }
+			static const auto& GetObject3D(const AssetHandle<Object3D>& asset_handle) { return GetPool<Object3D>().Get(asset_handle, s_frameIdx); }
+			static const auto& GetGltf3D(const AssetHandle<Gltf3D>& asset_handle) { return GetPool<Gltf3D>().Get(asset_handle, s_frameIdx); }
+			static const auto& GetFbx3D(const AssetHandle<Fbx3D>& asset_handle) { return GetPool<Fbx3D>().Get(asset_handle, s_frameIdx); }
+
+			// CPU and GPU bytes of every resident asset, 0: unlimited
+			static void SetMemoryBudget(const size_t& memory_budget) { s_memoryBudget = memory_budget; }
+			static size_t GetResidentSize();
+
+			// after the copy submission has completed: drops the CPU copies of uploaded images and meshes
+			// as their residency asks; an image counts as uploaded once the texture sharing its content is
+			// copied, its handles stay valid and GetCvMat is empty until the pixels are restored
+			static void TrimCpuCopies();
+
+			// brings a compressed CPU copy back until the next TrimCpuCopies, throws for a released one
+			template<typename T>
+			static void RestoreCpuCopy(const AssetHandle<T>& asset_handle)
+			{
+				if (GetPool<T>().IsCpuReleased(asset_handle))
+					throw std::runtime_error("asset: the CPU copy was released");
+
+				GetPool<T>().RestoreCpuCopy(asset_handle, [](T& asset, const std::vector<std::byte>& cpu_copy)
+					{
+						DecodeCpuCopy(asset, cpu_copy);
+						return GetResidentSize(asset);
+					});
+			}
+
+			// "frame_num" > 1 after a device wait: nothing recorded before can still be in flight
+			static void AdvanceFrame(const uint64_t& frame_num = 1U) { s_frameIdx += frame_num; }
+
+			// releases unreferenced assets of "released_scope" or shorter, then evicts down to the budget
+			static void Trim(const AssetScope& released_scope = AssetScope::transient);
+
+			static void Reset()
+			{
+				std::apply([](auto&... asset_pools) { (asset_pools.Clear(), ...); }, s_assetPools);
+			}
 		};
 	};
 
@@ -363,6 +1595,7 @@ namespace hephics
 		{
 		protected:
 			std::shared_ptr<vk_interface::graphic::Pipeline> m_ptrGraphicPipeline;
+			vk_interface::graphic::PipelineBuilder::PipelineFuture m_graphicPipelineFuture; // valid while compiling
 			std::shared_ptr<vk_interface::component::DescriptorSet> m_ptrDescriptorSet;
 			std::unordered_map<std::string,
 				std::array<std::shared_ptr<hephics_helper::UniformBuffer>, BUFFERING_FRAME_NUM>> m_uniformBuffersMap;
@@ -375,6 +1608,25 @@ namespace hephics
 			}
 			~Renderer() {}
 
+			void SetGraphicPipeline(const vk_interface::graphic::PipelineBuilder::PipelineFuture& pipeline_future)
+			{
+				m_ptrGraphicPipeline = nullptr;
+				m_graphicPipelineFuture = pipeline_future;
+			}
+
+			// nullptr until the compile of the pipeline has finished, the actor is not drawn meanwhile
+			const auto& GetReadyGraphicPipeline()
+			{
+				if (m_graphicPipelineFuture.valid()
+					&& m_graphicPipelineFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+				{
+					m_ptrGraphicPipeline = m_graphicPipelineFuture.get();
+					m_graphicPipelineFuture = {};
+				}
+
+				return m_ptrGraphicPipeline;
+			}
+
 			auto& GetGraphicPipeline() { return m_ptrGraphicPipeline; }
 			auto& GetDescriptorSet() { return m_ptrDescriptorSet; }
 			auto& GetUniformBuffersMap() { return m_uniformBuffersMap; }
@@ -406,6 +1658,7 @@ namespace hephics
 			alignas(16) glm::mat4 model;
 			alignas(16) glm::mat4 view;
 			alignas(16) glm::mat4 projection;
+			alignas(16) glm::vec4 tex_coord_transform = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // see VertexQuantization
 		};
 
 		class Attachment
@@ -488,6 +1741,8 @@ namespace hephics
 				std::vector<Particle> m_particles;
 				std::array<std::shared_ptr<hephics_helper::GPUBuffer>, BUFFERING_FRAME_NUM>
 					m_vertexStorageBuffers;
+				uint32_t m_workgroupSize = 256U; // specialized into particle.comp, capped by the device
+				bool m_isBouncedAtBorder = true;
 
 				virtual void LoadData() override;
 				virtual void SetPipeline() override;
@@ -509,6 +1764,46 @@ namespace hephics
 		};
 	};
 
+	namespace culling
+	{
+		// frustum and normal cone test of every meshlet on the compute queue, drawn with drawIndexedIndirect.
+		// Culled meshlets keep their command with an instance count of 0.
+		class MeshletCuller : public actor::Attachment
+		{
+		protected:
+			struct CullingParameter
+			{
+				alignas(16) glm::vec4 frustum_planes[6];
+				alignas(16) glm::vec4 camera_position;
+				uint32_t meshlet_count;
+			};
+
+			std::shared_ptr<asset::Asset3D> m_ptrAsset3D;
+			std::shared_ptr<hephics_helper::GPUBuffer> m_ptrMeshletBuffer;
+			std::array<std::shared_ptr<hephics_helper::GPUBuffer>, BUFFERING_FRAME_NUM> m_drawCommandBuffers;
+			bool m_isMultiDrawIndirect = false;
+
+			virtual void LoadData() override;
+			virtual void SetPipeline() override;
+
+		public:
+			MeshletCuller() = default;
+
+			MeshletCuller(const std::shared_ptr<asset::Asset3D>& ptr_asset_3d)
+				: actor::Attachment(), m_ptrAsset3D(ptr_asset_3d)
+			{
+			}
+
+			virtual void Initialize() override;
+
+			// culls with the matrices of "owner", needs the "meshlet_cull" compute purpose
+			virtual void Update(actor::Actor* const owner) override;
+
+			// inside the render pass, with the vertex and index buffers of the asset bound
+			void DrawIndirect(const vk::UniqueCommandBuffer& render_command_buffer) const;
+		};
+	};
+
 	class Scene
 	{
 	protected:
@@ -600,6 +1895,8 @@ namespace hephics
 	public:
 		static void Invoke(std::unique_ptr<App>&& ptr_app)
 		{
+			hephics_helper::PackArchive::Mount(ASSET_PACK_PATH);
+
 			ptr_app->Initialize();
 			ptr_app->Run();
 
@@ -609,6 +1906,13 @@ namespace hephics
 
 		static void Shutdown()
 		{
+			hephics_helper::WorkerPool::Shutdown();
+			asset::Manager::Reset();
+			vk_interface::component::ShaderProvider::Reset();
+			vk_interface::graphic::PipelineBuilder::Reset();
+			vk_interface::compute::PipelineBuilder::Reset();
+			vk_interface::component::DescriptorSet::ResetLayouts();
+			hephics_helper::PackArchive::UnmountAll();
 			GPUHandler::Shutdown();
 			std::this_thread::sleep_for(std::chrono::milliseconds(30));
 			window::Manager::Shutdown();
@@ -51,6 +51,383 @@ namespace hephics_helper
 		void Initialize(const std::shared_ptr<vk_interface::Instance>& gpu_instance, const size_t& buffer_size);
 	};
 
+	// read-only file view: Windows file mapping, mmap elsewhere
+	class MappedFile
+	{
+	protected:
+#ifdef _WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#else
+		int32_t m_fileDescriptor = -1;
+#endif
+		const std::byte* m_ptrData = nullptr;
+		size_t m_size = 0U;
+
+	public:
+		MappedFile() = default;
+		MappedFile(const std::filesystem::path& path)
+		{
+			Open(path);
+		}
+		~MappedFile()
+		{
+			Close();
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		void Open(const std::filesystem::path& path);
+
+		void Close();
+
+		bool IsOpen() const { return m_ptrData != nullptr; }
+		const auto& GetData() const { return m_ptrData; }
+		const auto& GetSize() const { return m_size; }
+
+		template<typename T>
+		std::span<const T> GetSpan(const size_t& byte_offset, const size_t& count) const
+		{
+			if (byte_offset + sizeof(T) * count > m_size)
+				throw std::runtime_error("mapped_file: out of range");
+
+			return { reinterpret_cast<const T*>(m_ptrData + byte_offset), count };
+		}
+	};
+
+	// process-wide worker threads, started on first use
+	class WorkerPool
+	{
+	private:
+		static std::vector<std::jthread> s_workers;
+		static std::deque<std::function<void()>> s_taskQueue;
+		static std::mutex s_mutex;
+		static std::condition_variable_any s_condition;
+		static bool s_isShutdown; // set by Shutdown, cleared only by an explicit Initialize
+
+		WorkerPool() = delete;
+		~WorkerPool() = delete;
+
+		// throws once the pool is shut down
+		static void Enqueue(std::function<void()>&& task);
+		// the caller holds s_mutex
+		static void StartWorkers(const uint32_t& worker_num);
+		static void RunWorker(std::stop_token stop_token);
+
+	public:
+		// workers otherwise start on the first submission; after Shutdown only this starts them again
+		static void Initialize(const uint32_t& worker_num = 0U);
+		// joins the workers and drops queued tasks, later submissions throw
+		static void Shutdown();
+
+		// 0 once shut down, ParallelFor then runs on the calling thread alone
+		static uint32_t GetWorkerNum();
+
+		template<typename F>
+		static auto Submit(F&& function)
+		{
+			using ResultType = std::invoke_result_t<std::decay_t<F>>;
+
+			auto ptr_task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(function));
+			auto future = ptr_task->get_future();
+			Enqueue([ptr_task] { (*ptr_task)(); });
+
+			return future;
+		}
+
+		// the calling thread takes part in the loop, so this is also safe to call from a worker
+		static void ParallelFor(const size_t& count, const std::function<void(const size_t&)>& function);
+	};
+
+	namespace hash
+	{
+		uint64_t compute_xxh64(const void* ptr_data, const size_t& size, const uint64_t& seed = 0U);
+	};
+
+	// single archive of cooked assets: a table of contents over one mapped file, entries are named by their
+	// path below "assets/" and compressed entries are split into blocks that decompress on the worker pool
+	class PackArchive : public std::enable_shared_from_this<PackArchive>
+	{
+	public:
+		enum class Compression : uint32_t
+		{
+			none,
+			lz4,
+		};
+
+		// a cooked asset handed to Write, stored uncompressed when compression does not pay off
+		struct SourceEntry
+		{
+			std::string name;
+			std::vector<std::byte> data;
+			Compression compression = Compression::none;
+			// a file the asset refers to relative to itself, like the material library of an OBJ; empty: none
+			std::string dependency;
+		};
+
+		// bytes of one entry: a view into the mapped archive, or the decompressed copy
+		struct EntryData
+		{
+			std::shared_ptr<const PackArchive> ptr_archive; // keeps the view mapped
+			std::span<const std::byte> view;
+			std::vector<std::byte> buffer;
+
+			std::span<const std::byte> GetBytes() const { return buffer.empty() ? view : std::span<const std::byte>(buffer); }
+		};
+
+	private:
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entry_count;
+			uint32_t block_size;
+			uint64_t toc_offset;
+			uint64_t name_offset;
+		};
+
+		struct Entry
+		{
+			uint64_t offset;
+			uint64_t stored_size;
+			uint64_t size;
+			uint64_t content_hash;
+			uint32_t name_offset;
+			uint32_t name_length;
+			uint32_t dependency_offset; // in the name table as well
+			uint32_t dependency_length;
+			Compression compression;
+			uint32_t block_count; // compressed entries start with the stored size of every block
+		};
+
+		static constexpr uint32_t MAGIC = 0x4B415048U; // "HPAK"
+		static constexpr uint32_t VERSION = 2U;
+		static constexpr uint32_t BLOCK_SIZE = 256U << 10;
+		static constexpr size_t ENTRY_ALIGNMENT = 16U; // entries are read in place as vertex, index and SPIR-V arrays
+
+		static std::vector<std::shared_ptr<PackArchive>> s_mountedArchives;
+		static std::mutex s_mutex;
+
+		MappedFile m_mappedFile;
+		Header m_header{};
+		std::unordered_map<std::string_view, Entry> m_entryMap; // names point into the mapped file
+		std::span<const char> m_names;
+
+		void Decompress(const Entry& entry, std::byte* ptr_dst) const;
+
+	public:
+		PackArchive() = default;
+		PackArchive(const std::filesystem::path& path)
+		{
+			Open(path);
+		}
+		~PackArchive() {}
+
+		void Open(const std::filesystem::path& path);
+
+		bool Contains(const std::string& name) const { return m_entryMap.contains(name); }
+		// xxh64 of the uncompressed bytes, known without reading the entry
+		std::optional<uint64_t> FindContentHash(const std::string& name) const;
+		// the dependency the entry was cooked with, known without reading the entry
+		std::optional<std::string> FindDependency(const std::string& name) const;
+		EntryData Read(const std::string& name) const;
+
+		static bool IsCompressionSupported(const Compression& compression);
+
+		// LZ4 blocks laid out like a compressed entry, for copies kept in memory; the uncompressed size is the
+		// caller's to remember
+		static std::vector<std::byte> CompressBytes(const std::span<const std::byte>& data);
+		static void DecompressBytes(const std::span<const std::byte>& compressed_data, const std::span<std::byte>& dst);
+
+		// "assets/model/a.obj" -> "model/a.obj"
+		static std::string GetEntryName(const std::filesystem::path& asset_path);
+
+		// entries compress in parallel, the archive is published once it is complete
+		static void Write(const std::filesystem::path& path, const std::vector<SourceEntry>& entries);
+
+		// false when the file does not exist, archives mounted later shadow the entries of earlier ones
+		static bool Mount(const std::filesystem::path& path);
+		static void UnmountAll();
+
+		static std::optional<uint64_t> FindMountedContentHash(const std::string& name);
+		// nullopt when no mounted archive holds the entry, empty when it has no dependency
+		static std::optional<std::string> FindMountedDependency(const std::string& name);
+		// nullopt when no mounted archive holds the entry
+		static std::optional<EntryData> Load(const std::string& name);
+	};
+
+	// flat open-addressing table over the raw bytes of T, vertex ids follow the order of first occurrence
+	template<typename T>
+	class VertexDeduplicator
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "vertex_deduplicator: T must be trivially copyable");
+
+	private:
+		// id 0 marks an empty slot, otherwise vertex index + 1
+		struct Slot
+		{
+			uint32_t hash_tag;
+			uint32_t id;
+		};
+
+		static constexpr size_t MIN_SLOT_NUM = 16U;
+		static constexpr size_t PARALLEL_MIN_CORNER_NUM = 1U << 16;
+		static constexpr size_t PARALLEL_BLOCK_SIZE = 1U << 16;
+
+		std::vector<Slot> m_slots;
+		std::vector<T> m_vertices;
+
+		void Rehash(const size_t& slot_num)
+		{
+			m_slots.assign(slot_num, Slot{ 0U, 0U });
+
+			const auto slot_mask = slot_num - 1U;
+			for (size_t vertex_idx = 0U; vertex_idx < m_vertices.size(); vertex_idx++)
+			{
+				const auto hash_value = Hash(m_vertices.at(vertex_idx));
+
+				auto slot_idx = static_cast<size_t>(hash_value) & slot_mask;
+				while (m_slots.at(slot_idx).id != 0U)
+					slot_idx = (slot_idx + 1U) & slot_mask;
+
+				m_slots.at(slot_idx) = Slot{ static_cast<uint32_t>(hash_value >> 32), static_cast<uint32_t>(vertex_idx + 1U) };
+			}
+		}
+
+	public:
+		VertexDeduplicator() = default;
+		VertexDeduplicator(const size_t& expected_num)
+		{
+			Reserve(expected_num);
+		}
+		~VertexDeduplicator() {}
+
+		static uint64_t Hash(const T& vertex)
+		{
+			return hash::compute_xxh64(&vertex, sizeof(T));
+		}
+
+		// keeps the load factor at or below one half for "expected_num" vertices
+		void Reserve(const size_t& expected_num)
+		{
+			const auto slot_num = std::bit_ceil(std::max(expected_num * 2U, MIN_SLOT_NUM));
+			if (slot_num > m_slots.size())
+				Rehash(slot_num);
+		}
+
+		uint32_t Insert(const T& vertex)
+		{
+			return Insert(vertex, Hash(vertex));
+		}
+
+		uint32_t Insert(const T& vertex, const uint64_t& hash_value)
+		{
+			if ((m_vertices.size() + 1U) * 2U > m_slots.size())
+				Rehash(std::max(m_slots.size() * 2U, MIN_SLOT_NUM));
+
+			const auto slot_mask = m_slots.size() - 1U;
+			const auto hash_tag = static_cast<uint32_t>(hash_value >> 32);
+
+			auto slot_idx = static_cast<size_t>(hash_value) & slot_mask;
+			while (true)
+			{
+				auto& slot = m_slots[slot_idx];
+				if (slot.id == 0U)
+				{
+					m_vertices.emplace_back(vertex);
+					slot = Slot{ hash_tag, static_cast<uint32_t>(m_vertices.size()) };
+					return slot.id - 1U;
+				}
+
+				if (slot.hash_tag == hash_tag && std::memcmp(&m_vertices[slot.id - 1U], &vertex, sizeof(T)) == 0)
+					return slot.id - 1U;
+
+				slot_idx = (slot_idx + 1U) & slot_mask;
+			}
+		}
+
+		const auto& GetVertices() const { return m_vertices; }
+		auto& GetVertices() { return m_vertices; }
+
+		// "make_vertex(corner_idx)" builds the vertex of each index; the result matches a sequential Insert loop.
+		// Shards own a range of hash values, so every vertex is compared in exactly one table.
+		template<typename F>
+		static void Deduplicate(const size_t& corner_num, const F& make_vertex,
+			std::vector<T>& vertices, std::vector<uint32_t>& indices)
+		{
+			indices.resize(corner_num);
+
+			const auto shard_num = std::bit_ceil(static_cast<size_t>(WorkerPool::GetWorkerNum()) + 1U);
+			if (corner_num < PARALLEL_MIN_CORNER_NUM || shard_num == 1U)
+			{
+				VertexDeduplicator deduplicator(corner_num);
+				for (size_t corner_idx = 0U; corner_idx < corner_num; corner_idx++)
+					indices[corner_idx] = deduplicator.Insert(make_vertex(corner_idx));
+
+				vertices = std::move(deduplicator.m_vertices);
+				return;
+			}
+
+			const auto shard_shift = 64 - std::countr_zero(shard_num);
+			const auto block_num = (corner_num + PARALLEL_BLOCK_SIZE - 1U) / PARALLEL_BLOCK_SIZE;
+
+			std::vector<uint64_t> hash_values(corner_num);
+			WorkerPool::ParallelFor(block_num, [&](const size_t& block_idx)
+				{
+					const auto corner_end = std::min(corner_num, (block_idx + 1U) * PARALLEL_BLOCK_SIZE);
+					for (auto corner_idx = block_idx * PARALLEL_BLOCK_SIZE; corner_idx < corner_end; corner_idx++)
+						hash_values[corner_idx] = Hash(make_vertex(corner_idx));
+				});
+
+			// every shard scans the corners in order: shard-local ids follow first occurrence as well
+			std::vector<VertexDeduplicator> shards(shard_num);
+			std::vector<uint8_t> first_occurrences(corner_num, 0U);
+			WorkerPool::ParallelFor(shard_num, [&](const size_t& shard_idx)
+				{
+					auto& shard = shards.at(shard_idx);
+					shard.Reserve(corner_num / shard_num);
+
+					for (size_t corner_idx = 0U; corner_idx < corner_num; corner_idx++)
+					{
+						if ((hash_values[corner_idx] >> shard_shift) != shard_idx)
+							continue;
+
+						const auto vertex_num = shard.m_vertices.size();
+						indices[corner_idx] = shard.Insert(make_vertex(corner_idx), hash_values[corner_idx]);
+						first_occurrences[corner_idx] = shard.m_vertices.size() > vertex_num;
+					}
+				});
+
+			std::vector<std::vector<uint32_t>> shard_remaps(shard_num);
+			size_t vertex_num = 0U;
+			for (size_t shard_idx = 0U; shard_idx < shard_num; shard_idx++)
+			{
+				shard_remaps.at(shard_idx).resize(shards.at(shard_idx).m_vertices.size());
+				vertex_num += shards.at(shard_idx).m_vertices.size();
+			}
+
+			vertices.clear();
+			vertices.reserve(vertex_num);
+			for (size_t corner_idx = 0U; corner_idx < corner_num; corner_idx++)
+			{
+				if (!first_occurrences[corner_idx])
+					continue;
+
+				const auto shard_idx = static_cast<size_t>(hash_values[corner_idx] >> shard_shift);
+				shard_remaps[shard_idx][indices[corner_idx]] = static_cast<uint32_t>(vertices.size());
+				vertices.emplace_back(shards[shard_idx].m_vertices[indices[corner_idx]]);
+			}
+
+			WorkerPool::ParallelFor(block_num, [&](const size_t& block_idx)
+				{
+					const auto corner_end = std::min(corner_num, (block_idx + 1U) * PARALLEL_BLOCK_SIZE);
+					for (auto corner_idx = block_idx * PARALLEL_BLOCK_SIZE; corner_idx < corner_end; corner_idx++)
+						indices[corner_idx] = shard_remaps[hash_values[corner_idx] >> shard_shift][indices[corner_idx]];
+				});
+		}
+	};
+
 	namespace vk_init
 	{
 #ifdef _DEBUG
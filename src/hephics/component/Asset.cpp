@@ -1,18 +1,40 @@
 #include "../Hephics.hpp"
 
-template<> struct std::hash<hephics::asset::VertexData>
+std::tuple<hephics::asset::AssetPool<cv::Mat>, hephics::asset::AssetPool<hephics::asset::Texture>,
+	hephics::asset::AssetPool<hephics::asset::TextureAtlas>, hephics::asset::AssetPool<hephics::asset::Texture3D>,
+	hephics::asset::AssetPool<hephics::asset::Object3D>, hephics::asset::AssetPool<hephics::asset::Gltf3D>,
+	hephics::asset::AssetPool<hephics::asset::Fbx3D>>
+hephics::asset::Manager::s_assetPools;
+size_t hephics::asset::Manager::s_memoryBudget = 0U;
+uint64_t hephics::asset::Manager::s_frameIdx = 0U;
+bool hephics::asset::Manager::s_isTrimPending = false;
+
+void hephics::asset::Texture::CreateImage(const uint32_t& width, const uint32_t& height)
 {
-	size_t operator()(hephics::asset::VertexData const& vertex) const
-	{
-		const auto&& ret = ((std::hash<glm::vec3>()(vertex.pos) ^
-			(std::hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-			(std::hash<glm::vec2>()(vertex.tex_coord) << 1);
-		return ret;
-	}
-};
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+
+	m_ptrImage = std::make_shared<vk_interface::component::Image>();
+	auto image_create_info = hephics_helper::simple_create_info::get_texture_image_info(
+		gpu_instance, vk::Extent2D{ width, height });
+	image_create_info.setMipLevels(m_miplevel);
+	m_ptrImage->SetImage(logical_device, image_create_info);
+
+	const auto memory_requirements = logical_device->getImageMemoryRequirements(m_ptrImage->GetImage().get());
+	const auto memory_type_idx =
+		gpu_instance->FindMemoryType(memory_requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	vk::MemoryAllocateInfo alloc_info(memory_requirements.size, memory_type_idx);
+	m_ptrImage->SetMemory(logical_device, alloc_info);
+
+	m_ptrImage->BindMemory(logical_device);
+
+	auto view_create_info = hephics_helper::simple_create_info::get_texture_image_view_info(m_ptrImage->GetImage());
+	view_create_info.subresourceRange.setLevelCount(m_miplevel);
+	m_ptrImage->SetImageView(logical_device, view_create_info);
 
-std::unordered_map<std::string, std::unordered_map<std::string, hephics::asset::AssetVariant>>
-hephics::asset::Manager::s_assetDictionaries;
+	SetSampler(logical_device,
+		hephics_helper::simple_create_info::get_texture_sampler_info(gpu_instance));
+}
 
 void hephics::asset::Texture::GenerateMipmaps(const uint32_t& width, const uint32_t& height)
 {
@@ -80,80 +102,49 @@ void hephics::asset::Texture::GenerateMipmaps(const uint32_t& width, const uint3
 
 hephics::asset::Texture::Texture(const std::string& path, const std::string& cv_mat_key)
 {
-	const auto& gpu_instance = GPUHandler::GetInstance();
-
-	hephics::asset::Manager::RegistCvMat(path, cv_mat_key);
-	const auto& cv_mat = hephics::asset::Manager::GetCvMat(cv_mat_key);
+	const auto& cv_mat = hephics::asset::Manager::GetCvMat(hephics::asset::Manager::RegistCvMat(path, cv_mat_key));
 	const auto& cv_mat_size = cv_mat->size();
 	m_miplevel = static_cast<uint32_t>(std::floor(std::log2(std::max(cv_mat_size.width, cv_mat_size.height)))) + 1U;
+	SetResidentSize(cv_mat_size.width, cv_mat_size.height);
 
-	const auto& physical_device = gpu_instance->GetPhysicalDevice();
-	const auto& window_surface = gpu_instance->GetWindowSurface();
-	const auto& logical_device = gpu_instance->GetLogicalDevice();
-	const auto& queue_family_array = gpu_instance->GetQueueFamilyIndices().get_families_array();
-
-	m_ptrImage = std::make_shared<vk_interface::component::Image>();
-	auto image_create_info = hephics_helper::simple_create_info::get_texture_image_info(
-		gpu_instance,
-		vk::Extent2D{
-			static_cast<uint32_t>(cv_mat_size.width),
-			static_cast<uint32_t>(cv_mat_size.height)
-		});
-	image_create_info.setMipLevels(m_miplevel);
-	m_ptrImage->SetImage(logical_device, image_create_info);
-
-	const auto memory_requirements = logical_device->getImageMemoryRequirements(m_ptrImage->GetImage().get());
-	const auto memory_type_idx =
-		gpu_instance->FindMemoryType(memory_requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
-	vk::MemoryAllocateInfo alloc_info(memory_requirements.size, memory_type_idx);
-	m_ptrImage->SetMemory(logical_device, alloc_info);
-
-	m_ptrImage->BindMemory(logical_device);
-
-	auto view_create_info = hephics_helper::simple_create_info::get_texture_image_view_info(m_ptrImage->GetImage());
-	view_create_info.subresourceRange.setLevelCount(m_miplevel);
-	m_ptrImage->SetImageView(logical_device, view_create_info);
-
-	SetSampler(logical_device,
-		hephics_helper::simple_create_info::get_texture_sampler_info(gpu_instance));
+	CreateImage(cv_mat_size.width, cv_mat_size.height);
 }
 
 hephics::asset::Texture::Texture(const std::shared_ptr<cv::Mat>& cv_mat)
 {
-	const auto& gpu_instance = GPUHandler::GetInstance();
-
 	const auto& cv_mat_size = cv_mat->size();
 	m_miplevel = static_cast<uint32_t>(std::floor(std::log2(std::max(cv_mat_size.width, cv_mat_size.height)))) + 1U;
+	SetResidentSize(cv_mat_size.width, cv_mat_size.height);
 
-	const auto& physical_device = gpu_instance->GetPhysicalDevice();
-	const auto& window_surface = gpu_instance->GetWindowSurface();
-	const auto& logical_device = gpu_instance->GetLogicalDevice();
-	const auto& queue_family_array = gpu_instance->GetQueueFamilyIndices().get_families_array();
-
-	m_ptrImage = std::make_shared<vk_interface::component::Image>();
-	auto image_create_info = hephics_helper::simple_create_info::get_texture_image_info(
-		gpu_instance,
-		vk::Extent2D{
-			static_cast<uint32_t>(cv_mat_size.width),
-			static_cast<uint32_t>(cv_mat_size.height)
-		});
-	image_create_info.setMipLevels(m_miplevel);
-	m_ptrImage->SetImage(logical_device, image_create_info);
-
-	const auto memory_requirements = logical_device->getImageMemoryRequirements(m_ptrImage->GetImage().get());
-	const auto memory_type_idx =
-		gpu_instance->FindMemoryType(memory_requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
-	vk::MemoryAllocateInfo alloc_info(memory_requirements.size, memory_type_idx);
-	m_ptrImage->SetMemory(logical_device, alloc_info);
-
-	m_ptrImage->BindMemory(logical_device);
+	CreateImage(cv_mat_size.width, cv_mat_size.height);
+}
 
-	auto view_create_info = hephics_helper::simple_create_info::get_texture_image_view_info(m_ptrImage->GetImage());
-	view_create_info.subresourceRange.setLevelCount(m_miplevel);
-	m_ptrImage->SetImageView(logical_device, view_create_info);
+hephics::asset::Texture::Texture(hephics_helper::PackArchive::EntryData&& cooked_image)
+{
+	const auto cooked_bytes = cooked_image.GetBytes();
+	if (cooked_bytes.size() < sizeof(CookedHeader))
+		throw std::runtime_error("texture: broken cooked image");
+
+	CookedHeader header{};
+	std::memcpy(&header, cooked_bytes.data(), sizeof(CookedHeader));
+	if (header.magic != COOKED_MAGIC || header.version != COOKED_VERSION || header.mip_num == 0U)
+		throw std::runtime_error("texture: unsupported cooked image");
+
+	m_miplevel = header.mip_num;
+	SetResidentSize(header.width, header.height);
+	if (cooked_bytes.size() != sizeof(CookedHeader) + m_residentSize)
+		throw std::runtime_error("texture: broken cooked image");
+
+	CreateImage(header.width, header.height);
+	m_isCooked = true;
+	m_cookedImage = std::move(cooked_image);
+}
 
-	SetSampler(logical_device,
-		hephics_helper::simple_create_info::get_texture_sampler_info(gpu_instance));
+void hephics::asset::Texture::SetResidentSize(const uint32_t& width, const uint32_t& height)
+{
+	m_residentSize = 0U;
+	for (uint32_t mip_idx = 0U; mip_idx < m_miplevel; mip_idx++)
+		m_residentSize += sizeof(uint32_t) * std::max(width >> mip_idx, 1U) * std::max(height >> mip_idx, 1U);
 }
 
 void hephics::asset::Texture::SetSampler(const vk::UniqueDevice& logical_device,
@@ -173,6 +164,9 @@ void hephics::asset::Texture::SetSampler(const vk::UniqueDevice& logical_device,
 
 void hephics::asset::Texture::CopyTexture(const std::shared_ptr<cv::Mat>& cv_mat)
 {
+	if (m_isTextureCopied)
+		return;
+
 	const auto& gpu_instance = GPUHandler::GetInstance();
 
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
@@ -198,252 +192,1604 @@ void hephics::asset::Texture::CopyTexture(const std::shared_ptr<cv::Mat>& cv_mat
 
 	auto& staging_buffers = Scene::GetStagingBuffers();
 	staging_buffers.emplace_back(std::move(staging_buffer));
+	m_isTextureCopied = true;
 }
 
-void hephics::asset::Asset3D::CopyVertexBuffer() const
+void hephics::asset::Texture::CopyTexture()
 {
+	if (!m_isCooked)
+		throw std::runtime_error("texture: no cooked image");
+	if (m_isTextureCopied)
+		return;
+
 	const auto& gpu_instance = GPUHandler::GetInstance();
 
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	const auto& command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
 
-	const auto& buffer_size = m_ptrVertexBuffer->GetSize();
-	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, buffer_size);
+	const auto cooked_bytes = m_cookedImage->GetBytes();
+	CookedHeader header{};
+	std::memcpy(&header, cooked_bytes.data(), sizeof(CookedHeader));
+
+	const auto level_bytes = cooked_bytes.subspan(sizeof(CookedHeader));
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, level_bytes.size());
 	auto staging_map_address = staging_buffer->Mapping(logical_device);
-	std::memcpy(staging_map_address, m_vertices.data(), buffer_size);
+	std::memcpy(staging_map_address, level_bytes.data(), level_bytes.size());
 	staging_buffer->Unmapping(logical_device);
 
-	command_buffer->CopyBuffer(staging_buffer, m_ptrVertexBuffer, buffer_size);
+	std::vector<vk::BufferImageCopy> image_copy_regions;
+	size_t level_offset = 0U;
+	for (uint32_t mip_idx = 0U; mip_idx < m_miplevel; mip_idx++)
+	{
+		const auto mip_width = std::max(header.width >> mip_idx, 1U);
+		const auto mip_height = std::max(header.height >> mip_idx, 1U);
+
+		image_copy_regions.emplace_back(level_offset, 0, 0,
+			vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip_idx, 0, 1),
+			vk::Offset3D(0, 0, 0), vk::Extent3D(mip_width, mip_height, 1U));
+		level_offset += sizeof(uint32_t) * mip_width * mip_height;
+	}
+
+	command_buffer->TransitionImageCommandLayout(m_ptrImage, vk::Format::eR8G8B8A8Srgb,
+		{ vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal }, m_miplevel);
+	command_buffer->GetCommandBuffer()->copyBufferToImage(staging_buffer->GetBuffer().get(),
+		m_ptrImage->GetImage().get(), vk::ImageLayout::eTransferDstOptimal, image_copy_regions);
+	command_buffer->TransitionImageCommandLayout(m_ptrImage, vk::Format::eR8G8B8A8Srgb,
+		{ vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal }, m_miplevel);
 
 	auto& staging_buffers = Scene::GetStagingBuffers();
 	staging_buffers.emplace_back(std::move(staging_buffer));
+
+	// the levels now live in the staging buffer, the pack view or decompressed copy is not needed anymore
+	m_cookedImage.reset();
+	m_isTextureCopied = true;
 }
 
-void hephics::asset::Asset3D::CopyIndexBuffer() const
+cv::Mat hephics::asset::Texture::ResizeSrgb(const cv::Mat& rgba_image, const cv::Size& level_size)
 {
-	const auto& gpu_instance = GPUHandler::GetInstance();
+	// 8-bit sRGB to linear, and linear quantized to 16 bits back to 8-bit sRGB
+	static const auto [to_linear, to_srgb] = []
+		{
+			std::array<float, 256> to_linear{};
+			for (size_t idx = 0U; idx < to_linear.size(); idx++)
+			{
+				const auto srgb = static_cast<float>(idx) / 255.0f;
+				to_linear.at(idx) = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+			}
 
-	const auto& logical_device = gpu_instance->GetLogicalDevice();
-	const auto& command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
+			std::vector<uint8_t> to_srgb(65536U);
+			for (size_t idx = 0U; idx < to_srgb.size(); idx++)
+			{
+				const auto linear = static_cast<float>(idx) / 65535.0f;
+				const auto srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+				to_srgb.at(idx) = static_cast<uint8_t>(std::lround(srgb * 255.0f));
+			}
 
-	const auto& buffer_size = m_ptrIndexBuffer->GetSize();
-	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, buffer_size);
-	auto staging_map_address = staging_buffer->Mapping(logical_device);
-	std::memcpy(staging_map_address, m_indices.data(), buffer_size);
-	staging_buffer->Unmapping(logical_device);
+			return std::make_pair(to_linear, std::move(to_srgb));
+		}();
 
-	command_buffer->CopyBuffer(staging_buffer, m_ptrIndexBuffer, buffer_size);
+	cv::Mat linear_image(rgba_image.size(), CV_32FC4);
+	for (int32_t row = 0; row < rgba_image.rows; row++)
+	{
+		const auto ptr_src = rgba_image.ptr<cv::Vec4b>(row);
+		const auto ptr_dst = linear_image.ptr<cv::Vec4f>(row);
+		for (int32_t col = 0; col < rgba_image.cols; col++)
+			ptr_dst[col] = cv::Vec4f(to_linear[ptr_src[col][0]], to_linear[ptr_src[col][1]], to_linear[ptr_src[col][2]],
+				ptr_src[col][3] / 255.0f);
+	}
 
-	auto& staging_buffers = Scene::GetStagingBuffers();
-	staging_buffers.emplace_back(std::move(staging_buffer));
+	cv::Mat linear_level;
+	cv::resize(linear_image, linear_level, level_size, 0.0, 0.0, cv::INTER_AREA);
+
+	const auto quantize = [](const float& value, const float& scale)
+		{
+			return static_cast<size_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * scale));
+		};
+
+	cv::Mat level_image(level_size, CV_8UC4);
+	for (int32_t row = 0; row < level_image.rows; row++)
+	{
+		const auto ptr_src = linear_level.ptr<cv::Vec4f>(row);
+		const auto ptr_dst = level_image.ptr<cv::Vec4b>(row);
+		for (int32_t col = 0; col < level_image.cols; col++)
+			ptr_dst[col] = cv::Vec4b(to_srgb[quantize(ptr_src[col][0], 65535.0f)], to_srgb[quantize(ptr_src[col][1], 65535.0f)],
+				to_srgb[quantize(ptr_src[col][2], 65535.0f)], static_cast<uint8_t>(quantize(ptr_src[col][3], 255.0f)));
+	}
+
+	return level_image;
 }
 
-hephics::asset::Texture3D::Texture3D(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+std::vector<std::byte> hephics::asset::Texture::Cook(const cv::Mat& rgba_image)
 {
-	const auto& gpu_instance = GPUHandler::GetInstance();
+	if (rgba_image.empty() || rgba_image.type() != CV_8UC4)
+		throw std::runtime_error("texture: cooking needs an RGBA8 image");
+
+	CookedHeader header{};
+	header.magic = COOKED_MAGIC;
+	header.version = COOKED_VERSION;
+	header.width = static_cast<uint32_t>(rgba_image.cols);
+	header.height = static_cast<uint32_t>(rgba_image.rows);
+	header.mip_num = static_cast<uint32_t>(std::floor(std::log2(std::max(header.width, header.height)))) + 1U;
+
+	std::vector<std::byte> cooked_image(sizeof(CookedHeader));
+	std::memcpy(cooked_image.data(), &header, sizeof(CookedHeader));
+
+	// same halving as the runtime blits, area filtering instead of a linear blit
+	cv::Mat level_image = rgba_image.isContinuous() ? rgba_image : rgba_image.clone();
+	for (uint32_t mip_idx = 0U; mip_idx < header.mip_num; mip_idx++)
+	{
+		if (mip_idx > 0U)
+			level_image = ResizeSrgb(level_image, cv::Size(std::max(level_image.cols / 2, 1), std::max(level_image.rows / 2, 1)));
 
-	m_vertices = vertices;
-	m_indices = indices;
-	const auto vertex_size = sizeof(VertexData) * m_vertices.size();
-	const auto index_size = sizeof(uint32_t) * m_indices.size();
+		const auto ptr_level = reinterpret_cast<const std::byte*>(level_image.data);
+		cooked_image.insert(cooked_image.end(), ptr_level, ptr_level + level_image.total() * level_image.elemSize());
+	}
 
-	m_ptrVertexBuffer =
-		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, vertex_size, vk::BufferUsageFlagBits::eVertexBuffer);
-	m_ptrIndexBuffer =
-		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, index_size, vk::BufferUsageFlagBits::eIndexBuffer);
+	return cooked_image;
 }
 
-hephics::asset::Object3D::Object3D(const std::string& path)
+void hephics::asset::Asset3D::SetVertexLayout(const VertexLayoutType& vertex_layout_type,
+	const BoundingBox& tex_coord_bounds)
 {
-	const auto& gpu_instance = GPUHandler::GetInstance();
+	m_vertexLayoutType = vertex_layout_type;
+	m_vertexQuantization = visit_vertex_layout(m_vertexLayoutType, [&](auto layout)
+		{
+			return decltype(layout)::type::get_quantization(m_bounds, tex_coord_bounds);
+		});
+}
 
-	m_ptrAttribute = std::make_shared<tinyobj::attrib_t>();
+void hephics::asset::Asset3D::SetVertexLayout(const VertexLayoutType& vertex_layout_type)
+{
+	BoundingBox tex_coord_bounds;
+	for (const auto& vertex : GetVertices())
+		tex_coord_bounds.Expand(glm::vec3(vertex.tex_coord, 0.0f));
 
-	std::string warn, err;
-	if (!tinyobj::LoadObj(m_ptrAttribute.get(), &m_shapes, &m_materials, &warn, &err, path.c_str()))
-		throw std::runtime_error(warn + err);
+	SetVertexLayout(vertex_layout_type, tex_coord_bounds);
+}
 
-	std::unordered_map<VertexData, uint32_t> unique_vertices{};
+uint32_t hephics::asset::Asset3D::GetVertexStride() const
+{
+	return visit_vertex_layout(m_vertexLayoutType, [](auto layout) { return decltype(layout)::type::STRIDE; });
+}
 
-	for (const auto& shape : m_shapes)
-	{
-		for (const auto& index : shape.mesh.indices)
+vk::VertexInputBindingDescription hephics::asset::Asset3D::GetVertexBindingDescription() const
+{
+	return visit_vertex_layout(m_vertexLayoutType,
+		[](auto layout) { return decltype(layout)::type::get_binding_description(); });
+}
+
+std::vector<vk::VertexInputAttributeDescription> hephics::asset::Asset3D::GetVertexAttributeDescriptions() const
+{
+	return visit_vertex_layout(m_vertexLayoutType, [](auto layout)
 		{
-			VertexData vertex{};
+			const auto attribute_descriptions = decltype(layout)::type::get_attribute_descriptions();
+			return std::vector<vk::VertexInputAttributeDescription>(
+				attribute_descriptions.begin(), attribute_descriptions.end());
+		});
+}
 
-			vertex.pos =
-			{
-				m_ptrAttribute->vertices.at(3 * index.vertex_index + 0),
-				m_ptrAttribute->vertices.at(3 * index.vertex_index + 1),
-				m_ptrAttribute->vertices.at(3 * index.vertex_index + 2)
-			};
+void hephics::asset::Asset3D::EncodeVertices(const std::span<const VertexData>& vertices, std::byte* ptr_dst) const
+{
+	visit_vertex_layout(m_vertexLayoutType,
+		[&](auto layout) { decltype(layout)::type::encode(vertices, m_vertexQuantization, ptr_dst); });
+}
 
-			vertex.tex_coord =
-			{
-				m_ptrAttribute->texcoords.at(2 * index.texcoord_index + 0),
-				1.0f - m_ptrAttribute->texcoords.at(2 * index.texcoord_index + 1)
-			};
+void hephics::asset::Asset3D::PrepareIndices(const bool& is_index_split)
+{
+	if (m_lodLevels.empty())
+		m_lodLevels.emplace_back(LodLevel{ 0U, static_cast<uint32_t>(GetIndices().size()), 0.0f });
 
-			vertex.color = { 1.0f, 1.0f, 1.0f };
+	m_drawRanges.clear();
+	m_lodDrawRangeStarts.clear();
 
-			if (unique_vertices.count(vertex) == 0)
+	const auto is_split = is_index_split && GetVertices().size() > MAX_UINT16_VERTEX_NUM;
+	if (is_split)
+		SplitIndexRanges();
+	else
+	{
+		for (const auto& lod_level : m_lodLevels)
+		{
+			m_lodDrawRangeStarts.emplace_back(m_drawRanges.size());
+			for (const auto& material_range : GetLevelMaterialRanges(lod_level))
 			{
-				unique_vertices.emplace(vertex, static_cast<uint32_t>(m_vertices.size()));
-				m_vertices.emplace_back(vertex);
+				m_drawRanges.emplace_back(DrawRange{
+					material_range.first_index, material_range.index_count, 0, material_range.material_id });
 			}
-			m_indices.emplace_back(unique_vertices.at(vertex));
 		}
 	}
+	m_lodDrawRangeStarts.emplace_back(m_drawRanges.size());
 
-	const auto vertex_size = sizeof(VertexData) * m_vertices.size();
-	const auto index_size = sizeof(uint32_t) * m_indices.size();
-
-	m_ptrVertexBuffer =
-		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, vertex_size, vk::BufferUsageFlagBits::eVertexBuffer);
-	m_ptrIndexBuffer =
-		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, index_size, vk::BufferUsageFlagBits::eIndexBuffer);
+	// after a split every range addresses at most 65536 vertices from its own offset
+	m_indexType = is_split || GetVertices().size() <= MAX_UINT16_VERTEX_NUM
+		? vk::IndexType::eUint16 : vk::IndexType::eUint32;
 }
 
-void hephics::asset::Manager::RegistCvMat(const std::string& asset_path, const std::string& asset_key)
+void hephics::asset::Asset3D::SplitIndexRanges()
 {
-	if (!s_assetDictionaries.contains("cv_mat"))
-		s_assetDictionaries["cv_mat"] = {};
+	constexpr auto UNUSED = std::numeric_limits<uint32_t>::max();
 
-	if (s_assetDictionaries.at("cv_mat").contains(asset_key))
-		return;
+	const auto vertices = GetVertices();
+	const auto indices = GetIndices();
 
-	auto img = cv::imread(std::format("assets/img/{}", asset_path));
-	cv::cvtColor(img, img, cv::COLOR_BGR2RGBA);
-	s_assetDictionaries.at("cv_mat").emplace(asset_key, std::make_shared<cv::Mat>(img));
-}
+	std::vector<VertexData> split_vertices;
+	std::vector<uint32_t> split_indices;
+	std::vector<MaterialRange> split_material_ranges;
+	split_indices.reserve(indices.size());
 
-void hephics::asset::Manager::RegistCvMat(const std::string& asset_key, const cv::Mat& cv_mat)
-{
-	if (!s_assetDictionaries.contains("cv_mat"))
-		s_assetDictionaries["cv_mat"] = {};
+	// vertices shared across a range border are duplicated into the next range
+	std::vector<uint32_t> local_ids(vertices.size(), UNUSED);
+	std::vector<uint32_t> range_vertex_ids;
+	DrawRange draw_range{ 0U, 0U, 0 };
 
-	if (s_assetDictionaries.at("cv_mat").contains(asset_key))
-		return;
+	// the range after a material border keeps addressing the same vertices
+	const auto close_range = [&](const bool& is_vertex_window_kept = false)
+		{
+			draw_range.index_count = static_cast<uint32_t>(split_indices.size()) - draw_range.first_index;
+			if (draw_range.index_count > 0U)
+				m_drawRanges.emplace_back(draw_range);
+			draw_range.first_index = static_cast<uint32_t>(split_indices.size());
 
-	s_assetDictionaries.at("cv_mat").emplace(asset_key, std::make_shared<cv::Mat>(cv_mat));
-}
+			if (is_vertex_window_kept)
+				return;
 
-void hephics::asset::Manager::RegistObject3D(const std::string& asset_path, const std::string& asset_key)
-{
-	if (!s_assetDictionaries.contains("object_3d"))
-		s_assetDictionaries["object_3d"] = {};
+			for (const auto& vertex_id : range_vertex_ids)
+				local_ids[vertex_id] = UNUSED;
+			range_vertex_ids.clear();
 
-	if (s_assetDictionaries.at("object_3d").contains(asset_key))
-		return;
+			draw_range.vertex_offset = static_cast<int32_t>(split_vertices.size());
+		};
+
+	// every level of detail and every material starts with its own range, and a meshlet never crosses one
+	size_t meshlet_idx = 0U;
+	for (auto& lod_level : m_lodLevels)
+	{
+		m_lodDrawRangeStarts.emplace_back(m_drawRanges.size());
+		const auto first_index = static_cast<uint32_t>(split_indices.size());
+		const auto is_full_mesh = &lod_level == &m_lodLevels.front();
+
+		for (const auto& material_range : GetLevelMaterialRanges(lod_level))
+		{
+			const auto material_first_index = static_cast<uint32_t>(split_indices.size());
+			const auto material_end = material_range.first_index + material_range.index_count;
+			draw_range.material_id = material_range.material_id;
+
+			for (auto corner_idx = material_range.first_index; corner_idx + 2U < material_end; corner_idx += 3U)
+			{
+				if (is_full_mesh && meshlet_idx < m_meshlets.size() && m_meshlets.at(meshlet_idx).first_index == corner_idx)
+				{
+					if (range_vertex_ids.size() + mesh_optimizer::MESHLET_MAX_VERTEX_NUM > MAX_UINT16_VERTEX_NUM)
+						close_range();
+
+					auto& meshlet = m_meshlets.at(meshlet_idx++);
+					meshlet.first_index = static_cast<uint32_t>(split_indices.size());
+					meshlet.vertex_offset = draw_range.vertex_offset;
+				}
+
+				const auto& i0 = indices[corner_idx + 0U];
+				const auto& i1 = indices[corner_idx + 1U];
+				const auto& i2 = indices[corner_idx + 2U];
+
+				size_t new_vertex_num = (local_ids[i0] == UNUSED) + (local_ids[i1] == UNUSED && i1 != i0)
+					+ (local_ids[i2] == UNUSED && i2 != i0 && i2 != i1);
+				if (range_vertex_ids.size() + new_vertex_num > MAX_UINT16_VERTEX_NUM)
+					close_range();
+
+				for (const auto& vertex_id : { i0, i1, i2 })
+				{
+					if (local_ids[vertex_id] == UNUSED)
+					{
+						local_ids[vertex_id] = static_cast<uint32_t>(range_vertex_ids.size());
+						range_vertex_ids.emplace_back(vertex_id);
+						split_vertices.emplace_back(vertices[vertex_id]);
+					}
+					split_indices.emplace_back(local_ids[vertex_id]);
+				}
+			}
+			close_range(true);
+
+			split_material_ranges.emplace_back(MaterialRange{ material_first_index,
+				static_cast<uint32_t>(split_indices.size()) - material_first_index, material_range.material_id });
+		}
+		close_range();
 
-	s_assetDictionaries.at("object_3d").emplace(asset_key,
-		std::make_shared<Object3D>(std::format("assets/model/{}", asset_path)));
+		lod_level.first_index = first_index;
+		lod_level.index_count = static_cast<uint32_t>(split_indices.size()) - first_index;
+	}
+
+	m_vertices = std::move(split_vertices);
+	m_indices = std::move(split_indices);
+	if (!m_materialRanges.empty())
+		m_materialRanges = std::move(split_material_ranges);
+	m_ptrMeshCache.reset();
 }
 
-void hephics::asset::Manager::RegistFbx3D(const std::string& asset_path, const std::string& asset_key)
+void hephics::asset::Asset3D::EncodeIndices(const std::span<const uint32_t>& indices, std::byte* ptr_dst) const
 {
-	if (!s_assetDictionaries.contains("fbx_3d"))
-		s_assetDictionaries["fbx_3d"] = {};
-
-	if (s_assetDictionaries.at("fbx_3d").contains(asset_key))
+	if (m_indexType == vk::IndexType::eUint32)
+	{
+		std::memmove(ptr_dst, indices.data(), indices.size_bytes());
 		return;
+	}
 
-	s_assetDictionaries.at("fbx_3d").emplace(asset_key,
-		std::make_shared<Fbx3D>(std::format("assets/model/{}", asset_path)));
+	// narrowing front to back, so "ptr_dst" may alias the source indices
+	for (size_t index_idx = 0U; index_idx < indices.size(); index_idx++)
+	{
+		const auto index = static_cast<uint16_t>(indices[index_idx]);
+		std::memcpy(ptr_dst + sizeof(uint16_t) * index_idx, &index, sizeof(uint16_t));
+	}
 }
 
-void hephics::asset::Manager::RegistTexture(const std::string& asset_path, const std::string& asset_key)
+void hephics::asset::Asset3D::CopyStagedChunks(std::vector<StagedChunk>& staged_chunks,
+	const std::shared_ptr<hephics_helper::GPUBuffer>& dst_buffer)
 {
-	if (!s_assetDictionaries.contains("texture"))
-		s_assetDictionaries["texture"] = {};
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
+	auto& staging_buffers = Scene::GetStagingBuffers();
 
-	if (s_assetDictionaries.at("texture").contains(asset_key))
-		return;
+	for (auto& staged_chunk : staged_chunks)
+	{
+		command_buffer->CopyBuffer(staged_chunk.ptr_staging_buffer, dst_buffer,
+			staged_chunk.size, 0U, staged_chunk.dst_offset);
+		staging_buffers.emplace_back(std::move(staged_chunk.ptr_staging_buffer));
+	}
 
-	s_assetDictionaries.at("texture").emplace(asset_key, std::make_shared<Texture>(asset_path, asset_key));
+	// the scene releases the staging memory once the copy is submitted
+	staged_chunks.clear();
 }
 
-void hephics::asset::Manager::RegistTexture(const std::string& asset_key, const cv::Mat& cv_mat)
+void hephics::asset::Asset3D::CopyVertexBuffer()
 {
-	if (!s_assetDictionaries.contains("texture"))
-		s_assetDictionaries["texture"] = {};
+	if (m_isVertexBufferCopied)
+		return;
+	m_isVertexBufferCopied = true;
 
-	if (s_assetDictionaries.at("texture").contains(asset_key))
+	if (!m_stagedVertexChunks.empty())
+	{
+		CopyStagedChunks(m_stagedVertexChunks, m_ptrVertexBuffer);
 		return;
+	}
+
+	const auto& gpu_instance = GPUHandler::GetInstance();
+
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	const auto& command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
+
+	const auto& buffer_size = m_ptrVertexBuffer->GetSize();
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, buffer_size);
+	auto staging_map_address = staging_buffer->Mapping(logical_device);
+	EncodeVertices(GetVertices(), static_cast<std::byte*>(staging_map_address));
+	staging_buffer->Unmapping(logical_device);
+
+	command_buffer->CopyBuffer(staging_buffer, m_ptrVertexBuffer, buffer_size);
 
-	RegistCvMat(asset_key, cv_mat);
-	s_assetDictionaries.at("texture").emplace(asset_key, std::make_shared<Texture>(std::make_shared<cv::Mat>(cv_mat)));
+	auto& staging_buffers = Scene::GetStagingBuffers();
+	staging_buffers.emplace_back(std::move(staging_buffer));
 }
 
-void hephics::asset::Manager::RegistTexture3D(const Texture3D& texture_3d, const std::string& asset_key)
+void hephics::asset::Asset3D::CopyIndexBuffer()
 {
-	if (!s_assetDictionaries.contains("texture_3d"))
-		s_assetDictionaries["texture_3d"] = {};
+	if (m_isIndexBufferCopied)
+		return;
+	m_isIndexBufferCopied = true;
 
-	if (s_assetDictionaries.at("texture_3d").contains(asset_key))
+	if (!m_stagedIndexChunks.empty())
+	{
+		CopyStagedChunks(m_stagedIndexChunks, m_ptrIndexBuffer);
 		return;
+	}
+
+	const auto& gpu_instance = GPUHandler::GetInstance();
+
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	const auto& command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
+
+	const auto& buffer_size = m_ptrIndexBuffer->GetSize();
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, buffer_size);
+	auto staging_map_address = staging_buffer->Mapping(logical_device);
+	EncodeIndices(GetIndices(), static_cast<std::byte*>(staging_map_address));
+	staging_buffer->Unmapping(logical_device);
+
+	command_buffer->CopyBuffer(staging_buffer, m_ptrIndexBuffer, buffer_size);
 
-	s_assetDictionaries.at("texture_3d").emplace(asset_key, std::make_shared<Texture3D>(texture_3d));
+	auto& staging_buffers = Scene::GetStagingBuffers();
+	staging_buffers.emplace_back(std::move(staging_buffer));
 }
 
-const std::shared_ptr<cv::Mat>& hephics::asset::Manager::GetCvMat(const std::string& asset_key)
+bool hephics::asset::Asset3D::TrimCpuCopy(const CpuResidency& cpu_residency, std::vector<std::byte>& compressed_copy)
 {
-	if (!s_assetDictionaries.contains("cv_mat"))
-		throw std::runtime_error("cv_mat: not found");
+	if (!m_isVertexBufferCopied || !m_isIndexBufferCopied)
+		return false;
 
-	const auto& asset_dictionary = s_assetDictionaries.at("cv_mat");
-	if (!asset_dictionary.contains(asset_key))
-		throw std::runtime_error("cv_mat: not found");
+	if (cpu_residency == CpuResidency::compressed)
+	{
+		if (!hephics_helper::PackArchive::IsCompressionSupported(hephics_helper::PackArchive::Compression::lz4))
+			return true;
+
+		// the counts stay uncompressed in front, vertices and indices follow as one run of blocks
+		const auto vertices = GetVertices();
+		const auto indices = GetIndices();
+		const std::array<uint64_t, 2> element_counts{ vertices.size(), indices.size() };
+
+		std::vector<std::byte> mesh_bytes(vertices.size_bytes() + indices.size_bytes());
+		std::memcpy(mesh_bytes.data(), vertices.data(), vertices.size_bytes());
+		std::memcpy(mesh_bytes.data() + vertices.size_bytes(), indices.data(), indices.size_bytes());
+		const auto compressed_bytes = hephics_helper::PackArchive::CompressBytes(mesh_bytes);
+
+		compressed_copy.resize(sizeof(element_counts) + compressed_bytes.size());
+		std::memcpy(compressed_copy.data(), element_counts.data(), sizeof(element_counts));
+		std::memcpy(compressed_copy.data() + sizeof(element_counts), compressed_bytes.data(), compressed_bytes.size());
+	}
 
-	return std::get<std::shared_ptr<cv::Mat>>(asset_dictionary.at(asset_key));
+	m_vertices = {};
+	m_indices = {};
+	m_ptrMeshCache.reset();
+	return true;
 }
 
-const std::shared_ptr<hephics::asset::Texture>&
-hephics::asset::Manager::GetTexture(const std::string& asset_key)
+void hephics::asset::Asset3D::RestoreCpuCopy(const std::vector<std::byte>& compressed_copy)
 {
-	if (!s_assetDictionaries.contains("texture"))
-		throw std::runtime_error("texture: not found");
+	// kept as it was when built without lz4
+	if (compressed_copy.empty())
+		return;
 
-	const auto& asset_dictionary = s_assetDictionaries.at("texture");
-	if (!asset_dictionary.contains(asset_key))
-		throw std::runtime_error("texture: not found");
+	std::array<uint64_t, 2> element_counts{};
+	if (compressed_copy.size() < sizeof(element_counts))
+		throw std::runtime_error("asset_3d: broken compressed copy");
+	std::memcpy(element_counts.data(), compressed_copy.data(), sizeof(element_counts));
+
+	const auto& [vertex_num, index_num] = element_counts;
+	std::vector<std::byte> mesh_bytes(sizeof(VertexData) * vertex_num + sizeof(uint32_t) * index_num);
+	hephics_helper::PackArchive::DecompressBytes(std::span(compressed_copy).subspan(sizeof(element_counts)), mesh_bytes);
 
-	return std::get<std::shared_ptr<Texture>>(asset_dictionary.at(asset_key));
+	m_vertices.resize(vertex_num);
+	m_indices.resize(index_num);
+	std::memcpy(m_vertices.data(), mesh_bytes.data(), sizeof(VertexData) * vertex_num);
+	std::memcpy(m_indices.data(), mesh_bytes.data() + sizeof(VertexData) * vertex_num, sizeof(uint32_t) * index_num);
 }
 
-const std::shared_ptr<hephics::asset::Texture3D>& hephics::asset::Manager::GetTexture3D(const std::string& asset_key)
+std::vector<hephics::asset::MaterialRange> hephics::asset::Asset3D::GetLevelMaterialRanges(const LodLevel& lod_level) const
 {
-	if (!s_assetDictionaries.contains("texture_3d"))
-		throw std::runtime_error("texture_3d: not found");
-
-	const auto& asset_dictionary = s_assetDictionaries.at("texture_3d");
-	if (!asset_dictionary.contains(asset_key))
-		throw std::runtime_error("texture_3d: not found");
+	std::vector<MaterialRange> level_material_ranges;
+	for (const auto& material_range : m_materialRanges)
+	{
+		if (material_range.first_index >= lod_level.first_index
+			&& material_range.first_index < lod_level.first_index + lod_level.index_count)
+			level_material_ranges.emplace_back(material_range);
+	}
 
-	return std::get<std::shared_ptr<Texture3D>>(asset_dictionary.at(asset_key));
+	if (level_material_ranges.empty())
+		level_material_ranges.emplace_back(MaterialRange{ lod_level.first_index, lod_level.index_count, -1 });
+	return level_material_ranges;
 }
 
-const std::shared_ptr<hephics::asset::Object3D>&
-hephics::asset::Manager::GetObject3D(const std::string& asset_key)
+void hephics::asset::Asset3D::OptimizeMesh()
 {
-	if (!s_assetDictionaries.contains("object_3d"))
-		throw std::runtime_error("object_3d: not found");
+	mesh_optimizer::Report report{};
+	if (m_materialRanges.size() <= 1U)
+		report = mesh_optimizer::optimize(m_vertices, m_indices);
+	else
+	{
+		// triangles are only reordered inside their material, the vertex fetch order is shared by all of them
+		report.acmr_before = mesh_optimizer::compute_acmr(m_indices, m_vertices.size());
 
-	const auto& asset_dictionary = s_assetDictionaries.at("object_3d");
-	if (!asset_dictionary.contains(asset_key))
-		throw std::runtime_error("object_3d: not found");
+		for (const auto& material_range : m_materialRanges)
+		{
+			const auto material_begin = m_indices.begin() + material_range.first_index;
+			std::vector<uint32_t> material_indices(material_begin, material_begin + material_range.index_count);
+
+			const auto cluster_starts = mesh_optimizer::optimize_vertex_cache(material_indices, m_vertices.size());
+			mesh_optimizer::optimize_overdraw(material_indices, m_vertices, cluster_starts);
+			std::copy(material_indices.begin(), material_indices.end(), material_begin);
+			report.cluster_num += cluster_starts.size();
+		}
+		mesh_optimizer::optimize_vertex_fetch(m_vertices, m_indices);
+
+		report.acmr_after = mesh_optimizer::compute_acmr(m_indices, m_vertices.size());
+	}
 
-	return std::get<std::shared_ptr<Object3D>>(asset_dictionary.at(asset_key));
+#ifdef _DEBUG
+	std::cout << std::format("mesh_optimizer: ACMR {:.3f} -> {:.3f}, {} clusters\n",
+		report.acmr_before, report.acmr_after, report.cluster_num);
+#endif
 }
 
-const std::shared_ptr<hephics::asset::Fbx3D>& hephics::asset::Manager::GetFbx3D(const std::string& asset_key)
+void hephics::asset::Asset3D::BuildMeshlets(const bool& is_optimized)
 {
-	if (!s_assetDictionaries.contains("fbx_3d"))
-		throw std::runtime_error("object_3d: not found");
+	m_meshlets.clear();
 
-	const auto& asset_dictionary = s_assetDictionaries.at("fbx_3d");
-	if (!asset_dictionary.contains(asset_key))
-		throw std::runtime_error("object_3d: not found");
+	// a meshlet never mixes materials
+	const auto full_mesh = LodLevel{ 0U, static_cast<uint32_t>(m_indices.size()), 0.0f };
+	for (const auto& material_range : GetLevelMaterialRanges(full_mesh))
+	{
+		const auto material_begin = m_indices.begin() + material_range.first_index;
+		std::vector<uint32_t> material_indices(material_begin, material_begin + material_range.index_count);
+
+		for (auto& meshlet : mesh_optimizer::build_meshlets(material_indices, m_vertices))
+		{
+			meshlet.first_index += material_range.first_index;
+			m_meshlets.emplace_back(meshlet);
+		}
+		std::copy(material_indices.begin(), material_indices.end(), material_begin);
+	}
+
+	// meshlets hold no vertex ids, so the fetch order can follow their triangle order
+	if (is_optimized)
+		mesh_optimizer::optimize_vertex_fetch(m_vertices, m_indices);
+
+#ifdef _DEBUG
+	std::cout << std::format("meshlets: {} for {} triangles\n", m_meshlets.size(), m_indices.size() / 3U);
+#endif
+}
+
+void hephics::asset::Asset3D::GenerateLods(const uint32_t& lod_num, const bool& is_optimized)
+{
+	// a level must stay within this share of the bounding box diagonal and drop a tenth of its triangles
+	constexpr float_t MAX_RELATIVE_ERROR = 0.05f;
+
+	m_lodLevels.clear();
+	m_lodLevels.emplace_back(LodLevel{ 0U, static_cast<uint32_t>(m_indices.size()), 0.0f });
+
+	const auto max_error = glm::length(m_bounds.max - m_bounds.min) * MAX_RELATIVE_ERROR;
+	const auto is_material_split = !m_materialRanges.empty();
+
+	// every material is simplified on its own, so no triangle changes its material; a level keeps the
+	// material order of the full mesh and drops a material once it has no triangles left
+	std::vector<std::pair<int32_t, std::vector<uint32_t>>> lod_materials;
+	for (const auto& material_range : GetLevelMaterialRanges(m_lodLevels.front()))
+	{
+		const auto material_begin = m_indices.begin() + material_range.first_index;
+		lod_materials.emplace_back(material_range.material_id,
+			std::vector<uint32_t>(material_begin, material_begin + material_range.index_count));
+	}
+
+	// every level simplifies the previous one, so the errors add up
+	for (uint32_t lod_idx = 1U; lod_idx < lod_num; lod_idx++)
+	{
+		float_t lod_error = 0.0f;
+		size_t lod_index_num = 0U;
+		size_t simplified_index_num = 0U;
+		std::vector<std::pair<int32_t, std::vector<uint32_t>>> simplified_materials;
+		for (const auto& [material_id, lod_indices] : lod_materials)
+		{
+			float_t material_error = 0.0f;
+			auto simplified_indices = mesh_optimizer::simplify(lod_indices, m_vertices,
+				lod_indices.size() / 6U * 3U, max_error, material_error);
+
+			lod_index_num += lod_indices.size();
+			simplified_index_num += simplified_indices.size();
+			lod_error = std::max(lod_error, material_error);
+			if (!simplified_indices.empty())
+				simplified_materials.emplace_back(material_id, std::move(simplified_indices));
+		}
+		if (simplified_index_num == 0U || simplified_index_num * 10U > lod_index_num * 9U)
+			break;
+
+		m_lodLevels.emplace_back(LodLevel{ static_cast<uint32_t>(m_indices.size()),
+			static_cast<uint32_t>(simplified_index_num), m_lodLevels.back().error + lod_error });
+		for (auto& [material_id, simplified_indices] : simplified_materials)
+		{
+			if (is_optimized)
+				mesh_optimizer::optimize_vertex_cache(simplified_indices, m_vertices.size());
+
+			if (is_material_split)
+			{
+				m_materialRanges.emplace_back(MaterialRange{ static_cast<uint32_t>(m_indices.size()),
+					static_cast<uint32_t>(simplified_indices.size()), material_id });
+			}
+			m_indices.insert(m_indices.end(), simplified_indices.begin(), simplified_indices.end());
+		}
+		lod_materials = std::move(simplified_materials);
+
+#ifdef _DEBUG
+		std::cout << std::format("lod {}: {} triangles, error {:.5f}\n",
+			lod_idx, m_lodLevels.back().index_count / 3U, m_lodLevels.back().error);
+#endif
+	}
+}
+
+uint32_t hephics::asset::Asset3D::SelectLod(const glm::mat4& model_view, const glm::mat4& projection,
+	const float_t& viewport_height, const float_t& pixel_error) const
+{
+	const auto scale = std::max({ glm::length(glm::vec3(model_view[0])),
+		glm::length(glm::vec3(model_view[1])), glm::length(glm::vec3(model_view[2])) });
+	const auto center = glm::vec3(model_view * glm::vec4(m_bounds.GetCenter(), 1.0f));
+	const auto radius = glm::length(m_bounds.GetExtent()) * scale;
+
+	// pixels per model unit at the nearest point of the bounding sphere
+	const auto distance = std::max(glm::length(center) - radius, std::numeric_limits<float_t>::epsilon());
+	const auto pixel_scale = std::abs(projection[1][1]) * 0.5f * viewport_height * scale / distance;
+
+	uint32_t lod_idx = 0U;
+	while (lod_idx + 1U < m_lodLevels.size() && m_lodLevels.at(lod_idx + 1U).error * pixel_scale <= pixel_error)
+		lod_idx++;
+
+	return lod_idx;
+}
+
+std::array<glm::vec4, 6> hephics::asset::Asset3D::GetFrustumPlanes(const glm::mat4& model_view_projection)
+{
+	// Gribb and Hartmann, rows of the matrix with the 0..1 depth range of Vulkan
+	const auto rows = glm::transpose(model_view_projection);
+	std::array<glm::vec4, 6> planes =
+	{
+		rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2]
+	};
+
+	for (auto& plane : planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	return planes;
+}
+
+void hephics::asset::Asset3D::CullMeshlets(const glm::mat4& model_view, const glm::mat4& projection,
+	std::vector<DrawRange>& visible_ranges) const
+{
+	visible_ranges.clear();
+
+	// meshlets and the material ranges of the full mesh are both in index order
+	auto material_it = m_materialRanges.begin();
+
+	// both tests run in model space
+	const auto planes = GetFrustumPlanes(projection * model_view);
+	const auto camera_position = glm::vec3(glm::inverse(model_view)[3]);
+
+	for (const auto& meshlet : m_meshlets)
+	{
+		const auto is_outside = std::any_of(planes.begin(), planes.end(),
+			[&meshlet](const glm::vec4& plane) { return glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius; });
+		if (is_outside)
+			continue;
+
+		const auto view_direction = meshlet.center - camera_position;
+		if (glm::dot(view_direction, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(view_direction) + meshlet.radius)
+			continue;
+
+		while (material_it != m_materialRanges.end()
+			&& material_it->first_index + material_it->index_count <= meshlet.first_index)
+			material_it++;
+		const auto material_id = material_it != m_materialRanges.end() ? material_it->material_id : -1;
+
+		if (!visible_ranges.empty() && visible_ranges.back().vertex_offset == meshlet.vertex_offset
+			&& visible_ranges.back().material_id == material_id
+			&& visible_ranges.back().first_index + visible_ranges.back().index_count == meshlet.first_index)
+			visible_ranges.back().index_count += meshlet.index_count;
+		else
+			visible_ranges.emplace_back(DrawRange{ meshlet.first_index, meshlet.index_count, meshlet.vertex_offset, material_id });
+	}
+}
+
+hephics::asset::Texture3D::Texture3D(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+
+	m_vertices = vertices;
+	m_indices = indices;
+	for (const auto& vertex : m_vertices)
+		m_bounds.Expand(vertex.pos);
+
+	PrepareIndices(false);
+
+	const auto vertex_size = sizeof(VertexData) * m_vertices.size();
+	const auto index_size = GetIndexSize() * m_indices.size();
+
+	m_ptrVertexBuffer =
+		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, vertex_size, vk::BufferUsageFlagBits::eVertexBuffer);
+	m_ptrIndexBuffer =
+		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, index_size, vk::BufferUsageFlagBits::eIndexBuffer);
+}
+
+hephics::asset::Object3D::Object3D(const std::string& path, const ModelLoadSettings& load_settings)
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+
+	// a cooked mesh of a mounted pack comes before the loose cache
+	const auto cache_flags = MeshCache::GetFlags(load_settings);
+	if (load_settings.use_mesh_cache)
+		m_ptrMeshCache = MeshCache::LoadPacked(path, cache_flags);
+	if (load_settings.use_mesh_cache && !m_ptrMeshCache)
+		m_ptrMeshCache = MeshCache::Load(path, cache_flags);
+
+	if (m_ptrMeshCache)
+	{
+		m_bounds = m_ptrMeshCache->GetBounds();
+		const auto lod_levels = m_ptrMeshCache->GetLodLevels();
+		m_lodLevels.assign(lod_levels.begin(), lod_levels.end());
+		const auto meshlets = m_ptrMeshCache->GetMeshlets();
+		m_meshlets.assign(meshlets.begin(), meshlets.end());
+		const auto material_ranges = m_ptrMeshCache->GetMaterialRanges();
+		m_materialRanges.assign(material_ranges.begin(), material_ranges.end());
+		m_materialLibrary = m_ptrMeshCache->GetMaterialLibrary();
+		LoadMaterials(path, m_materialLibrary);
+	}
+	else if (load_settings.is_streaming)
+	{
+		LoadObjStreaming(path, load_settings);
+		return;
+	}
+	else
+	{
+		LoadProcessed(path, load_settings);
+		if (load_settings.use_mesh_cache)
+		{
+			MeshCache::Write(path, m_vertices, m_indices, m_lodLevels, m_meshlets, m_materialRanges, m_materialLibrary,
+				m_bounds, cache_flags);
+		}
+	}
+
+	RegistMaterialTextures(path);
+	PrepareIndices(load_settings.is_index_split);
+	SetVertexLayout(load_settings.vertex_layout);
+
+	const auto vertex_size = GetVertices().size() * GetVertexStride();
+	const auto index_size = GetIndices().size() * GetIndexSize();
+
+	m_ptrVertexBuffer =
+		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, vertex_size, vk::BufferUsageFlagBits::eVertexBuffer);
+	m_ptrIndexBuffer =
+		std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, index_size, vk::BufferUsageFlagBits::eIndexBuffer);
+}
+
+void hephics::asset::Object3D::LoadProcessed(const std::string& path, const ModelLoadSettings& load_settings)
+{
+	LoadObj(path);
+	if (load_settings.is_optimized)
+		OptimizeMesh();
+	if (load_settings.use_meshlets)
+		BuildMeshlets(load_settings.is_optimized);
+	if (load_settings.lod_num > 1U)
+		GenerateLods(load_settings.lod_num, load_settings.is_optimized);
+}
+
+std::vector<std::byte> hephics::asset::Object3D::Cook(const std::string& path, const ModelLoadSettings& load_settings)
+{
+	Object3D object_3d;
+	object_3d.LoadProcessed(path, load_settings);
+
+	return MeshCache::Encode(path, object_3d.m_vertices, object_3d.m_indices, object_3d.m_lodLevels,
+		object_3d.m_meshlets, object_3d.m_materialRanges, object_3d.m_materialLibrary, object_3d.m_bounds,
+		MeshCache::GetFlags(load_settings));
+}
+
+hephics::asset::Object3D::~Object3D()
+{
+	for (const auto& texture_handle : m_materialTextureHandles)
+		Manager::Release(texture_handle);
+	for (const auto& cv_mat_handle : m_materialCvMatHandles)
+		Manager::Release(cv_mat_handle);
+}
+
+void hephics::asset::Object3D::LoadObj(const std::string& path)
+{
+	const auto parse_result = obj_parser::parse(path);
+	m_materialLibrary = parse_result.material_library;
+	const auto material_map = LoadMaterials(path, m_materialLibrary);
+
+	// "usemtl" names to materials of the library, a name it does not define is drawn without material
+	const auto triangle_num = parse_result.indices.size() / 3U;
+	std::vector<int32_t> triangle_material_ids(triangle_num, -1);
+	for (size_t triangle_idx = 0U; triangle_idx < triangle_num; triangle_idx++)
+	{
+		const auto& name_idx = parse_result.material_ids.at(triangle_idx);
+		if (name_idx < 0)
+			continue;
+
+		const auto material_it = material_map.find(parse_result.material_names.at(name_idx));
+		if (material_it != material_map.end())
+			triangle_material_ids.at(triangle_idx) = material_it->second;
+	}
+
+	// the triangles of one material become contiguous and keep their file order
+	std::vector<uint32_t> triangle_order(triangle_num);
+	std::iota(triangle_order.begin(), triangle_order.end(), 0U);
+	std::stable_sort(triangle_order.begin(), triangle_order.end(),
+		[&triangle_material_ids](const uint32_t& lhs, const uint32_t& rhs)
+		{
+			return triangle_material_ids[lhs] < triangle_material_ids[rhs];
+		});
+
+	m_materialRanges.clear();
+	for (size_t triangle_idx = 0U; triangle_idx < triangle_num; triangle_idx++)
+	{
+		const auto& material_id = triangle_material_ids.at(triangle_order.at(triangle_idx));
+		if (m_materialRanges.empty() || m_materialRanges.back().material_id != material_id)
+			m_materialRanges.emplace_back(MaterialRange{ static_cast<uint32_t>(3U * triangle_idx), 0U, material_id });
+		m_materialRanges.back().index_count += 3U;
+	}
+
+	const auto make_vertex = [&parse_result, &triangle_order](const size_t& corner_idx)
+		{
+			const auto& index = parse_result.indices[3U * triangle_order[corner_idx / 3U] + corner_idx % 3U];
+			VertexData vertex{};
+
+			vertex.pos =
+			{
+				parse_result.positions[3 * index.vertex_index + 0],
+				parse_result.positions[3 * index.vertex_index + 1],
+				parse_result.positions[3 * index.vertex_index + 2]
+			};
+
+			if (index.texcoord_index >= 0)
+			{
+				vertex.tex_coord =
+				{
+					parse_result.texcoords[2 * index.texcoord_index + 0],
+					1.0f - parse_result.texcoords[2 * index.texcoord_index + 1]
+				};
+			}
+
+			// material colors are given per draw range, not per vertex
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+
+			return vertex;
+		};
+
+	hephics_helper::VertexDeduplicator<VertexData>::Deduplicate(
+		parse_result.indices.size(), make_vertex, m_vertices, m_indices);
+
+	for (const auto& vertex : m_vertices)
+		m_bounds.Expand(vertex.pos);
+}
+
+void hephics::asset::Object3D::LoadObjStreaming(const std::string& path, const ModelLoadSettings& load_settings)
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+
+	// the vertex color is constant, so a vertex is identified by its position and texcoord indices; the second
+	// pass gets the ids of the first, and a vertex is new where its id is the next one
+	hephics_helper::VertexDeduplicator<uint64_t> vertex_keys;
+	std::vector<VertexData> window_vertices;
+	std::vector<uint32_t> window_indices;
+	size_t vertex_num = 0U;
+	size_t index_num = 0U;
+	BoundingBox tex_coord_bounds;
+	std::string material_library;
+
+	const auto make_vertex = [](const obj_parser::ParseResult& window, const obj_parser::Index& index)
+		{
+			VertexData vertex{};
+
+			vertex.pos =
+			{
+				window.positions.at(3 * index.vertex_index + 0),
+				window.positions.at(3 * index.vertex_index + 1),
+				window.positions.at(3 * index.vertex_index + 2)
+			};
+
+			if (index.texcoord_index >= 0)
+			{
+				vertex.tex_coord =
+				{
+					window.texcoords.at(2 * index.texcoord_index + 0),
+					1.0f - window.texcoords.at(2 * index.texcoord_index + 1)
+				};
+			}
+
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+			return vertex;
+		};
+
+	// adds the window's new vertices to "window_vertices" and its indices to "window_indices"
+	const auto gather_window = [&](const obj_parser::ParseResult& window, const size_t& window_vertex_offset)
+		{
+			window_vertices.clear();
+			window_indices.clear();
+			vertex_keys.Reserve(vertex_keys.GetVertices().size() + window.indices.size());
+
+			for (const auto& index : window.indices)
+			{
+				const auto vertex_key = (static_cast<uint64_t>(static_cast<uint32_t>(index.vertex_index)) << 32)
+					| static_cast<uint32_t>(index.texcoord_index);
+				const auto vertex_id = vertex_keys.Insert(vertex_key);
+
+				if (vertex_id == window_vertex_offset + window_vertices.size())
+					window_vertices.emplace_back(make_vertex(window, index));
+				window_indices.emplace_back(vertex_id);
+			}
+		};
+
+	// the first pass only counts and bounds: the layout, the index width and the buffer sizes are known before
+	// anything is uploaded
+	obj_parser::parse_streaming(path, load_settings.window_size, [&](const obj_parser::ParseResult& window)
+		{
+			gather_window(window, vertex_num);
+			for (const auto& vertex : window_vertices)
+			{
+				m_bounds.Expand(vertex.pos);
+				tex_coord_bounds.Expand(glm::vec3(vertex.tex_coord, 0.0f));
+			}
+
+			vertex_num += window_vertices.size();
+			index_num += window_indices.size();
+			material_library = window.material_library;
+		});
+
+	LoadMaterials(path, material_library);
+
+	SetVertexLayout(load_settings.vertex_layout, tex_coord_bounds);
+	m_indexType = vertex_num <= MAX_UINT16_VERTEX_NUM ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+	m_lodLevels.emplace_back(LodLevel{ 0U, static_cast<uint32_t>(index_num), 0.0f });
+	m_drawRanges.emplace_back(DrawRange{ 0U, static_cast<uint32_t>(index_num), 0 });
+	m_lodDrawRangeStarts = { 0U, 1U };
+
+	const auto vertex_stride = GetVertexStride();
+	const auto index_size = GetIndexSize();
+	m_ptrVertexBuffer = std::make_shared<hephics_helper::GPUBuffer>(gpu_instance,
+		vertex_stride * vertex_num, vk::BufferUsageFlagBits::eVertexBuffer);
+	m_ptrIndexBuffer = std::make_shared<hephics_helper::GPUBuffer>(gpu_instance,
+		index_size * index_num, vk::BufferUsageFlagBits::eIndexBuffer);
+
+	// every window is encoded into staging memory of its own size, copied and waited for before the next one,
+	// so no more than one window is staged at a time
+	size_t uploaded_vertex_num = 0U;
+	size_t uploaded_index_num = 0U;
+	obj_parser::parse_streaming(path, load_settings.window_size, [&](const obj_parser::ParseResult& window)
+		{
+			gather_window(window, uploaded_vertex_num);
+
+			const auto vertex_size = vertex_stride * window_vertices.size();
+			const auto indices_size = index_size * window_indices.size();
+			if (vertex_size + indices_size == 0U)
+				return;
+
+			auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, vertex_size + indices_size);
+			auto staging_map_address = static_cast<std::byte*>(staging_buffer->Mapping(logical_device));
+			EncodeVertices(window_vertices, staging_map_address);
+			EncodeIndices(window_indices, staging_map_address + vertex_size);
+			staging_buffer->Unmapping(logical_device);
+
+			gpu_instance->SubmitOneTimeCommands(
+				[&](const std::shared_ptr<vk_interface::component::CommandBuffer>& command_buffer)
+				{
+					if (vertex_size != 0U)
+						command_buffer->CopyBuffer(staging_buffer, m_ptrVertexBuffer,
+							vertex_size, 0U, vertex_stride * uploaded_vertex_num);
+					if (indices_size != 0U)
+						command_buffer->CopyBuffer(staging_buffer, m_ptrIndexBuffer,
+							indices_size, vertex_size, index_size * uploaded_index_num);
+
+					// later submissions draw from the buffers
+					vk::MemoryBarrier memory_barrier(vk::AccessFlagBits::eTransferWrite,
+						vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead);
+					command_buffer->GetCommandBuffer()->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+						vk::PipelineStageFlagBits::eVertexInput, {}, memory_barrier, nullptr, nullptr);
+				});
+
+			uploaded_vertex_num += window_vertices.size();
+			uploaded_index_num += window_indices.size();
+		});
+
+	if (uploaded_vertex_num != vertex_num || uploaded_index_num != index_num)
+		throw std::runtime_error("obj: " + path + " changed while it was streamed");
+
+	// nothing is left for the scene's copy submission
+	m_isVertexBufferCopied = true;
+	m_isIndexBufferCopied = true;
+}
+
+std::map<std::string, int32_t> hephics::asset::Object3D::LoadMaterials(const std::string& path,
+	const std::string& material_library)
+{
+	std::map<std::string, int32_t> material_map;
+	if (material_library.empty())
+		return material_map;
+
+	// a missing material library is not fatal, the mesh is drawn with the actor's textures
+	std::ifstream ifs(std::filesystem::path(path).parent_path() / material_library);
+	if (!ifs.is_open())
+		return material_map;
+
+	std::string warn, err;
+	tinyobj::LoadMtl(&material_map, &m_materials, &ifs, &warn, &err);
+
+#ifdef _DEBUG
+	if (!err.empty())
+		std::cerr << std::format("obj: {}\n", err);
+#endif
+
+	return material_map;
+}
+
+void hephics::asset::Object3D::RegistMaterialTextures(const std::string& path)
+{
+	// texture names are relative to the model, the manager loads images below assets/img;
+	// materials sharing a texture file, or its content, share one texture
+	const auto model_directory = std::filesystem::path(path).parent_path();
+	for (const auto& material : m_materials)
+	{
+		const auto texture_path = (model_directory / material.diffuse_texname).lexically_normal();
+		const auto is_texture_found = !material.diffuse_texname.empty() && (std::filesystem::exists(texture_path)
+			|| hephics_helper::PackArchive::FindMountedContentHash(hephics_helper::PackArchive::GetEntryName(texture_path)));
+		if (!is_texture_found)
+		{
+			// one 1x1 white texture for every material without a diffuse map, its color then shows as it is
+			static const cv::Mat white_image(1, 1, CV_8UC4, cv::Scalar(255, 255, 255, 255));
+			m_materialTextureHandles.emplace_back(Manager::RegistTexture("material_white", white_image));
+			m_materialCvMatHandles.emplace_back(Manager::FindHandle<cv::Mat>("material_white"));
+			continue;
+		}
+
+		const auto asset_path = texture_path.lexically_relative("assets/img").generic_string();
+		m_materialTextureHandles.emplace_back(Manager::RegistTexture(asset_path, asset_path));
+		m_materialCvMatHandles.emplace_back(Manager::FindHandle<cv::Mat>(asset_path));
+	}
+}
+
+void hephics::asset::Object3D::CopyMaterialTextures()
+{
+	for (size_t material_idx = 0U; material_idx < m_materialTextureHandles.size(); material_idx++)
+	{
+		const auto& texture_handle = m_materialTextureHandles.at(material_idx);
+		if (!texture_handle.IsValid())
+			continue;
+
+		// the image is only resolved for an upload, a texture copied for an earlier scene may have none left
+		const auto& texture = Manager::GetTexture(texture_handle);
+		if (texture->IsCooked())
+			texture->CopyTexture();
+		else if (!texture->IsTextureCopied())
+			texture->CopyTexture(Manager::GetCvMat(m_materialCvMatHandles.at(material_idx)));
+	}
+}
+
+hephics::asset::Gltf3D::Gltf3D(const std::string& path, const ModelLoadSettings& load_settings)
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+
+	const auto parse_result = gltf_parser::parse(path);
+	const auto& primitives = parse_result.primitives;
+
+	std::vector<int32_t> vertex_offsets(primitives.size(), 0);
+	size_t vertex_num = 0U;
+	size_t index_num = 0U;
+	BoundingBox tex_coord_bounds;
+	bool is_uint16_indexable = true;
+
+	for (size_t primitive_idx = 0U; primitive_idx < primitives.size(); primitive_idx++)
+	{
+		const auto& primitive = primitives[primitive_idx];
+
+		// primitives reading the same vertex streams share one copy of the vertices
+		const auto primitives_end = primitives.begin() + primitive_idx;
+		const auto shared_primitive = std::find_if(primitives.begin(), primitives_end, [&primitive](const auto& other)
+			{
+				return other.position == primitive.position && other.tex_coord == primitive.tex_coord
+					&& other.color == primitive.color;
+			});
+
+		if (shared_primitive != primitives_end)
+		{
+			vertex_offsets[primitive_idx] = vertex_offsets[shared_primitive - primitives.begin()];
+		}
+		else
+		{
+			vertex_offsets[primitive_idx] = static_cast<int32_t>(vertex_num);
+			vertex_num += primitive.position.count;
+
+			m_bounds.Expand(primitive.bounds.min);
+			m_bounds.Expand(primitive.bounds.max);
+
+			if (primitive.tex_coord)
+			{
+				for (size_t vertex_idx = 0U; vertex_idx < primitive.tex_coord->count; vertex_idx++)
+				{
+					tex_coord_bounds.Expand({ primitive.tex_coord->ReadFloat(vertex_idx, 0U),
+						primitive.tex_coord->ReadFloat(vertex_idx, 1U), 0.0f });
+				}
+			}
+			else
+			{
+				tex_coord_bounds.Expand(glm::vec3(0.0f));
+			}
+		}
+
+		const auto primitive_index_num = primitive.indices ? primitive.indices->count : primitive.position.count;
+		m_drawRanges.emplace_back(DrawRange{ static_cast<uint32_t>(index_num),
+			static_cast<uint32_t>(primitive_index_num), vertex_offsets[primitive_idx] });
+		index_num += primitive_index_num;
+
+		// indices are local to their primitive, the draw range adds its vertex offset
+		is_uint16_indexable = is_uint16_indexable && primitive.position.count <= MAX_UINT16_VERTEX_NUM;
+	}
+
+	if (vertex_num == 0U || index_num == 0U)
+		throw std::runtime_error("gltf_3d: no triangles in " + path);
+	if (vertex_num > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+		throw std::runtime_error("gltf_3d: too many vertices in " + path);
+
+	SetVertexLayout(load_settings.vertex_layout, tex_coord_bounds);
+	m_indexType = is_uint16_indexable ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+	m_lodLevels.emplace_back(LodLevel{ 0U, static_cast<uint32_t>(index_num), 0.0f });
+	m_lodDrawRangeStarts = { 0U, m_drawRanges.size() };
+
+	StageVertices(parse_result, vertex_offsets, vertex_num);
+	StageIndices(parse_result, index_num);
+
+	m_ptrVertexBuffer = std::make_shared<hephics_helper::GPUBuffer>(gpu_instance,
+		GetVertexStride() * vertex_num, vk::BufferUsageFlagBits::eVertexBuffer);
+	m_ptrIndexBuffer = std::make_shared<hephics_helper::GPUBuffer>(gpu_instance,
+		GetIndexSize() * index_num, vk::BufferUsageFlagBits::eIndexBuffer);
+
+#ifdef _DEBUG
+	std::cout << std::format("gltf_3d: {} primitives, {} vertices, {} indices\n",
+		primitives.size(), vertex_num, index_num);
+#endif
+}
+
+void hephics::asset::Gltf3D::StageVertices(const gltf_parser::ParseResult& parse_result,
+	const std::vector<int32_t>& vertex_offsets, const size_t& vertex_num)
+{
+	constexpr size_t VERTEX_BLOCK_SIZE = 1024U;
+
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	const auto& primitives = parse_result.primitives;
+	const auto vertex_stride = GetVertexStride();
+
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, vertex_stride * vertex_num);
+	auto ptr_dst = static_cast<std::byte*>(staging_buffer->Mapping(logical_device));
+
+	// the streams are gathered a block at a time and encoded straight into the staging memory
+	std::vector<VertexData> vertex_block(VERTEX_BLOCK_SIZE);
+
+	for (size_t primitive_idx = 0U; primitive_idx < primitives.size(); primitive_idx++)
+	{
+		const auto& primitive = primitives[primitive_idx];
+		const auto& vertex_offset = vertex_offsets[primitive_idx];
+
+		const auto vertex_offsets_end = vertex_offsets.begin() + primitive_idx;
+		if (std::find(vertex_offsets.begin(), vertex_offsets_end, vertex_offset) != vertex_offsets_end)
+			continue;
+
+		for (size_t block_begin = 0U; block_begin < primitive.position.count; block_begin += VERTEX_BLOCK_SIZE)
+		{
+			const auto block_size = std::min(VERTEX_BLOCK_SIZE, primitive.position.count - block_begin);
+
+			for (size_t block_idx = 0U; block_idx < block_size; block_idx++)
+			{
+				const auto vertex_idx = block_begin + block_idx;
+				auto& vertex = vertex_block[block_idx];
+
+				vertex.pos =
+				{
+					primitive.position.ReadFloat(vertex_idx, 0U),
+					primitive.position.ReadFloat(vertex_idx, 1U),
+					primitive.position.ReadFloat(vertex_idx, 2U)
+				};
+
+				// glTF texcoords already start at the top left, as Vulkan samples them
+				vertex.tex_coord = primitive.tex_coord
+					? glm::vec2(primitive.tex_coord->ReadFloat(vertex_idx, 0U), primitive.tex_coord->ReadFloat(vertex_idx, 1U))
+					: glm::vec2(0.0f);
+
+				vertex.color = primitive.color
+					? glm::vec3(primitive.color->ReadFloat(vertex_idx, 0U), primitive.color->ReadFloat(vertex_idx, 1U),
+						primitive.color->ReadFloat(vertex_idx, 2U))
+					: glm::vec3(1.0f);
+			}
+
+			EncodeVertices(std::span<const VertexData>(vertex_block.data(), block_size),
+				ptr_dst + vertex_stride * (vertex_offset + block_begin));
+		}
+	}
+
+	staging_buffer->Unmapping(logical_device);
+	m_stagedVertexChunks.push_back(StagedChunk{ std::move(staging_buffer), 0U, vertex_stride * vertex_num });
+}
+
+void hephics::asset::Gltf3D::StageIndices(const gltf_parser::ParseResult& parse_result, const size_t& index_num)
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	const auto index_size = GetIndexSize();
+
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, index_size * index_num);
+	auto ptr_dst = static_cast<std::byte*>(staging_buffer->Mapping(logical_device));
+
+	for (const auto& primitive : parse_result.primitives)
+	{
+		const auto& indices = primitive.indices;
+		const auto primitive_index_num = indices ? indices->count : primitive.position.count;
+
+		if (indices && indices->GetComponentSize() == index_size && indices->stride == index_size)
+		{
+			// the buffer view already has the width of the index buffer
+			std::memcpy(ptr_dst, indices->ptr_data, index_size * primitive_index_num);
+		}
+		else
+		{
+			for (size_t idx = 0U; idx < primitive_index_num; idx++)
+			{
+				const auto index = indices ? indices->ReadIndex(idx) : static_cast<uint32_t>(idx);
+				if (m_indexType == vk::IndexType::eUint16)
+				{
+					const auto narrow_index = static_cast<uint16_t>(index);
+					std::memcpy(ptr_dst + sizeof(uint16_t) * idx, &narrow_index, sizeof(uint16_t));
+				}
+				else
+				{
+					std::memcpy(ptr_dst + sizeof(uint32_t) * idx, &index, sizeof(uint32_t));
+				}
+			}
+		}
+
+		ptr_dst += index_size * primitive_index_num;
+	}
+
+	staging_buffer->Unmapping(logical_device);
+	m_stagedIndexChunks.push_back(StagedChunk{ std::move(staging_buffer), 0U, index_size * index_num });
+}
+
+static cv::Mat read_image(const std::string& asset_path)
+{
+	auto img = cv::imread(std::format("assets/img/{}", asset_path));
+	cv::cvtColor(img, img, cv::COLOR_BGR2RGBA);
+	return img;
+}
+
+// decoded pixels, seeded with the shape so equal bytes of another size or type differ
+static uint64_t hash_image(const cv::Mat& cv_mat)
+{
+	const std::array<int64_t, 3> image_shape{ cv_mat.rows, cv_mat.cols, cv_mat.type() };
+	auto content_hash = hephics_helper::hash::compute_xxh64(image_shape.data(), sizeof(image_shape));
+
+	if (cv_mat.isContinuous())
+		return hephics_helper::hash::compute_xxh64(cv_mat.data, cv_mat.total() * cv_mat.elemSize(), content_hash);
+
+	for (int32_t row = 0; row < cv_mat.rows; row++)
+		content_hash = hephics_helper::hash::compute_xxh64(cv_mat.ptr(row), cv_mat.cols * cv_mat.elemSize(), content_hash);
+	return content_hash;
+}
+
+// a loaded mesh only depends on its bytes, its material library and the settings that change the result, so
+// it is hashed before parsing; cooked meshes use the hash stored in the pack since the source may not be shipped
+static uint64_t hash_model(const std::string& path, const hephics::asset::ModelLoadSettings& load_settings)
+{
+	const std::array<uint64_t, 6> settings{ load_settings.is_optimized, static_cast<uint64_t>(load_settings.vertex_layout),
+		load_settings.is_index_split, load_settings.lod_num, load_settings.use_meshlets, load_settings.is_streaming };
+	const auto settings_hash = hephics_helper::hash::compute_xxh64(settings.data(), sizeof(settings));
+
+	std::string material_library;
+	uint64_t content_hash = 0U;
+	const auto packed_hash = hephics_helper::PackArchive::FindMountedContentHash(
+		hephics_helper::PackArchive::GetEntryName(path));
+	if (packed_hash)
+	{
+		content_hash = hephics_helper::hash::compute_xxh64(&packed_hash.value(), sizeof(uint64_t), settings_hash);
+		// the cooker records the library in the table of contents, the entry itself is not decoded
+		material_library = hephics_helper::PackArchive::FindMountedDependency(
+			hephics_helper::PackArchive::GetEntryName(path)).value_or("");
+	}
+	else
+	{
+		hephics_helper::MappedFile source_file(path);
+		content_hash = hephics_helper::hash::compute_xxh64(source_file.GetData(), source_file.GetSize(), settings_hash);
+		if (std::filesystem::path(path).extension() == ".obj" && source_file.GetSize() > 0U)
+			material_library = hephics::asset::obj_parser::find_material_library(std::string_view(
+				reinterpret_cast<const char*>(source_file.GetData()), source_file.GetSize()));
+	}
+
+	// the library holds the material colors and texture names, two meshes are one asset only if it matches too
+	const auto material_library_path = std::filesystem::path(path).parent_path() / material_library;
+	std::error_code error_code;
+	if (material_library.empty() || !std::filesystem::is_regular_file(material_library_path, error_code))
+		return content_hash;
+
+	hephics_helper::MappedFile material_library_file(material_library_path);
+	return hephics_helper::hash::compute_xxh64(material_library_file.GetData(), material_library_file.GetSize(), content_hash);
+}
+
+hephics::asset::AssetHandle<cv::Mat> hephics::asset::Manager::RegistCvMat(const std::string& asset_path,
+	const std::string& asset_key, const AssetScope& scope, const CpuResidency& cpu_residency)
+{
+	// the image has to be decoded to be hashed, a duplicate is dropped right after
+	std::shared_ptr<cv::Mat> ptr_decoded;
+	const auto cv_mat_handle = RegistUnique<cv::Mat>(asset_key, scope,
+		[&asset_path, &ptr_decoded]
+		{
+			ptr_decoded = std::make_shared<cv::Mat>(read_image(asset_path));
+			return hash_image(*ptr_decoded);
+		},
+		[&ptr_decoded] { return std::move(ptr_decoded); }, cpu_residency);
+
+	// a trimmed image kept from now on needs its pixels back
+	if (cpu_residency == CpuResidency::keep)
+		RestoreCvMat(cv_mat_handle, [&asset_path] { return read_image(asset_path); });
+	return cv_mat_handle;
+}
+
+hephics::asset::AssetHandle<cv::Mat> hephics::asset::Manager::RegistCvMat(const std::string& asset_key,
+	const cv::Mat& cv_mat, const AssetScope& scope, const CpuResidency& cpu_residency)
+{
+	const auto cv_mat_handle = RegistUnique<cv::Mat>(asset_key, scope, [&cv_mat] { return hash_image(cv_mat); },
+		[&cv_mat] { return std::make_shared<cv::Mat>(cv_mat); }, cpu_residency);
+
+	if (cpu_residency == CpuResidency::keep)
+		RestoreCvMat(cv_mat_handle, [&cv_mat] { return cv_mat.clone(); });
+	return cv_mat_handle;
+}
+
+hephics::asset::AssetHandle<hephics::asset::Object3D> hephics::asset::Manager::RegistObject3D(const std::string& asset_path,
+	const std::string& asset_key, const ModelLoadSettings& load_settings, const AssetScope& scope)
+{
+	const auto path = std::format("assets/model/{}", asset_path);
+	return RegistUnique<Object3D>(asset_key, scope, [&] { return hash_model(path, load_settings); },
+		[&] { return std::make_shared<Object3D>(path, load_settings); }, load_settings.cpu_residency);
+}
+
+hephics::asset::AssetHandle<hephics::asset::Gltf3D> hephics::asset::Manager::RegistGltf3D(const std::string& asset_path,
+	const std::string& asset_key, const ModelLoadSettings& load_settings, const AssetScope& scope)
+{
+	const auto path = std::format("assets/model/{}", asset_path);
+	return RegistUnique<Gltf3D>(asset_key, scope, [&] { return hash_model(path, load_settings); },
+		[&] { return std::make_shared<Gltf3D>(path, load_settings); }, load_settings.cpu_residency);
+}
+
+hephics::asset::AssetHandle<hephics::asset::Fbx3D> hephics::asset::Manager::RegistFbx3D(const std::string& asset_path,
+	const std::string& asset_key, const AssetScope& scope)
+{
+	return Regist<Fbx3D>(asset_key, scope, [&asset_path]
+		{
+			return std::make_shared<Fbx3D>(std::format("assets/model/{}", asset_path));
+		});
+}
+
+hephics::asset::AssetHandle<hephics::asset::Texture> hephics::asset::Manager::RegistTexture(const std::string& asset_path,
+	const std::string& asset_key, const AssetScope& scope, const CpuResidency& cpu_residency)
+{
+	// a texture resident by name is shared before its image is looked at, so a scene switch decodes nothing;
+	// the image is registered by name too while it is resident, which finds it without decoding
+	auto& texture_pool = GetPool<Texture>();
+	if (const auto texture_handle = texture_pool.Find(asset_key); texture_handle.IsValid())
+	{
+		if (GetPool<cv::Mat>().Find(asset_key).IsValid())
+			RegistCvMat(asset_path, asset_key, scope, cpu_residency);
+
+		texture_pool.Acquire(texture_handle, scope);
+		return texture_handle;
+	}
+
+	const auto entry_name = hephics_helper::PackArchive::GetEntryName(std::format("assets/img/{}", asset_path));
+	if (const auto packed_hash = hephics_helper::PackArchive::FindMountedContentHash(entry_name))
+	{
+		return RegistUnique<Texture>(asset_key, scope, [&packed_hash] { return packed_hash.value(); }, [&entry_name]
+			{
+				return std::make_shared<Texture>(hephics_helper::PackArchive::Load(entry_name).value());
+			});
+	}
+
+	// a texture shares the content hash of its image, whose pixels are restored for a new upload
+	const auto cv_mat_handle = RegistCvMat(asset_path, asset_key, scope, cpu_residency);
+	return RegistUnique<Texture>(asset_key, scope,
+		[&cv_mat_handle] { return GetPool<cv::Mat>().GetContentHash(cv_mat_handle).value(); },
+		[&cv_mat_handle, &asset_path]
+		{
+			RestoreCvMat(cv_mat_handle, [&asset_path] { return read_image(asset_path); });
+			return std::make_shared<Texture>(GetCvMat(cv_mat_handle));
+		});
+}
+
+hephics::asset::AssetHandle<hephics::asset::Texture> hephics::asset::Manager::RegistTexture(const std::string& asset_key,
+	const cv::Mat& cv_mat, const AssetScope& scope, const CpuResidency& cpu_residency)
+{
+	const auto cv_mat_handle = RegistCvMat(asset_key, cv_mat, scope, cpu_residency);
+	return RegistUnique<Texture>(asset_key, scope,
+		[&cv_mat_handle] { return GetPool<cv::Mat>().GetContentHash(cv_mat_handle).value(); },
+		[&cv_mat_handle, &cv_mat]
+		{
+			RestoreCvMat(cv_mat_handle, [&cv_mat] { return cv_mat.clone(); });
+			return std::make_shared<Texture>(GetCvMat(cv_mat_handle));
+		});
+}
+
+hephics::asset::AssetHandle<hephics::asset::TextureAtlas> hephics::asset::Manager::RegistTextureAtlas(
+	const std::vector<std::string>& asset_paths, const std::string& asset_key, const AssetScope& scope)
+{
+	return Regist<TextureAtlas>(asset_key, scope, [&asset_paths, &scope]
+		{
+			std::vector<AssetHandle<cv::Mat>> cv_mat_handles;
+			std::vector<std::pair<std::string, std::shared_ptr<cv::Mat>>> images;
+			for (const auto& asset_path : asset_paths)
+			{
+				cv_mat_handles.push_back(RegistCvMat(asset_path, asset_path, scope, CpuResidency::release));
+				RestoreCvMat(cv_mat_handles.back(), [&asset_path] { return read_image(asset_path); });
+				images.emplace_back(asset_path, GetCvMat(cv_mat_handles.back()));
+			}
+
+			auto ptr_texture_atlas = std::make_shared<TextureAtlas>(images);
+
+			// the layers hold their own copy, the images may be evicted now
+			for (const auto& cv_mat_handle : cv_mat_handles)
+				Release(cv_mat_handle);
+			return ptr_texture_atlas;
+		});
+}
+
+hephics::asset::AssetHandle<hephics::asset::Texture3D> hephics::asset::Manager::RegistTexture3D(const Texture3D& texture_3d,
+	const std::string& asset_key, const AssetScope& scope, const CpuResidency& cpu_residency)
+{
+	return RegistUnique<Texture3D>(asset_key, scope,
+		[&texture_3d]
+		{
+			const auto vertices = texture_3d.GetVertices();
+			const auto indices = texture_3d.GetIndices();
+			const auto vertex_hash = hephics_helper::hash::compute_xxh64(vertices.data(), vertices.size_bytes());
+			return hephics_helper::hash::compute_xxh64(indices.data(), indices.size_bytes(), vertex_hash);
+		},
+		[&texture_3d] { return std::make_shared<Texture3D>(texture_3d); }, cpu_residency);
+}
+
+size_t hephics::asset::Manager::GetResidentSize()
+{
+	return std::apply([](const auto&... asset_pools) { return (asset_pools.GetResidentSize() + ...); }, s_assetPools);
+}
+
+void hephics::asset::Manager::EvictToBudget(const size_t& incoming_size)
+{
+	auto resident_size = GetResidentSize();
+	if (s_memoryBudget == 0U || resident_size + incoming_size <= s_memoryBudget)
+		return;
+
+	std::vector<EvictionCandidate> candidates;
+	std::apply([&candidates](auto&... asset_pools)
+		{
+			(asset_pools.CollectEvictionCandidates(GetSafeFrameIdx(), candidates), ...);
+		}, s_assetPools);
+
+	std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs)
+		{
+			return lhs.last_use_frame < rhs.last_use_frame;
+		});
+
+	for (const auto& candidate : candidates)
+	{
+		if (resident_size + incoming_size <= s_memoryBudget)
+			break;
+
+		candidate.evict();
+		resident_size -= candidate.resident_size;
+	}
+
+#ifdef _DEBUG
+	if (resident_size + incoming_size > s_memoryBudget)
+		std::cout << std::format("asset: {} bytes over the memory budget, every candidate is in use\n",
+			resident_size + incoming_size - s_memoryBudget);
+#endif
+}
+
+void hephics::asset::Manager::Trim(const AssetScope& released_scope)
+{
+	if (!s_isTrimPending && released_scope == AssetScope::transient)
+	{
+		EvictToBudget(0U);
+		return;
+	}
+
+	// assets still in flight are retried on the next call
+	s_isTrimPending = std::apply([&released_scope](auto&... asset_pools)
+		{
+			return (asset_pools.ReleaseUnreferenced(released_scope, GetSafeFrameIdx()) | ...);
+		}, s_assetPools);
+
+	EvictToBudget(0U);
+}
+
+void hephics::asset::Manager::EncodeCpuCopy(cv::Mat& cv_mat, std::vector<std::byte>& cpu_copy)
+{
+	// lossless and fast rather than small, the channel order survives the round trip
+	std::vector<uchar> encoded_image;
+	if (!cv::imencode(".png", cv_mat, encoded_image, { cv::IMWRITE_PNG_COMPRESSION, 1 }))
+		throw std::runtime_error("cv_mat: failed to compress");
+
+	cpu_copy.resize(encoded_image.size());
+	std::memcpy(cpu_copy.data(), encoded_image.data(), encoded_image.size());
+	cv_mat = cv::Mat();
+}
+
+void hephics::asset::Manager::DecodeCpuCopy(cv::Mat& cv_mat, const std::vector<std::byte>& cpu_copy)
+{
+	const cv::Mat encoded_image(1, static_cast<int32_t>(cpu_copy.size()), CV_8UC1, const_cast<std::byte*>(cpu_copy.data()));
+	cv_mat = cv::imdecode(encoded_image, cv::IMREAD_UNCHANGED);
+	if (cv_mat.empty())
+		throw std::runtime_error("cv_mat: broken compressed copy");
+}
+
+void hephics::asset::Manager::TrimCpuCopies()
+{
+	// images are only trimmed behind an uploaded texture, one without it may still be read (atlas packing,
+	// a texture of a later scene); the slot stays so handles held by actors and meshes are not stale
+	GetPool<cv::Mat>().TrimCpuCopies([](cv::Mat& cv_mat, const CpuResidency& cpu_residency,
+		std::vector<std::byte>& cpu_copy, const std::optional<uint64_t>& content_hash) -> std::optional<size_t>
+		{
+			const auto ptr_texture = content_hash
+				? GetPool<Texture>().Peek(GetPool<Texture>().FindContent(content_hash.value())) : nullptr;
+			if (ptr_texture == nullptr || !ptr_texture->IsTextureCopied())
+				return std::nullopt;
+
+			if (cpu_residency == CpuResidency::compressed)
+				EncodeCpuCopy(cv_mat, cpu_copy);
+			else
+				cv_mat = cv::Mat();
+			return 0U;
+		});
+
+	const auto trim_asset_3d = [](Asset3D& asset_3d, const CpuResidency& cpu_residency, std::vector<std::byte>& cpu_copy,
+		const std::optional<uint64_t>&)
+		{
+			return asset_3d.TrimCpuCopy(cpu_residency, cpu_copy) ? std::optional(asset_3d.GetResidentSize()) : std::nullopt;
+		};
+	GetPool<Texture3D>().TrimCpuCopies(trim_asset_3d);
+	GetPool<Object3D>().TrimCpuCopies(trim_asset_3d);
+	GetPool<Gltf3D>().TrimCpuCopies(trim_asset_3d);
+	GetPool<Fbx3D>().TrimCpuCopies(trim_asset_3d);
+}
+
+const std::shared_ptr<cv::Mat>& hephics::asset::Manager::GetCvMat(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<cv::Mat>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("cv_mat: not found");
+
+	return asset_pool.Get(asset_handle, s_frameIdx);
+}
+
+const std::shared_ptr<hephics::asset::Texture>& hephics::asset::Manager::GetTexture(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<Texture>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("texture: not found");
+
+	return asset_pool.Get(asset_handle, s_frameIdx);
+}
+
+const std::shared_ptr<hephics::asset::TextureAtlas>& hephics::asset::Manager::GetTextureAtlas(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<TextureAtlas>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("texture_atlas: not found");
+
+	return asset_pool.Get(asset_handle, s_frameIdx);
+}
+
+const std::shared_ptr<hephics::asset::Texture3D>& hephics::asset::Manager::GetTexture3D(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<Texture3D>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("texture_3d: not found");
+
+	return asset_pool.Get(asset_handle, s_frameIdx);
+}
+
+const std::shared_ptr<hephics::asset::Object3D>& hephics::asset::Manager::GetObject3D(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<Object3D>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("object_3d: not found");
+
+	return asset_pool.Get(asset_handle, s_frameIdx);
+}
+
+const std::shared_ptr<hephics::asset::Gltf3D>& hephics::asset::Manager::GetGltf3D(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<Gltf3D>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("gltf_3d: not found");
+
+	return asset_pool.Get(asset_handle, s_frameIdx);
+}
+
+const std::shared_ptr<hephics::asset::Fbx3D>& hephics::asset::Manager::GetFbx3D(const std::string& asset_key)
+{
+	const auto& asset_pool = GetPool<Fbx3D>();
+	const auto asset_handle = asset_pool.Find(asset_key);
+	if (!asset_handle.IsValid())
+		throw std::runtime_error("fbx_3d: not found");
 
-	return std::get<std::shared_ptr<Fbx3D>>(asset_dictionary.at(asset_key));
+	return asset_pool.Get(asset_handle, s_frameIdx);
 }
\ No newline at end of file
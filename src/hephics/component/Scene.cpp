@@ -24,6 +24,12 @@ void hephics::Scene::Initialize()
 	gpu_instance->SubmitCopyGraphicResource(submit_info);
 	Scene::GetStagingBuffers().clear();
 
+	// the submission waits for the copies, uploaded assets keep only what their residency asks for
+	asset::Manager::TrimCpuCopies();
+
+	// the previous scene's actors are gone and this scene's actors hold their references by now
+	asset::Manager::Trim(asset::AssetScope::scene);
+
 	s_startTimePoint = std::chrono::high_resolution_clock::now();
 }
 
@@ -65,8 +71,25 @@ void hephics::Scene::Render()
 	std::vector<vk::CommandBuffer> submitted_command_buffers;
 	submitted_command_buffers.push_back(render_command_buffer->GetCommandBuffer().get());
 
-	const auto submit_info =
+	auto submit_info =
 		swap_chain->GetRenderingSubmitInfo(submitted_command_buffers, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+
+	// compute output of this frame, indirect commands or vertices, is read by the draws
+	std::vector<vk::Semaphore> wait_semaphores;
+	std::vector<vk::PipelineStageFlags> wait_stage_flags;
+	if (!GPUHandler::GetComputePurpose().empty() && gpu_instance->GetComputingSyncObject()->IsSemaphoreSignaled())
+	{
+		wait_semaphores = {
+			gpu_instance->GetComputingSyncObject()->GetCurrentSemaphore().get(),
+			swap_chain->GetCurrentImageAvailableSemaphore().get()
+		};
+		wait_stage_flags = {
+			vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+			vk::PipelineStageFlagBits::eColorAttachmentOutput
+		};
+		submit_info.setWaitSemaphores(wait_semaphores);
+		submit_info.setWaitDstStageMask(wait_stage_flags);
+	}
 	gpu_instance->SubmitRenderingCommand(submit_info);
 
 	if (window::Manager::CheckPressKey(GLFW_KEY_SPACE))
@@ -78,13 +101,16 @@ void hephics::Scene::Render()
 
 	if (!GPUHandler::GetComputePurpose().empty())
 		gpu_instance->GetComputingSyncObject()->PrepareNextFrame();
+
+	asset::Manager::AdvanceFrame();
+	asset::Manager::Trim();
 }
 
 void hephics::Scene::ResetScene()
 {
+	// assets and shaders stay resident so the next scene can share them, Scene::Initialize releases the rest
 	GPUHandler::WaitIdle();
-	asset::Manager::Reset();
-	vk_interface::component::ShaderProvider::Reset();
+	asset::Manager::AdvanceFrame(BUFFERING_FRAME_NUM);
 }
 
 void hephics::Scene::WriteScreenImage() const
@@ -13,8 +13,13 @@ void hephics::ComputingSyncObject::SetSyncObjects(const vk::UniqueDevice& logica
 }
 
 vk::SubmitInfo hephics::ComputingSyncObject::GetComputingSubmitInfo(
-	const std::vector<vk::CommandBuffer>& submitted_command_buffers) const
+	const std::vector<vk::CommandBuffer>& submitted_command_buffers)
 {
+	// a binary semaphore must be waited on before it is signaled again
+	if (m_isSemaphoreSignaled)
+		return vk::SubmitInfo({}, {}, submitted_command_buffers, {});
+
+	m_isSemaphoreSignaled = true;
 	return vk::SubmitInfo(
 		{}, {}, submitted_command_buffers, m_semaphores.at(m_currentFrameId).get()
 	);
@@ -34,6 +39,7 @@ void hephics::ComputingSyncObject::CancelWaitFence(const vk::UniqueDevice& logic
 void hephics::ComputingSyncObject::PrepareNextFrame()
 {
 	m_currentFrameId = (m_currentFrameId + 1) % BUFFERING_FRAME_NUM;
+	m_isSemaphoreSignaled = false;
 }
 
 void hephics::ComputingSyncObject::Clear(const vk::UniqueDevice& logical_device)
@@ -141,6 +147,7 @@ void hephics::VkInstance::SetLogicalDeviceAndQueue()
 	device_features.setSamplerAnisotropy(VK_TRUE);
 	device_features.setFillModeNonSolid(VK_TRUE);
 	device_features.setFullDrawIndexUint32(VK_TRUE);
+	device_features.setMultiDrawIndirect(m_physicalDevice.getFeatures().multiDrawIndirect); // optional, see MeshletCuller
 	vk::DeviceCreateInfo create_info({}, queue_create_info_list, {}, device_extensions, &device_features);
 
 #ifdef _DEBUG
@@ -357,6 +364,119 @@ void hephics::VkInstance::SetCommandBuffers()
 	}
 }
 
+// leads the driver's blob in PIPELINE_CACHE_PATH; the blob is only handed back to the device it came from
+struct PipelineCacheFileHeader
+{
+	static constexpr uint32_t MAGIC = 0x43505048U; // "HPPC"
+
+	uint32_t magic = MAGIC;
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint32_t driver_version;
+	std::array<uint8_t, VK_UUID_SIZE> pipeline_cache_uuid;
+	uint64_t data_size;
+	uint64_t data_hash;
+};
+
+static PipelineCacheFileHeader make_pipeline_cache_header(const vk::PhysicalDevice& physical_device)
+{
+	const auto physical_device_props = physical_device.getProperties();
+
+	PipelineCacheFileHeader header{};
+	header.vendor_id = physical_device_props.vendorID;
+	header.device_id = physical_device_props.deviceID;
+	header.driver_version = physical_device_props.driverVersion;
+	std::copy(physical_device_props.pipelineCacheUUID.begin(), physical_device_props.pipelineCacheUUID.end(),
+		header.pipeline_cache_uuid.begin());
+
+	return header;
+}
+
+void hephics::VkInstance::SetPipelineCache()
+{
+	const auto expected_header = make_pipeline_cache_header(m_physicalDevice);
+	std::unique_ptr<hephics_helper::MappedFile> ptr_mapped_file;
+	std::span<const std::byte> cache_data;
+
+	try
+	{
+		std::error_code error_code;
+		if (std::filesystem::exists(PIPELINE_CACHE_PATH, error_code))
+		{
+			ptr_mapped_file = std::make_unique<hephics_helper::MappedFile>(PIPELINE_CACHE_PATH);
+			const auto& header = ptr_mapped_file->GetSpan<PipelineCacheFileHeader>(0U, 1U).front();
+			if (header.magic != PipelineCacheFileHeader::MAGIC
+				|| header.vendor_id != expected_header.vendor_id
+				|| header.device_id != expected_header.device_id
+				|| header.driver_version != expected_header.driver_version
+				|| header.pipeline_cache_uuid != expected_header.pipeline_cache_uuid)
+				throw std::runtime_error("written by another device or driver");
+
+			cache_data = ptr_mapped_file->GetSpan<std::byte>(sizeof(PipelineCacheFileHeader), header.data_size);
+			if (hephics_helper::hash::compute_xxh64(cache_data.data(), cache_data.size()) != header.data_hash)
+				throw std::runtime_error("data is corrupted");
+		}
+	}
+	catch ([[maybe_unused]] const std::exception& exception)
+	{
+		// an empty cache only costs the compile of every pipeline once more
+		cache_data = {};
+#ifdef _DEBUG
+		std::cerr << std::format("pipeline_cache: {}\n", exception.what());
+#endif
+	}
+
+	vk::PipelineCacheCreateInfo create_info({}, cache_data.size(), cache_data.data());
+	m_pipelineCache = m_logicalDevice->createPipelineCacheUnique(create_info);
+
+#ifdef _DEBUG
+	std::cout << std::format("pipeline_cache: {} bytes loaded\n", cache_data.size());
+#endif
+}
+
+void hephics::VkInstance::SavePipelineCache() const
+{
+	if (!m_pipelineCache)
+		return;
+
+	const std::filesystem::path cache_path(PIPELINE_CACHE_PATH);
+	auto temp_path = cache_path;
+	temp_path += ".tmp";
+
+	try
+	{
+		const auto cache_data = m_logicalDevice->getPipelineCacheData(m_pipelineCache.get());
+
+		auto header = make_pipeline_cache_header(m_physicalDevice);
+		header.data_size = cache_data.size();
+		header.data_hash = hephics_helper::hash::compute_xxh64(cache_data.data(), cache_data.size());
+
+		std::filesystem::create_directories(cache_path.parent_path());
+
+		{
+			std::ofstream ofs(temp_path, std::ios::binary | std::ios::trunc);
+			if (!ofs.is_open())
+				throw std::runtime_error("Failed to open file: " + temp_path.string());
+
+			ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			ofs.write(reinterpret_cast<const char*>(cache_data.data()), cache_data.size());
+			if (!ofs.good())
+				throw std::runtime_error("Failed to write file: " + temp_path.string());
+		}
+
+		// the next launch never maps a half written cache
+		std::filesystem::rename(temp_path, cache_path);
+	}
+	catch ([[maybe_unused]] const std::exception& exception)
+	{
+		std::error_code error_code;
+		std::filesystem::remove(temp_path, error_code);
+#ifdef _DEBUG
+		std::cerr << std::format("pipeline_cache: {}\n", exception.what());
+#endif
+	}
+}
+
 hephics::VkInstance::VkInstance()
 	: Instance()
 {
@@ -367,6 +487,7 @@ hephics::VkInstance::VkInstance()
 
 	SetPhysicalDevice();
 	SetLogicalDeviceAndQueue();
+	SetPipelineCache();
 
 	SetSwapChain();
 	SetSwapChainImageViews();
@@ -406,6 +527,36 @@ void hephics::VkInstance::SubmitCopyGraphicResource(const vk::SubmitInfo& submit
 	m_logicalDevice->waitIdle();
 }
 
+void hephics::VkInstance::SubmitOneTimeCommands(
+	const std::function<void(const std::shared_ptr<vk_interface::component::CommandBuffer>&)>& record_commands)
+{
+	if (!m_queuesDictionary.contains(vk::QueueFlagBits::eGraphics))
+		throw std::runtime_error("queue: not found");
+
+	// a transient pool per submission, its one command buffer is recorded once and freed with it
+	vk::CommandPoolCreateInfo pool_create_info(vk::CommandPoolCreateFlagBits::eTransient,
+		m_queueFamilyIndices.graphics_and_compute_family.value());
+	auto command_pool = m_logicalDevice->createCommandPoolUnique(pool_create_info);
+
+	vk::CommandBufferAllocateInfo alloc_info(command_pool.get(), vk::CommandBufferLevel::ePrimary, 1);
+	auto command_buffer = std::make_shared<vk_interface::component::CommandBuffer>();
+	command_buffer->SetCommandBuffer(m_logicalDevice->allocateCommandBuffersUnique(alloc_info));
+
+	command_buffer->BeginRecordingCommands(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	record_commands(command_buffer);
+	command_buffer->EndRecordingCommands();
+
+	vk_interface::component::Fence fence;
+	fence.SetFence(m_logicalDevice, vk::FenceCreateInfo());
+
+	std::vector<vk::CommandBuffer> submitted_command_buffers;
+	submitted_command_buffers.push_back(command_buffer->GetCommandBuffer().get());
+
+	vk::SubmitInfo submit_info({}, {}, submitted_command_buffers);
+	m_queuesDictionary.at(vk::QueueFlagBits::eGraphics).at("graphics").submit(submit_info, fence.GetFence().get());
+	fence.Wait(m_logicalDevice, UINT64_MAX);
+}
+
 void hephics::VkInstance::SubmitRenderingCommand(const vk::SubmitInfo& submit_info)
 {
 	if (!m_queuesDictionary.contains(vk::QueueFlagBits::eGraphics))
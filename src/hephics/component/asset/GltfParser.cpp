@@ -0,0 +1,466 @@
+#include "../../Hephics.hpp"
+
+using GltfAccessor = hephics::asset::gltf_parser::Accessor;
+
+static constexpr uint32_t GLB_MAGIC = 0x46546C67U; // "glTF"
+static constexpr uint32_t GLB_VERSION = 2U;
+static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534AU; // "JSON"
+static constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942U; // "BIN\0"
+static constexpr uint32_t GLTF_MODE_TRIANGLES = 4U;
+static constexpr uint32_t JSON_MAX_DEPTH = 128U;
+
+// strings are views into the mapped JSON chunk with their escapes left in place,
+// the names glTF defines never contain any
+struct JsonValue
+{
+	using Array = std::vector<JsonValue>;
+	using Object = std::vector<std::pair<std::string_view, JsonValue>>;
+
+	std::variant<std::nullptr_t, bool, double_t, std::string_view, Array, Object> value = nullptr;
+
+	const JsonValue* Find(const std::string_view& key) const
+	{
+		if (!std::holds_alternative<Object>(value))
+			return nullptr;
+
+		for (const auto& [member_key, member_value] : std::get<Object>(value))
+		{
+			if (member_key == key)
+				return &member_value;
+		}
+		return nullptr;
+	}
+
+	const JsonValue& At(const std::string_view& key) const
+	{
+		const auto ptr_member = Find(key);
+		if (ptr_member == nullptr)
+			throw std::runtime_error(std::format("gltf_parser: missing \"{}\"", key));
+		return *ptr_member;
+	}
+
+	const JsonValue& At(const size_t& idx) const
+	{
+		const auto& array = GetArray();
+		if (idx >= array.size())
+			throw std::runtime_error("gltf_parser: index out of range");
+		return array[idx];
+	}
+
+	const Array& GetArray() const
+	{
+		if (!std::holds_alternative<Array>(value))
+			throw std::runtime_error("gltf_parser: array expected");
+		return std::get<Array>(value);
+	}
+
+	std::string_view GetString() const
+	{
+		if (!std::holds_alternative<std::string_view>(value))
+			throw std::runtime_error("gltf_parser: string expected");
+		return std::get<std::string_view>(value);
+	}
+
+	double_t GetNumber() const
+	{
+		if (!std::holds_alternative<double_t>(value))
+			throw std::runtime_error("gltf_parser: number expected");
+		return std::get<double_t>(value);
+	}
+
+	size_t GetIndex() const
+	{
+		const auto number = GetNumber();
+		if (number < 0.0 || number != std::floor(number))
+			throw std::runtime_error("gltf_parser: index expected");
+		return static_cast<size_t>(number);
+	}
+
+	size_t GetIndex(const std::string_view& key, const size_t& default_value) const
+	{
+		const auto ptr_member = Find(key);
+		return ptr_member != nullptr ? ptr_member->GetIndex() : default_value;
+	}
+};
+
+static inline void skip_json_space(const char*& ptr, const char* const end)
+{
+	while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r'))
+		ptr++;
+}
+
+static inline bool match_json_literal(const char*& ptr, const char* const end, const std::string_view& literal)
+{
+	if (static_cast<size_t>(end - ptr) < literal.size() || std::string_view(ptr, literal.size()) != literal)
+		return false;
+
+	ptr += literal.size();
+	return true;
+}
+
+static std::string_view parse_json_string(const char*& ptr, const char* const end)
+{
+	if (ptr >= end || *ptr != '"')
+		throw std::runtime_error("gltf_parser: string expected");
+
+	const auto begin = ++ptr;
+	while (ptr < end && *ptr != '"')
+	{
+		if (*ptr == '\\')
+			ptr++;
+		ptr++;
+	}
+
+	if (ptr >= end)
+		throw std::runtime_error("gltf_parser: unterminated string");
+
+	return std::string_view(begin, ptr++);
+}
+
+static JsonValue parse_json_value(const char*& ptr, const char* const end, const uint32_t& depth)
+{
+	if (depth > JSON_MAX_DEPTH)
+		throw std::runtime_error("gltf_parser: nesting too deep");
+
+	skip_json_space(ptr, end);
+	if (ptr >= end)
+		throw std::runtime_error("gltf_parser: unexpected end of JSON");
+
+	JsonValue json_value;
+
+	if (*ptr == '{')
+	{
+		JsonValue::Object object;
+		ptr++;
+		skip_json_space(ptr, end);
+
+		if (ptr < end && *ptr == '}')
+		{
+			ptr++;
+			json_value.value = std::move(object);
+			return json_value;
+		}
+
+		while (true)
+		{
+			skip_json_space(ptr, end);
+			const auto key = parse_json_string(ptr, end);
+
+			skip_json_space(ptr, end);
+			if (ptr >= end || *ptr != ':')
+				throw std::runtime_error("gltf_parser: ':' expected");
+			ptr++;
+
+			object.emplace_back(key, parse_json_value(ptr, end, depth + 1U));
+
+			skip_json_space(ptr, end);
+			if (ptr < end && *ptr == ',')
+			{
+				ptr++;
+				continue;
+			}
+			if (ptr < end && *ptr == '}')
+			{
+				ptr++;
+				break;
+			}
+			throw std::runtime_error("gltf_parser: ',' or '}' expected");
+		}
+
+		json_value.value = std::move(object);
+	}
+	else if (*ptr == '[')
+	{
+		JsonValue::Array array;
+		ptr++;
+		skip_json_space(ptr, end);
+
+		if (ptr < end && *ptr == ']')
+		{
+			ptr++;
+			json_value.value = std::move(array);
+			return json_value;
+		}
+
+		while (true)
+		{
+			array.emplace_back(parse_json_value(ptr, end, depth + 1U));
+
+			skip_json_space(ptr, end);
+			if (ptr < end && *ptr == ',')
+			{
+				ptr++;
+				continue;
+			}
+			if (ptr < end && *ptr == ']')
+			{
+				ptr++;
+				break;
+			}
+			throw std::runtime_error("gltf_parser: ',' or ']' expected");
+		}
+
+		json_value.value = std::move(array);
+	}
+	else if (*ptr == '"')
+	{
+		json_value.value = parse_json_string(ptr, end);
+	}
+	else if (match_json_literal(ptr, end, "true"))
+	{
+		json_value.value = true;
+	}
+	else if (match_json_literal(ptr, end, "false"))
+	{
+		json_value.value = false;
+	}
+	else if (match_json_literal(ptr, end, "null"))
+	{
+		json_value.value = nullptr;
+	}
+	else
+	{
+		double_t number = 0.0;
+		const auto [ptr_next, error_code] = std::from_chars(ptr, end, number);
+		if (error_code != std::errc())
+			throw std::runtime_error("gltf_parser: invalid JSON value");
+
+		ptr = ptr_next;
+		json_value.value = number;
+	}
+
+	return json_value;
+}
+
+static uint32_t get_component_num(const std::string_view& type)
+{
+	if (type == "SCALAR")
+		return 1U;
+	if (type == "VEC2")
+		return 2U;
+	if (type == "VEC3")
+		return 3U;
+	if (type == "VEC4")
+		return 4U;
+
+	throw std::runtime_error(std::format("gltf_parser: unsupported accessor type {}", type));
+}
+
+static GltfAccessor make_accessor(const JsonValue& root, const size_t& accessor_idx,
+	const std::span<const std::byte>& bin_chunk)
+{
+	const auto& json_accessor = root.At("accessors").At(accessor_idx);
+	if (json_accessor.Find("sparse") != nullptr)
+		throw std::runtime_error("gltf_parser: sparse accessors are not supported");
+
+	GltfAccessor accessor;
+	accessor.count = json_accessor.At("count").GetIndex();
+	accessor.component_type = static_cast<uint32_t>(json_accessor.At("componentType").GetIndex());
+	accessor.component_num = get_component_num(json_accessor.At("type").GetString());
+
+	if (const auto ptr_normalized = json_accessor.Find("normalized"))
+		accessor.is_normalized = std::holds_alternative<bool>(ptr_normalized->value) && std::get<bool>(ptr_normalized->value);
+
+	const auto element_size = accessor.GetComponentSize() * accessor.component_num;
+
+	const auto& json_buffer_view = root.At("bufferViews").At(json_accessor.At("bufferView").GetIndex());
+	const auto buffer_idx = json_buffer_view.At("buffer").GetIndex();
+	if (buffer_idx != 0U || root.At("buffers").At(buffer_idx).Find("uri") != nullptr)
+		throw std::runtime_error("gltf_parser: only the embedded GLB buffer is supported");
+
+	const auto view_offset = json_buffer_view.GetIndex("byteOffset", 0U);
+	const auto view_size = json_buffer_view.At("byteLength").GetIndex();
+	const auto element_offset = json_accessor.GetIndex("byteOffset", 0U);
+	accessor.stride = json_buffer_view.GetIndex("byteStride", element_size);
+
+	if (accessor.stride < element_size)
+		throw std::runtime_error("gltf_parser: byte stride smaller than the element");
+
+	const auto used_size = accessor.count == 0U ? 0U : element_offset + accessor.stride * (accessor.count - 1U) + element_size;
+	if (view_offset + view_size > bin_chunk.size() || used_size > view_size)
+		throw std::runtime_error("gltf_parser: accessor out of range");
+
+	accessor.ptr_data = bin_chunk.data() + view_offset + element_offset;
+
+	return accessor;
+}
+
+size_t hephics::asset::gltf_parser::Accessor::GetComponentSize() const
+{
+	switch (component_type)
+	{
+	case COMPONENT_BYTE:
+	case COMPONENT_UNSIGNED_BYTE:
+		return 1U;
+	case COMPONENT_SHORT:
+	case COMPONENT_UNSIGNED_SHORT:
+		return 2U;
+	case COMPONENT_UNSIGNED_INT:
+	case COMPONENT_FLOAT:
+		return 4U;
+	default:
+		throw std::runtime_error(std::format("gltf_parser: unsupported component type {}", component_type));
+	}
+}
+
+float_t hephics::asset::gltf_parser::Accessor::ReadFloat(const size_t& element_idx, const uint32_t& component_idx) const
+{
+	const auto ptr_component = ptr_data + stride * element_idx + GetComponentSize() * component_idx;
+
+	// glTF only requires component alignment, so every read goes through memcpy
+	const auto read = [ptr_component]<typename T>(T)
+		{
+			T component;
+			std::memcpy(&component, ptr_component, sizeof(T));
+			return component;
+		};
+
+	switch (component_type)
+	{
+	case COMPONENT_BYTE:
+	{
+		const auto component = static_cast<float_t>(read(int8_t()));
+		return is_normalized ? std::max(component / 127.0f, -1.0f) : component;
+	}
+	case COMPONENT_UNSIGNED_BYTE:
+	{
+		const auto component = static_cast<float_t>(read(uint8_t()));
+		return is_normalized ? component / 255.0f : component;
+	}
+	case COMPONENT_SHORT:
+	{
+		const auto component = static_cast<float_t>(read(int16_t()));
+		return is_normalized ? std::max(component / 32767.0f, -1.0f) : component;
+	}
+	case COMPONENT_UNSIGNED_SHORT:
+	{
+		const auto component = static_cast<float_t>(read(uint16_t()));
+		return is_normalized ? component / 65535.0f : component;
+	}
+	case COMPONENT_UNSIGNED_INT:
+		return static_cast<float_t>(read(uint32_t()));
+	case COMPONENT_FLOAT:
+		return read(float_t());
+	default:
+		throw std::runtime_error(std::format("gltf_parser: unsupported component type {}", component_type));
+	}
+}
+
+uint32_t hephics::asset::gltf_parser::Accessor::ReadIndex(const size_t& element_idx) const
+{
+	const auto ptr_element = ptr_data + stride * element_idx;
+
+	switch (component_type)
+	{
+	case COMPONENT_UNSIGNED_BYTE:
+		return static_cast<uint32_t>(*reinterpret_cast<const uint8_t*>(ptr_element));
+	case COMPONENT_UNSIGNED_SHORT:
+	{
+		uint16_t index;
+		std::memcpy(&index, ptr_element, sizeof(uint16_t));
+		return index;
+	}
+	case COMPONENT_UNSIGNED_INT:
+	{
+		uint32_t index;
+		std::memcpy(&index, ptr_element, sizeof(uint32_t));
+		return index;
+	}
+	default:
+		throw std::runtime_error(std::format("gltf_parser: unsupported index type {}", component_type));
+	}
+}
+
+hephics::asset::gltf_parser::ParseResult hephics::asset::gltf_parser::parse(const std::string& path)
+{
+	ParseResult parse_result;
+	parse_result.ptr_mapped_file = std::make_shared<hephics_helper::MappedFile>(path);
+	const auto& mapped_file = *parse_result.ptr_mapped_file;
+
+	const auto header = mapped_file.GetSpan<uint32_t>(0U, 3U);
+	if (header[0] != GLB_MAGIC || header[1] != GLB_VERSION || header[2] > mapped_file.GetSize())
+		throw std::runtime_error("gltf_parser: not a glTF 2.0 binary " + path);
+
+	std::string_view json_chunk;
+	std::span<const std::byte> bin_chunk;
+
+	// chunks are 4-byte aligned, JSON comes first and at most one BIN follows
+	for (size_t chunk_offset = 3U * sizeof(uint32_t); chunk_offset + 2U * sizeof(uint32_t) <= header[2];)
+	{
+		const auto chunk_header = mapped_file.GetSpan<uint32_t>(chunk_offset, 2U);
+		const auto chunk_data = mapped_file.GetSpan<std::byte>(chunk_offset + 2U * sizeof(uint32_t), chunk_header[0]);
+
+		if (chunk_header[1] == GLB_CHUNK_JSON && json_chunk.empty())
+			json_chunk = std::string_view(reinterpret_cast<const char*>(chunk_data.data()), chunk_data.size());
+		else if (chunk_header[1] == GLB_CHUNK_BIN && bin_chunk.empty())
+			bin_chunk = chunk_data;
+
+		chunk_offset += 2U * sizeof(uint32_t) + ((static_cast<size_t>(chunk_header[0]) + 3U) & ~size_t(3U));
+	}
+
+	if (json_chunk.empty())
+		throw std::runtime_error("gltf_parser: missing JSON chunk " + path);
+
+	const char* ptr_json = json_chunk.data();
+	const auto root = parse_json_value(ptr_json, json_chunk.data() + json_chunk.size(), 0U);
+
+	const auto ptr_meshes = root.Find("meshes");
+	if (ptr_meshes == nullptr)
+		return parse_result;
+
+	for (const auto& json_mesh : ptr_meshes->GetArray())
+	{
+		for (const auto& json_primitive : json_mesh.At("primitives").GetArray())
+		{
+			if (json_primitive.GetIndex("mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+				throw std::runtime_error("gltf_parser: only triangle lists are supported " + path);
+
+			const auto& json_attributes = json_primitive.At("attributes");
+			const auto position_idx = json_attributes.At("POSITION").GetIndex();
+
+			Primitive primitive;
+			primitive.position = make_accessor(root, position_idx, bin_chunk);
+			if (primitive.position.component_num != 3U)
+				throw std::runtime_error("gltf_parser: POSITION must be VEC3 " + path);
+
+			if (const auto ptr_tex_coord = json_attributes.Find("TEXCOORD_0"))
+				primitive.tex_coord = make_accessor(root, ptr_tex_coord->GetIndex(), bin_chunk);
+			if (const auto ptr_color = json_attributes.Find("COLOR_0"))
+				primitive.color = make_accessor(root, ptr_color->GetIndex(), bin_chunk);
+			if (const auto ptr_indices = json_primitive.Find("indices"))
+				primitive.indices = make_accessor(root, ptr_indices->GetIndex(), bin_chunk);
+
+			if ((primitive.tex_coord && primitive.tex_coord->count != primitive.position.count) ||
+				(primitive.color && primitive.color->count != primitive.position.count))
+				throw std::runtime_error("gltf_parser: attribute counts differ " + path);
+
+			if (primitive.indices && primitive.indices->component_num != 1U)
+				throw std::runtime_error("gltf_parser: indices must be SCALAR " + path);
+
+			// the spec requires min and max on POSITION, files that omit them are scanned
+			const auto& json_position = root.At("accessors").At(position_idx);
+			const auto ptr_min = json_position.Find("min");
+			const auto ptr_max = json_position.Find("max");
+			if (ptr_min != nullptr && ptr_max != nullptr)
+			{
+				for (uint32_t axis = 0U; axis < 3U; axis++)
+				{
+					primitive.bounds.min[axis] = static_cast<float_t>(ptr_min->At(axis).GetNumber());
+					primitive.bounds.max[axis] = static_cast<float_t>(ptr_max->At(axis).GetNumber());
+				}
+			}
+			else
+			{
+				for (size_t vertex_idx = 0U; vertex_idx < primitive.position.count; vertex_idx++)
+				{
+					primitive.bounds.Expand({ primitive.position.ReadFloat(vertex_idx, 0U),
+						primitive.position.ReadFloat(vertex_idx, 1U), primitive.position.ReadFloat(vertex_idx, 2U) });
+				}
+			}
+
+			parse_result.primitives.emplace_back(std::move(primitive));
+		}
+	}
+
+	return parse_result;
+}
\ No newline at end of file
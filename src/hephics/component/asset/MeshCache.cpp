@@ -0,0 +1,240 @@
+#include "../../Hephics.hpp"
+
+static int64_t get_write_time(const std::filesystem::path& path)
+{
+	return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+}
+
+static uint64_t hash_source_file(const std::filesystem::path& path)
+{
+	hephics_helper::MappedFile source_file(path);
+	return hephics_helper::hash::compute_xxh64(source_file.GetData(), source_file.GetSize());
+}
+
+uint32_t hephics::asset::MeshCache::GetFlags(const ModelLoadSettings& load_settings)
+{
+	return (load_settings.is_optimized ? FLAG_OPTIMIZED : 0U)
+		| (load_settings.use_meshlets ? FLAG_MESHLETS : 0U)
+		| (load_settings.lod_num << LOD_NUM_SHIFT);
+}
+
+std::filesystem::path hephics::asset::MeshCache::GetCachePath(const std::string& source_path, const uint32_t& flags)
+{
+	const auto source_file_name = std::filesystem::path(source_path).filename().string();
+	const auto path_hash = hephics_helper::hash::compute_xxh64(source_path.data(), source_path.size());
+	const auto cache_hash = hephics_helper::hash::compute_xxh64(&flags, sizeof(flags), path_hash);
+
+	return std::filesystem::path(std::format("output/cache/model/{}_{:016x}.hmesh", source_file_name, cache_hash));
+}
+
+bool hephics::asset::MeshCache::ParseHeader(const uint32_t& flags)
+{
+	if (m_data.size() < sizeof(Header))
+		return false;
+
+	std::memcpy(&m_header, m_data.data(), sizeof(Header));
+
+	if (m_header.magic != MAGIC || m_header.version != VERSION || m_header.vertex_stride != sizeof(VertexData)
+		|| m_header.flags != flags)
+		return false;
+
+	return m_header.vertex_offset + m_header.vertex_count * sizeof(VertexData) <= m_data.size()
+		&& m_header.index_offset + m_header.index_count * sizeof(uint32_t) <= m_data.size()
+		&& m_header.lod_offset + m_header.lod_count * sizeof(LodLevel) <= m_data.size()
+		&& m_header.meshlet_offset + m_header.meshlet_count * sizeof(Meshlet) <= m_data.size()
+		&& m_header.material_offset + m_header.material_count * sizeof(MaterialRange) <= m_data.size()
+		&& m_header.material_library_offset + m_header.material_library_size <= m_data.size();
+}
+
+std::shared_ptr<hephics::asset::MeshCache> hephics::asset::MeshCache::Load(const std::string& source_path,
+	const uint32_t& flags)
+{
+	const auto cache_path = GetCachePath(source_path, flags);
+
+	std::error_code error_code;
+	if (!std::filesystem::exists(cache_path, error_code) || !std::filesystem::exists(source_path, error_code))
+		return nullptr;
+
+	auto ptr_mesh_cache = std::make_shared<MeshCache>();
+	try
+	{
+		ptr_mesh_cache->m_mappedFile.Open(cache_path);
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+
+	const auto& mapped_file = ptr_mesh_cache->m_mappedFile;
+	ptr_mesh_cache->m_data = std::span(mapped_file.GetData(), mapped_file.GetSize());
+	if (!ptr_mesh_cache->ParseHeader(flags))
+		return nullptr;
+
+	const auto& header = ptr_mesh_cache->m_header;
+	if (header.source_size != std::filesystem::file_size(source_path))
+		return nullptr;
+
+	// the timestamp alone changes on copy or checkout: only re-hash the source when it differs
+	const auto source_write_time = get_write_time(source_path);
+	if (header.source_write_time != source_write_time)
+	{
+		if (header.source_hash != hash_source_file(source_path))
+			return nullptr;
+
+		// the same content, record the new time so later loads skip the hash
+		ptr_mesh_cache->m_mappedFile.Close();
+		RefreshSourceWriteTime(cache_path, source_write_time);
+
+		try
+		{
+			ptr_mesh_cache->m_mappedFile.Open(cache_path);
+		}
+		catch (const std::exception&)
+		{
+			return nullptr;
+		}
+
+		ptr_mesh_cache->m_data = std::span(mapped_file.GetData(), mapped_file.GetSize());
+		if (!ptr_mesh_cache->ParseHeader(flags))
+			return nullptr;
+	}
+
+	return ptr_mesh_cache;
+}
+
+void hephics::asset::MeshCache::RefreshSourceWriteTime(const std::filesystem::path& cache_path, const int64_t& write_time)
+{
+	// only the one field is patched in place, the rest of the image stays valid
+	std::fstream fs(cache_path, std::ios::binary | std::ios::in | std::ios::out);
+	if (!fs.is_open())
+		return;
+
+	fs.seekp(offsetof(Header, source_write_time));
+	fs.write(reinterpret_cast<const char*>(&write_time), sizeof(write_time));
+#ifdef _DEBUG
+	if (!fs.good())
+		std::cerr << std::format("mesh_cache: failed to refresh {}\n", cache_path.string());
+#endif
+}
+
+std::shared_ptr<hephics::asset::MeshCache> hephics::asset::MeshCache::LoadPacked(const std::string& source_path,
+	const uint32_t& flags)
+{
+	// the pack replaces the sources, there is nothing to compare against
+	auto packed_data = hephics_helper::PackArchive::Load(hephics_helper::PackArchive::GetEntryName(source_path));
+	if (!packed_data)
+		return nullptr;
+
+	auto ptr_mesh_cache = std::make_shared<MeshCache>();
+	ptr_mesh_cache->m_packedData = std::move(packed_data);
+	ptr_mesh_cache->m_data = ptr_mesh_cache->m_packedData->GetBytes();
+	if (!ptr_mesh_cache->ParseHeader(flags))
+	{
+#ifdef _DEBUG
+		std::cout << std::format("mesh_cache: {} was cooked with other settings, loading the source\n", source_path);
+#endif
+		return nullptr;
+	}
+
+	return ptr_mesh_cache;
+}
+
+hephics::asset::MeshCache::Header hephics::asset::MeshCache::MakeHeader(const std::string& source_path,
+	const size_t& vertex_num, const size_t& index_num, const size_t& lod_num, const size_t& meshlet_num,
+	const size_t& material_num, const size_t& material_library_size, const BoundingBox& bounds, const uint32_t& flags)
+{
+	Header header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.vertex_stride = sizeof(VertexData);
+	header.flags = flags;
+	header.source_size = std::filesystem::file_size(source_path);
+	header.source_write_time = get_write_time(source_path);
+	header.source_hash = hash_source_file(source_path);
+	header.vertex_count = vertex_num;
+	header.index_count = index_num;
+	header.vertex_offset = sizeof(Header);
+	header.index_offset = header.vertex_offset + sizeof(VertexData) * vertex_num;
+	header.lod_count = lod_num;
+	header.lod_offset = header.index_offset + sizeof(uint32_t) * index_num;
+	header.meshlet_count = meshlet_num;
+	header.meshlet_offset = header.lod_offset + sizeof(LodLevel) * lod_num;
+	header.material_count = material_num;
+	header.material_offset = header.meshlet_offset + sizeof(Meshlet) * meshlet_num;
+	header.material_library_size = material_library_size;
+	header.material_library_offset = header.material_offset + sizeof(MaterialRange) * material_num;
+	for (int32_t axis = 0; axis < 3; axis++)
+	{
+		header.bounds_min[axis] = bounds.min[axis];
+		header.bounds_max[axis] = bounds.max[axis];
+	}
+
+	return header;
+}
+
+void hephics::asset::MeshCache::Write(const std::string& source_path, const std::span<const VertexData>& vertices,
+	const std::span<const uint32_t>& indices, const std::span<const LodLevel>& lod_levels,
+	const std::span<const Meshlet>& meshlets, const std::span<const MaterialRange>& material_ranges,
+	const std::string& material_library, const BoundingBox& bounds, const uint32_t& flags)
+{
+	const auto cache_path = GetCachePath(source_path, flags);
+	auto temp_path = cache_path;
+	temp_path += ".tmp";
+
+	try
+	{
+		std::filesystem::create_directories(cache_path.parent_path());
+
+		const auto header = MakeHeader(source_path, vertices.size(), indices.size(), lod_levels.size(), meshlets.size(),
+			material_ranges.size(), material_library.size(), bounds, flags);
+
+		{
+			std::ofstream ofs(temp_path, std::ios::binary | std::ios::trunc);
+			if (!ofs.is_open())
+				throw std::runtime_error("Failed to open file: " + temp_path.string());
+
+			ofs.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			ofs.write(reinterpret_cast<const char*>(vertices.data()), vertices.size_bytes());
+			ofs.write(reinterpret_cast<const char*>(indices.data()), indices.size_bytes());
+			ofs.write(reinterpret_cast<const char*>(lod_levels.data()), lod_levels.size_bytes());
+			ofs.write(reinterpret_cast<const char*>(meshlets.data()), meshlets.size_bytes());
+			ofs.write(reinterpret_cast<const char*>(material_ranges.data()), material_ranges.size_bytes());
+			ofs.write(material_library.data(), material_library.size());
+			if (!ofs.good())
+				throw std::runtime_error("Failed to write file: " + temp_path.string());
+		}
+
+		// publish the finished file in one step, so an interrupted write never leaves a readable cache
+		std::filesystem::rename(temp_path, cache_path);
+	}
+	catch ([[maybe_unused]] const std::exception& exception)
+	{
+		// the cache is an optimization only: loading continues from the parsed data
+		std::error_code error_code;
+		std::filesystem::remove(temp_path, error_code);
+#ifdef _DEBUG
+		std::cerr << std::format("mesh_cache: {}\n", exception.what());
+#endif
+	}
+}
+
+std::vector<std::byte> hephics::asset::MeshCache::Encode(const std::string& source_path,
+	const std::span<const VertexData>& vertices, const std::span<const uint32_t>& indices,
+	const std::span<const LodLevel>& lod_levels, const std::span<const Meshlet>& meshlets,
+	const std::span<const MaterialRange>& material_ranges, const std::string& material_library, const BoundingBox& bounds,
+	const uint32_t& flags)
+{
+	const auto header = MakeHeader(source_path, vertices.size(), indices.size(), lod_levels.size(), meshlets.size(),
+		material_ranges.size(), material_library.size(), bounds, flags);
+
+	std::vector<std::byte> mesh_image(header.material_library_offset + material_library.size());
+	std::memcpy(mesh_image.data(), &header, sizeof(Header));
+	std::memcpy(mesh_image.data() + header.vertex_offset, vertices.data(), vertices.size_bytes());
+	std::memcpy(mesh_image.data() + header.index_offset, indices.data(), indices.size_bytes());
+	std::memcpy(mesh_image.data() + header.lod_offset, lod_levels.data(), lod_levels.size_bytes());
+	std::memcpy(mesh_image.data() + header.meshlet_offset, meshlets.data(), meshlets.size_bytes());
+	std::memcpy(mesh_image.data() + header.material_offset, material_ranges.data(), material_ranges.size_bytes());
+	std::memcpy(mesh_image.data() + header.material_library_offset, material_library.data(), material_library.size());
+
+	return mesh_image;
+}
\ No newline at end of file
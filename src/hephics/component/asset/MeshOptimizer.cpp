@@ -0,0 +1,816 @@
+#include "../../Hephics.hpp"
+
+// vertex -> triangles adjacency in compressed rows
+struct MeshAdjacency
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+	std::vector<uint32_t> live_counts;
+};
+
+static MeshAdjacency build_adjacency(const std::span<const uint32_t>& indices, const size_t& vertex_num)
+{
+	MeshAdjacency adjacency;
+	adjacency.offsets.assign(vertex_num + 1U, 0U);
+	adjacency.live_counts.assign(vertex_num, 0U);
+
+	for (const auto& index : indices)
+		adjacency.live_counts.at(index)++;
+
+	for (size_t vertex_idx = 0U; vertex_idx < vertex_num; vertex_idx++)
+		adjacency.offsets.at(vertex_idx + 1U) = adjacency.offsets.at(vertex_idx) + adjacency.live_counts.at(vertex_idx);
+
+	adjacency.triangles.resize(indices.size());
+	auto fill_positions = adjacency.offsets;
+	for (size_t corner_idx = 0U; corner_idx < indices.size(); corner_idx++)
+		adjacency.triangles.at(fill_positions.at(indices[corner_idx])++) = static_cast<uint32_t>(corner_idx / 3U);
+
+	return adjacency;
+}
+
+// FIFO cache: a vertex is resident while fewer than "cache_size" misses happened since it was loaded
+static inline bool touch_vertex(std::vector<uint32_t>& time_stamps, uint32_t& time_stamp,
+	const uint32_t& vertex, const uint32_t& cache_size)
+{
+	if (time_stamps[vertex] != 0U && time_stamp - time_stamps[vertex] <= cache_size)
+		return false;
+
+	time_stamps[vertex] = time_stamp++;
+	return true;
+}
+
+float_t hephics::asset::mesh_optimizer::compute_acmr(const std::span<const uint32_t>& indices,
+	const size_t& vertex_num, const uint32_t& cache_size)
+{
+	if (indices.size() < 3U)
+		return 0.0f;
+
+	std::vector<uint32_t> time_stamps(vertex_num, 0U);
+	uint32_t time_stamp = 1U;
+	size_t miss_num = 0U;
+
+	for (const auto& index : indices)
+		miss_num += touch_vertex(time_stamps, time_stamp, index, cache_size);
+
+	return static_cast<float_t>(miss_num) / static_cast<float_t>(indices.size() / 3U);
+}
+
+std::vector<uint32_t> hephics::asset::mesh_optimizer::optimize_vertex_cache(std::vector<uint32_t>& indices,
+	const size_t& vertex_num, const uint32_t& cache_size)
+{
+	// Tipsify (Sander, Nehab and Barczak 2007): fan around the most recently used vertex that is still
+	// in the cache, and fall back to the dead-end stack or the next vertex in input order
+	const auto triangle_num = indices.size() / 3U;
+	std::vector<uint32_t> cluster_starts;
+	if (triangle_num == 0U)
+		return cluster_starts;
+
+	auto adjacency = build_adjacency(indices, vertex_num);
+	auto& live_counts = adjacency.live_counts;
+
+	std::vector<uint32_t> time_stamps(vertex_num, 0U);
+	std::vector<uint8_t> is_emitted(triangle_num, 0U);
+	std::vector<uint32_t> dead_end_stack;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output_indices;
+	output_indices.reserve(indices.size());
+
+	uint32_t time_stamp = cache_size + 1U;
+	size_t input_cursor = 0U;
+
+	const auto skip_dead_end = [&]() -> int64_t
+		{
+			while (!dead_end_stack.empty())
+			{
+				const auto vertex = dead_end_stack.back();
+				dead_end_stack.pop_back();
+				if (live_counts[vertex] > 0U)
+					return vertex;
+			}
+
+			while (input_cursor < vertex_num)
+			{
+				if (live_counts[input_cursor] > 0U)
+					return static_cast<int64_t>(input_cursor++);
+				input_cursor++;
+			}
+
+			return -1;
+		};
+
+	int64_t fanning_vertex = skip_dead_end();
+	bool is_cluster_start = true;
+
+	while (fanning_vertex >= 0)
+	{
+		if (is_cluster_start)
+			cluster_starts.emplace_back(static_cast<uint32_t>(output_indices.size() / 3U));
+
+		candidates.clear();
+
+		const auto vertex = static_cast<uint32_t>(fanning_vertex);
+		for (auto adjacency_idx = adjacency.offsets[vertex]; adjacency_idx < adjacency.offsets[vertex + 1U]; adjacency_idx++)
+		{
+			const auto triangle = adjacency.triangles[adjacency_idx];
+			if (is_emitted[triangle])
+				continue;
+
+			for (uint32_t corner = 0U; corner < 3U; corner++)
+			{
+				const auto triangle_vertex = indices[3U * triangle + corner];
+				output_indices.emplace_back(triangle_vertex);
+				dead_end_stack.emplace_back(triangle_vertex);
+				candidates.emplace_back(triangle_vertex);
+				live_counts[triangle_vertex]--;
+
+				if (time_stamp - time_stamps[triangle_vertex] > cache_size)
+					time_stamps[triangle_vertex] = time_stamp++;
+			}
+
+			is_emitted[triangle] = 1U;
+		}
+
+		// prefer the candidate that stays in the cache for all its remaining triangles and was loaded first
+		int64_t next_vertex = -1;
+		int64_t best_priority = -1;
+		for (const auto& candidate : candidates)
+		{
+			if (live_counts[candidate] == 0U)
+				continue;
+
+			int64_t priority = 0;
+			const auto age = static_cast<int64_t>(time_stamp - time_stamps[candidate]);
+			if (age + 2 * static_cast<int64_t>(live_counts[candidate]) <= static_cast<int64_t>(cache_size))
+				priority = age;
+
+			if (priority > best_priority)
+			{
+				best_priority = priority;
+				next_vertex = candidate;
+			}
+		}
+
+		is_cluster_start = next_vertex < 0;
+		fanning_vertex = is_cluster_start ? skip_dead_end() : next_vertex;
+	}
+
+	indices = std::move(output_indices);
+	return cluster_starts;
+}
+
+void hephics::asset::mesh_optimizer::optimize_overdraw(std::vector<uint32_t>& indices,
+	const std::span<const VertexData>& vertices, const std::vector<uint32_t>& cluster_starts,
+	const uint32_t& cache_size, const float_t& threshold)
+{
+	// Tipsy section 4: cut the hard clusters further wherever the running ACMR is already good,
+	// then draw the clusters that face away from the mesh center first
+	const auto triangle_num = static_cast<uint32_t>(indices.size() / 3U);
+	if (triangle_num == 0U || cluster_starts.empty())
+		return;
+
+	const auto split_acmr = compute_acmr(indices, vertices.size(), cache_size) * threshold;
+
+	std::vector<uint32_t> soft_cluster_starts;
+	{
+		std::vector<uint32_t> time_stamps(vertices.size(), 0U);
+		uint32_t time_stamp = 1U;
+
+		for (size_t cluster_idx = 0U; cluster_idx < cluster_starts.size(); cluster_idx++)
+		{
+			const auto cluster_end = cluster_idx + 1U < cluster_starts.size() ? cluster_starts.at(cluster_idx + 1U) : triangle_num;
+			auto cluster_start = cluster_starts.at(cluster_idx);
+			size_t miss_num = 0U;
+
+			soft_cluster_starts.emplace_back(cluster_start);
+			time_stamp += cache_size + 1U; // a new cluster starts with a cold cache
+
+			for (auto triangle = cluster_start; triangle < cluster_end; triangle++)
+			{
+				for (uint32_t corner = 0U; corner < 3U; corner++)
+					miss_num += touch_vertex(time_stamps, time_stamp, indices[3U * triangle + corner], cache_size);
+
+				const auto cluster_triangle_num = triangle + 1U - cluster_start;
+				if (triangle + 1U < cluster_end
+					&& static_cast<float_t>(miss_num) <= split_acmr * static_cast<float_t>(cluster_triangle_num))
+				{
+					cluster_start = triangle + 1U;
+					soft_cluster_starts.emplace_back(cluster_start);
+					miss_num = 0U;
+					time_stamp += cache_size + 1U;
+				}
+			}
+		}
+	}
+
+	const auto cluster_num = soft_cluster_starts.size();
+	std::vector<glm::vec3> cluster_centroids(cluster_num, glm::vec3(0.0f));
+	std::vector<glm::vec3> cluster_normals(cluster_num, glm::vec3(0.0f));
+	glm::vec3 mesh_centroid(0.0f);
+	float_t mesh_area = 0.0f;
+
+	for (size_t cluster_idx = 0U; cluster_idx < cluster_num; cluster_idx++)
+	{
+		const auto cluster_end = cluster_idx + 1U < cluster_num ? soft_cluster_starts.at(cluster_idx + 1U) : triangle_num;
+		float_t cluster_area = 0.0f;
+
+		for (auto triangle = soft_cluster_starts.at(cluster_idx); triangle < cluster_end; triangle++)
+		{
+			const auto& p0 = vertices[indices[3U * triangle + 0U]].pos;
+			const auto& p1 = vertices[indices[3U * triangle + 1U]].pos;
+			const auto& p2 = vertices[indices[3U * triangle + 2U]].pos;
+
+			const auto area_normal = glm::cross(p1 - p0, p2 - p0); // length: twice the area
+			const auto area = glm::length(area_normal);
+			const auto centroid = (p0 + p1 + p2) / 3.0f;
+
+			cluster_centroids.at(cluster_idx) += centroid * area;
+			cluster_normals.at(cluster_idx) += area_normal;
+			cluster_area += area;
+		}
+
+		mesh_centroid += cluster_centroids.at(cluster_idx);
+		mesh_area += cluster_area;
+
+		if (cluster_area > 0.0f)
+			cluster_centroids.at(cluster_idx) /= cluster_area;
+	}
+
+	if (mesh_area > 0.0f)
+		mesh_centroid /= mesh_area;
+
+	std::vector<float_t> sort_keys(cluster_num, 0.0f);
+	for (size_t cluster_idx = 0U; cluster_idx < cluster_num; cluster_idx++)
+	{
+		const auto normal_length = glm::length(cluster_normals.at(cluster_idx));
+		if (normal_length > 0.0f)
+			sort_keys.at(cluster_idx) =
+				glm::dot(cluster_centroids.at(cluster_idx) - mesh_centroid, cluster_normals.at(cluster_idx) / normal_length);
+	}
+
+	std::vector<uint32_t> cluster_order(cluster_num);
+	std::iota(cluster_order.begin(), cluster_order.end(), 0U);
+	std::stable_sort(cluster_order.begin(), cluster_order.end(),
+		[&sort_keys](const uint32_t& lhs, const uint32_t& rhs) { return sort_keys[lhs] > sort_keys[rhs]; });
+
+	std::vector<uint32_t> sorted_indices;
+	sorted_indices.reserve(indices.size());
+	for (const auto& cluster_idx : cluster_order)
+	{
+		const auto cluster_end = cluster_idx + 1U < cluster_num ? soft_cluster_starts.at(cluster_idx + 1U) : triangle_num;
+		sorted_indices.insert(sorted_indices.end(),
+			indices.begin() + 3U * soft_cluster_starts.at(cluster_idx), indices.begin() + 3U * cluster_end);
+	}
+
+	indices = std::move(sorted_indices);
+}
+
+void hephics::asset::mesh_optimizer::optimize_vertex_fetch(std::vector<VertexData>& vertices, std::vector<uint32_t>& indices)
+{
+	// vertices in order of first use, unreferenced ones are dropped
+	constexpr auto UNUSED = std::numeric_limits<uint32_t>::max();
+
+	std::vector<uint32_t> remap(vertices.size(), UNUSED);
+	std::vector<VertexData> fetch_ordered_vertices;
+	fetch_ordered_vertices.reserve(vertices.size());
+
+	for (auto& index : indices)
+	{
+		if (remap.at(index) == UNUSED)
+		{
+			remap.at(index) = static_cast<uint32_t>(fetch_ordered_vertices.size());
+			fetch_ordered_vertices.emplace_back(vertices.at(index));
+		}
+		index = remap.at(index);
+	}
+
+	vertices = std::move(fetch_ordered_vertices);
+}
+
+hephics::asset::mesh_optimizer::Report hephics::asset::mesh_optimizer::optimize(
+	std::vector<VertexData>& vertices, std::vector<uint32_t>& indices)
+{
+	Report report{};
+	report.acmr_before = compute_acmr(indices, vertices.size());
+
+	const auto cluster_starts = optimize_vertex_cache(indices, vertices.size());
+	optimize_overdraw(indices, vertices, cluster_starts);
+	optimize_vertex_fetch(vertices, indices);
+
+	report.acmr_after = compute_acmr(indices, vertices.size());
+	report.cluster_num = cluster_starts.size();
+
+	return report;
+}
+
+// symmetric 4x4 matrix of a set of weighted planes, accumulated in double for large meshes
+struct Quadric
+{
+	double_t a00, a11, a22, a10, a20, a21;
+	double_t b0, b1, b2;
+	double_t c;
+	double_t weight;
+};
+
+static Quadric make_plane_quadric(const glm::vec3& normal, const float_t& distance, const double_t& weight)
+{
+	const double_t nx = normal.x, ny = normal.y, nz = normal.z, d = distance;
+
+	return Quadric{ nx * nx * weight, ny * ny * weight, nz * nz * weight, ny * nx * weight, nz * nx * weight, nz * ny * weight,
+		nx * d * weight, ny * d * weight, nz * d * weight, d * d * weight, weight };
+}
+
+static void add_quadric(Quadric& dst, const Quadric& src)
+{
+	dst.a00 += src.a00; dst.a11 += src.a11; dst.a22 += src.a22;
+	dst.a10 += src.a10; dst.a20 += src.a20; dst.a21 += src.a21;
+	dst.b0 += src.b0; dst.b1 += src.b1; dst.b2 += src.b2;
+	dst.c += src.c;
+	dst.weight += src.weight;
+}
+
+// weighted mean squared distance of "point" to the planes
+static double_t evaluate_quadric(const Quadric& quadric, const glm::vec3& point)
+{
+	if (quadric.weight <= 0.0)
+		return 0.0;
+
+	const double_t x = point.x, y = point.y, z = point.z;
+	const auto error = quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z
+		+ 2.0 * (quadric.a10 * x * y + quadric.a20 * x * z + quadric.a21 * y * z)
+		+ 2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) + quadric.c;
+
+	return std::abs(error) / quadric.weight;
+}
+
+std::vector<uint32_t> hephics::asset::mesh_optimizer::simplify(const std::span<const uint32_t>& indices,
+	const std::span<const VertexData>& vertices, const size_t& target_index_num, const float_t& target_error,
+	float_t& result_error)
+{
+	// Garland and Heckbert 1997, restricted to collapses onto an existing vertex so the vertex data is shared
+	// by every level. Collapses run in passes of independent edges, each pass sorted by error.
+	constexpr auto UNUSED = std::numeric_limits<uint32_t>::max();
+	constexpr double_t BORDER_WEIGHT = 10.0;
+	constexpr float_t MIN_NORMAL_COSINE = 0.25f;
+
+	const auto vertex_num = vertices.size();
+	std::vector<uint32_t> simplified_indices(indices.begin(), indices.end());
+	result_error = 0.0f;
+
+	// vertices split by a texcoord or color seam share a position: collapses are decided per position,
+	// every copy then follows the edge it shares with a copy of the target
+	std::vector<uint32_t> position_ids(vertex_num);
+	{
+		hephics_helper::VertexDeduplicator<glm::vec3> position_deduplicator(vertex_num);
+		std::vector<uint32_t> first_vertex_ids;
+		for (size_t vertex_idx = 0U; vertex_idx < vertex_num; vertex_idx++)
+		{
+			// adding zero turns -0.0 into 0.0, the deduplicator compares bits
+			const auto position_idx = position_deduplicator.Insert(vertices[vertex_idx].pos + glm::vec3(0.0f));
+			if (position_idx == first_vertex_ids.size())
+				first_vertex_ids.emplace_back(static_cast<uint32_t>(vertex_idx));
+			position_ids.at(vertex_idx) = first_vertex_ids.at(position_idx);
+		}
+	}
+
+	std::vector<uint32_t> position_indices(simplified_indices.size());
+	const auto update_position_indices = [&]()
+		{
+			position_indices.resize(simplified_indices.size());
+			for (size_t corner_idx = 0U; corner_idx < simplified_indices.size(); corner_idx++)
+				position_indices[corner_idx] = position_ids[simplified_indices[corner_idx]];
+		};
+	update_position_indices();
+
+	// neighbors of "position" with the number of triangles sharing the edge: one on a border, more than two if non-manifold
+	std::vector<std::pair<uint32_t, uint32_t>> edge_counts;
+	const auto count_edges = [&](const MeshAdjacency& adjacency, const uint32_t& position)
+		{
+			edge_counts.clear();
+			for (auto adjacency_idx = adjacency.offsets[position]; adjacency_idx < adjacency.offsets[position + 1U]; adjacency_idx++)
+			{
+				const auto triangle = adjacency.triangles[adjacency_idx];
+				for (uint32_t corner = 0U; corner < 3U; corner++)
+				{
+					const auto neighbor = position_indices[3U * triangle + corner];
+					if (neighbor == position)
+						continue;
+
+					const auto found = std::find_if(edge_counts.begin(), edge_counts.end(),
+						[&neighbor](const auto& edge_count) { return edge_count.first == neighbor; });
+					if (found != edge_counts.end())
+						found->second++;
+					else
+						edge_counts.emplace_back(neighbor, 1U);
+				}
+			}
+		};
+
+	std::vector<Quadric> quadrics(vertex_num, Quadric{});
+	{
+		const auto adjacency = build_adjacency(position_indices, vertex_num);
+
+		for (size_t triangle = 0U; triangle < position_indices.size() / 3U; triangle++)
+		{
+			const uint32_t triangle_positions[3] = { position_indices[3U * triangle + 0U],
+				position_indices[3U * triangle + 1U], position_indices[3U * triangle + 2U] };
+			const auto& p0 = vertices[triangle_positions[0]].pos;
+			const auto& p1 = vertices[triangle_positions[1]].pos;
+			const auto& p2 = vertices[triangle_positions[2]].pos;
+
+			const auto area_normal = glm::cross(p1 - p0, p2 - p0);
+			const auto double_area = glm::length(area_normal);
+			if (double_area <= 0.0f)
+				continue;
+
+			const auto normal = area_normal / double_area;
+			const auto face_quadric = make_plane_quadric(normal, -glm::dot(normal, p0), 0.5 * double_area);
+			for (const auto& position : triangle_positions)
+				add_quadric(quadrics[position], face_quadric);
+
+			// a border edge also gets the plane through it perpendicular to the face, so the outline stays in place
+			for (uint32_t corner = 0U; corner < 3U; corner++)
+			{
+				const auto& position = triangle_positions[corner];
+				const auto& next_position = triangle_positions[(corner + 1U) % 3U];
+
+				count_edges(adjacency, position);
+				const auto found = std::find_if(edge_counts.begin(), edge_counts.end(),
+					[&next_position](const auto& edge_count) { return edge_count.first == next_position; });
+				if (found == edge_counts.end() || found->second != 1U)
+					continue;
+
+				const auto edge = vertices[next_position].pos - vertices[position].pos;
+				const auto edge_length = glm::length(edge);
+				if (edge_length <= 0.0f)
+					continue;
+
+				const auto border_normal = glm::cross(edge, normal) / edge_length;
+				const auto border_quadric = make_plane_quadric(border_normal, -glm::dot(border_normal, vertices[position].pos),
+					BORDER_WEIGHT * edge_length * edge_length);
+				add_quadric(quadrics[position], border_quadric);
+				add_quadric(quadrics[next_position], border_quadric);
+			}
+		}
+	}
+
+	struct Collapse
+	{
+		uint32_t position;
+		uint32_t target_position;
+		double_t error;
+	};
+
+	const auto max_error = static_cast<double_t>(target_error) * static_cast<double_t>(target_error);
+	double_t result_squared_error = 0.0;
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> vertex_targets(vertex_num, UNUSED);
+	std::vector<uint8_t> is_locked(vertex_num, 0U);
+
+	while (simplified_indices.size() > target_index_num)
+	{
+		const auto adjacency = build_adjacency(position_indices, vertex_num);
+
+		// a border position may only slide along its border, corners and non-manifold positions stay
+		collapses.clear();
+		for (uint32_t position = 0U; position < vertex_num; position++)
+		{
+			if (adjacency.offsets[position] == adjacency.offsets[position + 1U])
+				continue;
+
+			count_edges(adjacency, position);
+
+			size_t border_edge_num = 0U;
+			bool is_manifold = true;
+			for (const auto& [neighbor, edge_count] : edge_counts)
+			{
+				border_edge_num += edge_count == 1U;
+				is_manifold = is_manifold && edge_count <= 2U;
+			}
+			if (!is_manifold || (border_edge_num != 0U && border_edge_num != 2U))
+				continue;
+
+			for (const auto& [neighbor, edge_count] : edge_counts)
+			{
+				if (border_edge_num != 0U && edge_count != 1U)
+					continue;
+
+				const auto error = evaluate_quadric(quadrics[position], vertices[neighbor].pos);
+				if (error <= max_error)
+					collapses.push_back(Collapse{ position, neighbor, error });
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(),
+			[](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+		const auto target_triangle_num = target_index_num / 3U;
+		auto triangle_num = simplified_indices.size() / 3U;
+		size_t collapse_num = 0U;
+		std::fill(is_locked.begin(), is_locked.end(), 0U);
+
+		for (const auto& collapse : collapses)
+		{
+			if (triangle_num <= target_triangle_num)
+				break;
+
+			const auto& position = collapse.position;
+			const auto& target_position = collapse.target_position;
+			if (is_locked[position] || is_locked[target_position])
+				continue;
+
+			const auto triangle_begin = adjacency.offsets[position];
+			const auto triangle_end = adjacency.offsets[position + 1U];
+
+			// copies of "position" move to the copy of "target_position" they share a triangle with
+			bool is_valid = true;
+			size_t removed_triangle_num = 0U;
+			for (auto adjacency_idx = triangle_begin; adjacency_idx < triangle_end; adjacency_idx++)
+			{
+				const auto triangle = adjacency.triangles[adjacency_idx];
+
+				uint32_t corner = 0U, target_corner = UNUSED;
+				for (uint32_t triangle_corner = 0U; triangle_corner < 3U; triangle_corner++)
+				{
+					if (position_indices[3U * triangle + triangle_corner] == position)
+						corner = triangle_corner;
+					else if (position_indices[3U * triangle + triangle_corner] == target_position)
+						target_corner = triangle_corner;
+				}
+
+				if (target_corner != UNUSED)
+				{
+					auto& vertex_target = vertex_targets[simplified_indices[3U * triangle + corner]];
+					if (vertex_target == UNUSED)
+						vertex_target = simplified_indices[3U * triangle + target_corner];
+					removed_triangle_num++;
+					continue;
+				}
+
+				// reject collapses that fold a remaining triangle over
+				const auto& p0 = vertices[position_indices[3U * triangle + corner]].pos;
+				const auto& p1 = vertices[position_indices[3U * triangle + (corner + 1U) % 3U]].pos;
+				const auto& p2 = vertices[position_indices[3U * triangle + (corner + 2U) % 3U]].pos;
+				const auto& target_point = vertices[target_position].pos;
+
+				const auto normal = glm::cross(p1 - p0, p2 - p0);
+				const auto target_normal = glm::cross(p1 - target_point, p2 - target_point);
+				if (glm::dot(normal, target_normal) < MIN_NORMAL_COSINE * glm::length(normal) * glm::length(target_normal))
+					is_valid = false;
+			}
+
+			for (auto adjacency_idx = triangle_begin; is_valid && adjacency_idx < triangle_end; adjacency_idx++)
+			{
+				const auto triangle = adjacency.triangles[adjacency_idx];
+				for (uint32_t corner = 0U; corner < 3U; corner++)
+				{
+					if (position_indices[3U * triangle + corner] == position
+						&& vertex_targets[simplified_indices[3U * triangle + corner]] == UNUSED)
+						is_valid = false;
+				}
+			}
+
+			if (!is_valid)
+			{
+				for (auto adjacency_idx = triangle_begin; adjacency_idx < triangle_end; adjacency_idx++)
+				{
+					const auto triangle = adjacency.triangles[adjacency_idx];
+					for (uint32_t corner = 0U; corner < 3U; corner++)
+					{
+						if (position_indices[3U * triangle + corner] == position)
+							vertex_targets[simplified_indices[3U * triangle + corner]] = UNUSED;
+					}
+				}
+				continue;
+			}
+
+			// the one-ring changes shape: its positions wait for the next pass
+			for (auto adjacency_idx = triangle_begin; adjacency_idx < triangle_end; adjacency_idx++)
+			{
+				const auto triangle = adjacency.triangles[adjacency_idx];
+				for (uint32_t corner = 0U; corner < 3U; corner++)
+					is_locked[position_indices[3U * triangle + corner]] = 1U;
+			}
+
+			add_quadric(quadrics[target_position], quadrics[position]);
+			result_squared_error = std::max(result_squared_error, collapse.error);
+			triangle_num -= std::min(triangle_num, removed_triangle_num);
+			collapse_num++;
+		}
+
+		if (collapse_num == 0U)
+			break;
+
+		// apply the collapses and drop the triangles that lost an edge
+		size_t write_idx = 0U;
+		for (size_t corner_idx = 0U; corner_idx < simplified_indices.size(); corner_idx += 3U)
+		{
+			uint32_t triangle_vertices[3];
+			for (uint32_t corner = 0U; corner < 3U; corner++)
+			{
+				const auto& vertex = simplified_indices[corner_idx + corner];
+				triangle_vertices[corner] = vertex_targets[vertex] != UNUSED ? vertex_targets[vertex] : vertex;
+			}
+
+			const auto position0 = position_ids[triangle_vertices[0]];
+			const auto position1 = position_ids[triangle_vertices[1]];
+			const auto position2 = position_ids[triangle_vertices[2]];
+			if (position0 == position1 || position1 == position2 || position2 == position0)
+				continue;
+
+			for (uint32_t corner = 0U; corner < 3U; corner++)
+				simplified_indices[write_idx++] = triangle_vertices[corner];
+		}
+		simplified_indices.resize(write_idx);
+
+		std::fill(vertex_targets.begin(), vertex_targets.end(), UNUSED);
+		update_position_indices();
+	}
+
+	result_error = static_cast<float_t>(std::sqrt(result_squared_error));
+	return simplified_indices;
+}
+
+static void compute_meshlet_bounds(hephics::asset::Meshlet& meshlet, const std::span<const uint32_t>& meshlet_indices,
+	const std::span<const hephics::asset::VertexData>& vertices)
+{
+	hephics::asset::BoundingBox bounds;
+	for (const auto& index : meshlet_indices)
+		bounds.Expand(vertices[index].pos);
+
+	meshlet.center = bounds.GetCenter();
+	meshlet.radius = 0.0f;
+	for (const auto& index : meshlet_indices)
+		meshlet.radius = std::max(meshlet.radius, glm::length(vertices[index].pos - meshlet.center));
+
+	// normal cone: the meshlet faces away from every camera position inside the cone around -axis
+	std::vector<glm::vec3> normals;
+	glm::vec3 axis(0.0f);
+	for (size_t corner_idx = 0U; corner_idx + 2U < meshlet_indices.size(); corner_idx += 3U)
+	{
+		const auto& p0 = vertices[meshlet_indices[corner_idx + 0U]].pos;
+		const auto& p1 = vertices[meshlet_indices[corner_idx + 1U]].pos;
+		const auto& p2 = vertices[meshlet_indices[corner_idx + 2U]].pos;
+
+		const auto area_normal = glm::cross(p1 - p0, p2 - p0);
+		const auto double_area = glm::length(area_normal);
+		if (double_area <= 0.0f)
+			continue;
+
+		normals.emplace_back(area_normal / double_area);
+		axis += normals.back();
+	}
+
+	meshlet.cone_axis = glm::vec3(0.0f);
+	meshlet.cone_cutoff = 1.0f;
+
+	const auto axis_length = glm::length(axis);
+	if (axis_length <= 0.0f)
+		return;
+
+	axis /= axis_length;
+	auto min_cosine = 1.0f;
+	for (const auto& normal : normals)
+		min_cosine = std::min(min_cosine, glm::dot(axis, normal));
+
+	// wider than about 84 degrees the cone would hardly ever cull
+	if (min_cosine <= 0.1f)
+		return;
+
+	meshlet.cone_axis = axis;
+	meshlet.cone_cutoff = std::sqrt(1.0f - min_cosine * min_cosine);
+}
+
+std::vector<hephics::asset::Meshlet> hephics::asset::mesh_optimizer::build_meshlets(std::vector<uint32_t>& indices,
+	const std::span<const VertexData>& vertices)
+{
+	// grows every meshlet from its seed over shared edges, taking the triangle that adds the fewest vertices and
+	// then the one whose vertices have the fewest triangles left, so no small islands stay behind. The next seed
+	// is a leftover candidate, so neighboring meshlets stay close in the index buffer too
+	const auto triangle_num = indices.size() / 3U;
+	std::vector<Meshlet> meshlets;
+	if (triangle_num == 0U)
+		return meshlets;
+
+	auto adjacency = build_adjacency(indices, vertices.size());
+	auto& live_counts = adjacency.live_counts;
+
+	std::vector<uint8_t> is_emitted(triangle_num, 0U);
+	std::vector<uint32_t> vertex_stamps(vertices.size(), 0U); // meshlet number + 1 of the meshlet holding the vertex
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> meshlet_indices;
+	meshlet_indices.reserve(indices.size());
+
+	size_t seed_cursor = 0U;
+	size_t emitted_num = 0U;
+
+	while (emitted_num < triangle_num)
+	{
+		const auto stamp = static_cast<uint32_t>(meshlets.size() + 1U);
+		Meshlet meshlet{};
+		meshlet.first_index = static_cast<uint32_t>(meshlet_indices.size());
+
+		const auto count_new_vertices = [&](const uint32_t& triangle)
+			{
+				uint32_t new_vertex_num = 0U;
+				for (uint32_t corner = 0U; corner < 3U; corner++)
+				{
+					const auto& vertex = indices[3U * triangle + corner];
+					new_vertex_num += vertex_stamps[vertex] != stamp
+						&& (corner < 1U || indices[3U * triangle] != vertex)
+						&& (corner < 2U || indices[3U * triangle + 1U] != vertex);
+				}
+				return new_vertex_num;
+			};
+
+		const auto count_live_triangles = [&](const uint32_t& triangle)
+			{
+				return live_counts[indices[3U * triangle]] + live_counts[indices[3U * triangle + 1U]]
+					+ live_counts[indices[3U * triangle + 2U]];
+			};
+
+		const auto emit_triangle = [&](const uint32_t& triangle)
+			{
+				is_emitted[triangle] = 1U;
+				emitted_num++;
+
+				for (uint32_t corner = 0U; corner < 3U; corner++)
+				{
+					const auto& vertex = indices[3U * triangle + corner];
+					live_counts[vertex]--;
+					meshlet_indices.emplace_back(vertex);
+					if (vertex_stamps[vertex] == stamp)
+						continue;
+
+					vertex_stamps[vertex] = stamp;
+					meshlet.vertex_count++;
+					for (auto adjacency_idx = adjacency.offsets[vertex]; adjacency_idx < adjacency.offsets[vertex + 1U]; adjacency_idx++)
+					{
+						if (!is_emitted[adjacency.triangles[adjacency_idx]])
+							candidates.emplace_back(adjacency.triangles[adjacency_idx]);
+					}
+				}
+			};
+
+		int64_t seed = -1;
+		auto seed_live_num = std::numeric_limits<uint32_t>::max();
+		for (const auto& candidate : candidates)
+		{
+			if (!is_emitted[candidate] && count_live_triangles(candidate) < seed_live_num)
+			{
+				seed = candidate;
+				seed_live_num = count_live_triangles(candidate);
+			}
+		}
+		if (seed < 0)
+		{
+			while (is_emitted[seed_cursor])
+				seed_cursor++;
+			seed = static_cast<int64_t>(seed_cursor);
+		}
+
+		candidates.clear();
+		emit_triangle(static_cast<uint32_t>(seed));
+
+		for (uint32_t meshlet_triangle_num = 1U; meshlet_triangle_num < MESHLET_MAX_TRIANGLE_NUM; meshlet_triangle_num++)
+		{
+			int64_t best_triangle = -1;
+			auto best_new_vertex_num = std::numeric_limits<uint32_t>::max();
+			auto best_live_num = std::numeric_limits<uint32_t>::max();
+
+			for (size_t candidate_idx = 0U; candidate_idx < candidates.size();)
+			{
+				const auto candidate = candidates[candidate_idx];
+				if (is_emitted[candidate])
+				{
+					candidates[candidate_idx] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
+
+				const auto new_vertex_num = count_new_vertices(candidate);
+				const auto live_num = count_live_triangles(candidate);
+				if (meshlet.vertex_count + new_vertex_num <= MESHLET_MAX_VERTEX_NUM
+					&& (new_vertex_num < best_new_vertex_num || (new_vertex_num == best_new_vertex_num && live_num < best_live_num)))
+				{
+					best_triangle = candidate;
+					best_new_vertex_num = new_vertex_num;
+					best_live_num = live_num;
+				}
+				candidate_idx++;
+			}
+
+			if (best_triangle < 0)
+				break;
+
+			emit_triangle(static_cast<uint32_t>(best_triangle));
+		}
+
+		meshlet.index_count = static_cast<uint32_t>(meshlet_indices.size()) - meshlet.first_index;
+		compute_meshlet_bounds(meshlet,
+			std::span(meshlet_indices).subspan(meshlet.first_index, meshlet.index_count), vertices);
+		meshlets.emplace_back(meshlet);
+	}
+
+	indices = std::move(meshlet_indices);
+	return meshlets;
+}
\ No newline at end of file
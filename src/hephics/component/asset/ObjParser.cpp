@@ -0,0 +1,477 @@
+#include "../../Hephics.hpp"
+
+using ObjIndex = hephics::asset::obj_parser::Index;
+
+static constexpr size_t OBJ_MIN_CHUNK_SIZE = 1U << 20;
+static constexpr size_t OBJ_CHUNKS_PER_WORKER = 8U;
+
+static constexpr uint8_t OBJ_RELATIVE_VERTEX = 1U << 0;
+static constexpr uint8_t OBJ_RELATIVE_TEXCOORD = 1U << 1;
+static constexpr uint8_t OBJ_RELATIVE_NORMAL = 1U << 2;
+
+struct ObjMaterialSwitch
+{
+	size_t triangle_idx;
+	std::string name;
+	int32_t material_id = -1;
+};
+
+struct ObjMaterialState
+{
+	std::unordered_map<std::string, int32_t> material_id_map;
+	int32_t current_material_id = -1;
+};
+
+struct ObjChunk
+{
+	const char* begin = nullptr;
+	const char* end = nullptr;
+	std::vector<float_t> positions;
+	std::vector<float_t> texcoords;
+	size_t normal_num = 0U; // normals are only counted, faces may still refer to them
+	std::vector<ObjIndex> indices;
+	std::vector<uint8_t> relative_flags; // negative OBJ indices, resolved against the chunk-local counts
+	std::vector<ObjMaterialSwitch> material_switches;
+	std::string material_library;
+};
+
+static inline bool is_space(const char& c)
+{
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool is_digit(const char& c)
+{
+	return static_cast<uint32_t>(c - '0') < 10U;
+}
+
+static inline void skip_space(const char*& ptr, const char* const end)
+{
+	while (ptr < end && is_space(*ptr))
+		ptr++;
+}
+
+static inline bool match_keyword(const char* ptr, const char* const end, const std::string_view& keyword)
+{
+	if (static_cast<size_t>(end - ptr) <= keyword.size())
+		return false;
+
+	return std::string_view(ptr, keyword.size()) == keyword && is_space(ptr[keyword.size()]);
+}
+
+static inline bool parse_int(const char*& ptr, const char* const end, int32_t& value)
+{
+	auto cursor = ptr;
+	const auto is_negative = cursor < end && *cursor == '-';
+	if (cursor < end && (*cursor == '-' || *cursor == '+'))
+		cursor++;
+
+	if (cursor >= end || !is_digit(*cursor))
+		return false;
+
+	int32_t result = 0;
+	while (cursor < end && is_digit(*cursor))
+		result = result * 10 + (*cursor++ - '0');
+
+	value = is_negative ? -result : result;
+	ptr = cursor;
+	return true;
+}
+
+static std::string_view read_rest_of_line(const char* ptr, const char* const end)
+{
+	skip_space(ptr, end);
+
+	auto last = end;
+	while (last > ptr && is_space(*(last - 1)))
+		last--;
+
+	return std::string_view(ptr, static_cast<size_t>(last - ptr));
+}
+
+static void parse_floats(const char*& ptr, const char* const end, float_t* const values, const size_t& max_num)
+{
+	for (size_t idx = 0U; idx < max_num; idx++)
+	{
+		skip_space(ptr, end);
+		if (!hephics::asset::obj_parser::parse_float(ptr, end, values[idx]))
+			return;
+	}
+}
+
+// stores a raw OBJ index: positive values are absolute, negative ones count back from the current element
+static inline void resolve_index(const int32_t& raw_index, const size_t& local_count,
+	int32_t& index, uint8_t& relative_flags, const uint8_t& relative_bit)
+{
+	if (raw_index > 0)
+		index = raw_index - 1;
+	else if (raw_index < 0)
+	{
+		index = static_cast<int32_t>(local_count) + raw_index;
+		relative_flags |= relative_bit;
+	}
+	else
+		throw std::runtime_error("obj: index 0 is not allowed");
+}
+
+static void parse_face(ObjChunk& chunk, const char* ptr, const char* const end,
+	std::vector<std::pair<ObjIndex, uint8_t>>& polygon)
+{
+	polygon.clear();
+
+	while (true)
+	{
+		skip_space(ptr, end);
+		if (ptr >= end)
+			break;
+
+		ObjIndex index{};
+		uint8_t relative_flags = 0U;
+		int32_t raw_index = 0;
+
+		if (!parse_int(ptr, end, raw_index))
+			break;
+		resolve_index(raw_index, chunk.positions.size() / 3U, index.vertex_index, relative_flags, OBJ_RELATIVE_VERTEX);
+
+		if (ptr < end && *ptr == '/')
+		{
+			ptr++;
+			if (parse_int(ptr, end, raw_index))
+				resolve_index(raw_index, chunk.texcoords.size() / 2U,
+					index.texcoord_index, relative_flags, OBJ_RELATIVE_TEXCOORD);
+
+			if (ptr < end && *ptr == '/')
+			{
+				ptr++;
+				if (parse_int(ptr, end, raw_index))
+					resolve_index(raw_index, chunk.normal_num,
+						index.normal_index, relative_flags, OBJ_RELATIVE_NORMAL);
+			}
+		}
+
+		polygon.emplace_back(index, relative_flags);
+
+		while (ptr < end && !is_space(*ptr)) // unknown trailing syntax of this corner
+			ptr++;
+	}
+
+	for (size_t corner_idx = 1U; corner_idx + 1U < polygon.size(); corner_idx++)
+	{
+		for (const auto& polygon_idx : { size_t(0U), corner_idx, corner_idx + 1U })
+		{
+			chunk.indices.emplace_back(polygon.at(polygon_idx).first);
+			chunk.relative_flags.emplace_back(polygon.at(polygon_idx).second);
+		}
+	}
+}
+
+static void parse_chunk(ObjChunk& chunk)
+{
+	std::vector<std::pair<ObjIndex, uint8_t>> polygon;
+
+	auto ptr = chunk.begin;
+	while (ptr < chunk.end)
+	{
+		auto line_end = static_cast<const char*>(std::memchr(ptr, '\n', static_cast<size_t>(chunk.end - ptr)));
+		if (line_end == nullptr)
+			line_end = chunk.end;
+
+		skip_space(ptr, line_end);
+
+		if (match_keyword(ptr, line_end, "v"))
+		{
+			float_t values[3] = { 0.0f, 0.0f, 0.0f };
+			ptr += 1;
+			parse_floats(ptr, line_end, values, 3U);
+			chunk.positions.insert(chunk.positions.end(), values, values + 3);
+		}
+		else if (match_keyword(ptr, line_end, "vt"))
+		{
+			float_t values[2] = { 0.0f, 0.0f };
+			ptr += 2;
+			parse_floats(ptr, line_end, values, 2U);
+			chunk.texcoords.insert(chunk.texcoords.end(), values, values + 2);
+		}
+		else if (match_keyword(ptr, line_end, "vn"))
+			chunk.normal_num++;
+		else if (match_keyword(ptr, line_end, "f"))
+			parse_face(chunk, ptr + 1, line_end, polygon);
+		else if (match_keyword(ptr, line_end, "usemtl"))
+			chunk.material_switches.push_back(ObjMaterialSwitch{ chunk.indices.size() / 3U,
+				std::string(read_rest_of_line(ptr + 6, line_end)) });
+		else if (match_keyword(ptr, line_end, "mtllib") && chunk.material_library.empty())
+			chunk.material_library = read_rest_of_line(ptr + 6, line_end);
+
+		ptr = line_end + 1;
+	}
+}
+
+std::string hephics::asset::obj_parser::find_material_library(const std::string_view& obj_text)
+{
+	auto ptr = obj_text.data();
+	const auto end = obj_text.data() + obj_text.size();
+	while (ptr < end)
+	{
+		auto line_end = static_cast<const char*>(std::memchr(ptr, '\n', static_cast<size_t>(end - ptr)));
+		if (line_end == nullptr)
+			line_end = end;
+
+		skip_space(ptr, line_end);
+		if (match_keyword(ptr, line_end, "mtllib"))
+			return std::string(read_rest_of_line(ptr + 6, line_end));
+
+		ptr = line_end + 1;
+	}
+
+	return {};
+}
+
+bool hephics::asset::obj_parser::parse_float(const char*& ptr, const char* const end, float_t& value)
+{
+	// exactly representable powers of ten: mantissa * 10^exponent is exact in double within this range
+	static constexpr double POWERS_OF_TEN[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	static constexpr uint64_t MAX_EXACT_MANTISSA = 1ULL << 53;
+
+	auto cursor = ptr;
+	const auto is_negative = cursor < end && *cursor == '-';
+	if (cursor < end && (*cursor == '-' || *cursor == '+'))
+		cursor++;
+	const auto number_begin = cursor;
+
+	uint64_t mantissa = 0U;
+	int32_t exponent = 0;
+	int32_t significant_digit_num = 0;
+	int32_t digit_num = 0;
+
+	while (cursor < end && is_digit(*cursor))
+	{
+		mantissa = mantissa * 10U + static_cast<uint64_t>(*cursor - '0');
+		significant_digit_num += mantissa != 0U;
+		digit_num++;
+		cursor++;
+	}
+
+	if (cursor < end && *cursor == '.')
+	{
+		cursor++;
+		while (cursor < end && is_digit(*cursor))
+		{
+			mantissa = mantissa * 10U + static_cast<uint64_t>(*cursor - '0');
+			significant_digit_num += mantissa != 0U;
+			digit_num++;
+			exponent--;
+			cursor++;
+		}
+	}
+
+	if (digit_num > 0 && cursor < end && (*cursor == 'e' || *cursor == 'E'))
+	{
+		auto exponent_cursor = cursor + 1;
+		int32_t explicit_exponent = 0;
+		if (parse_int(exponent_cursor, end, explicit_exponent))
+		{
+			exponent += explicit_exponent;
+			cursor = exponent_cursor;
+		}
+	}
+
+	const auto is_fast_path = digit_num > 0 && significant_digit_num <= 19
+		&& mantissa <= MAX_EXACT_MANTISSA && exponent >= -22 && exponent <= 22;
+
+	if (is_fast_path)
+	{
+		auto result = static_cast<double>(mantissa);
+		if (exponent < 0)
+			result /= POWERS_OF_TEN[-exponent];
+		else
+			result *= POWERS_OF_TEN[exponent];
+
+		value = static_cast<float_t>(is_negative ? -result : result);
+		ptr = cursor;
+		return true;
+	}
+
+	// long mantissas, large exponents, inf and nan
+	float_t result = 0.0f;
+	const auto [ptr_parsed, error_code] = std::from_chars(number_begin, end, result, std::chars_format::general);
+	if (error_code == std::errc::result_out_of_range)
+		result = exponent > 0 ? std::numeric_limits<float_t>::infinity() : 0.0f;
+	else if (error_code != std::errc())
+		return false;
+
+	value = is_negative ? -result : result;
+	ptr = ptr_parsed;
+	return true;
+}
+
+// appends the attributes of [data, data + data_size) to "result" and replaces its faces with the ones of this range
+static void parse_window(const char* const data, const size_t& data_size,
+	hephics::asset::obj_parser::ParseResult& result, ObjMaterialState& material_state)
+{
+	const auto max_chunk_num = (static_cast<size_t>(hephics_helper::WorkerPool::GetWorkerNum()) + 1U) * OBJ_CHUNKS_PER_WORKER;
+	const auto chunk_num = std::clamp(data_size / OBJ_MIN_CHUNK_SIZE, size_t(1U), max_chunk_num);
+
+	std::vector<ObjChunk> chunks(chunk_num);
+	{
+		auto chunk_begin = data;
+		for (size_t chunk_idx = 0U; chunk_idx < chunk_num; chunk_idx++)
+		{
+			auto chunk_end = data + data_size * (chunk_idx + 1U) / chunk_num;
+			if (chunk_end < chunk_begin)
+				chunk_end = chunk_begin;
+
+			if (chunk_idx + 1U < chunk_num)
+			{
+				auto ptr_newline = static_cast<const char*>(
+					std::memchr(chunk_end, '\n', static_cast<size_t>(data + data_size - chunk_end)));
+				chunk_end = ptr_newline != nullptr ? ptr_newline + 1 : data + data_size;
+			}
+			else
+				chunk_end = data + data_size;
+
+			chunks.at(chunk_idx).begin = chunk_begin;
+			chunks.at(chunk_idx).end = chunk_end;
+			chunk_begin = chunk_end;
+		}
+	}
+
+	hephics_helper::WorkerPool::ParallelFor(chunk_num, [&](const size_t& chunk_idx) { parse_chunk(chunks.at(chunk_idx)); });
+
+	// prefix sums: where each chunk lands in the merged arrays, attributes of earlier windows are kept
+	std::vector<size_t> position_offsets(chunk_num + 1U, result.positions.size());
+	std::vector<size_t> texcoord_offsets(chunk_num + 1U, result.texcoords.size());
+	std::vector<size_t> normal_offsets(chunk_num + 1U, result.normal_num);
+	std::vector<size_t> index_offsets(chunk_num + 1U, 0U);
+	std::vector<int32_t> inherited_material_ids(chunk_num, -1);
+
+	for (size_t chunk_idx = 0U; chunk_idx < chunk_num; chunk_idx++)
+	{
+		auto& chunk = chunks.at(chunk_idx);
+
+		position_offsets.at(chunk_idx + 1U) = position_offsets.at(chunk_idx) + chunk.positions.size();
+		texcoord_offsets.at(chunk_idx + 1U) = texcoord_offsets.at(chunk_idx) + chunk.texcoords.size();
+		normal_offsets.at(chunk_idx + 1U) = normal_offsets.at(chunk_idx) + chunk.normal_num;
+		index_offsets.at(chunk_idx + 1U) = index_offsets.at(chunk_idx) + chunk.indices.size();
+
+		// "usemtl" holds across chunk borders: a chunk starts with the last material of its predecessor
+		inherited_material_ids.at(chunk_idx) = material_state.current_material_id;
+		for (auto& material_switch : chunk.material_switches)
+		{
+			auto [material_itr, is_inserted] = material_state.material_id_map.try_emplace(
+				material_switch.name, static_cast<int32_t>(result.material_names.size()));
+			if (is_inserted)
+				result.material_names.emplace_back(material_switch.name);
+
+			material_switch.material_id = material_itr->second;
+			material_state.current_material_id = material_switch.material_id;
+		}
+
+		if (result.material_library.empty())
+			result.material_library = chunk.material_library;
+	}
+
+	result.positions.resize(position_offsets.back());
+	result.texcoords.resize(texcoord_offsets.back());
+	result.normal_num = normal_offsets.back();
+	result.indices.resize(index_offsets.back());
+	result.material_ids.resize(index_offsets.back() / 3U);
+
+	const auto position_num = static_cast<int32_t>(result.positions.size() / 3U);
+	const auto texcoord_num = static_cast<int32_t>(result.texcoords.size() / 2U);
+	const auto normal_num = static_cast<int32_t>(result.normal_num);
+
+	hephics_helper::WorkerPool::ParallelFor(chunk_num, [&](const size_t& chunk_idx)
+		{
+			auto& chunk = chunks.at(chunk_idx);
+
+			std::copy(chunk.positions.begin(), chunk.positions.end(),
+				result.positions.begin() + position_offsets.at(chunk_idx));
+			std::copy(chunk.texcoords.begin(), chunk.texcoords.end(),
+				result.texcoords.begin() + texcoord_offsets.at(chunk_idx));
+
+			const auto vertex_base = static_cast<int32_t>(position_offsets.at(chunk_idx) / 3U);
+			const auto texcoord_base = static_cast<int32_t>(texcoord_offsets.at(chunk_idx) / 2U);
+			const auto normal_base = static_cast<int32_t>(normal_offsets.at(chunk_idx));
+
+			auto ptr_dst_index = result.indices.data() + index_offsets.at(chunk_idx);
+			for (size_t idx = 0U; idx < chunk.indices.size(); idx++)
+			{
+				auto index = chunk.indices.at(idx);
+				const auto& relative_flags = chunk.relative_flags.at(idx);
+
+				if (relative_flags & OBJ_RELATIVE_VERTEX)
+					index.vertex_index += vertex_base;
+				if (relative_flags & OBJ_RELATIVE_TEXCOORD)
+					index.texcoord_index += texcoord_base;
+				if (relative_flags & OBJ_RELATIVE_NORMAL)
+					index.normal_index += normal_base;
+
+				if (index.vertex_index < 0 || index.vertex_index >= position_num
+					|| index.texcoord_index < -1 || index.texcoord_index >= texcoord_num
+					|| index.normal_index < -1 || index.normal_index >= normal_num)
+					throw std::runtime_error("obj: index out of range");
+
+				ptr_dst_index[idx] = index;
+			}
+
+			const auto triangle_base = index_offsets.at(chunk_idx) / 3U;
+			const auto triangle_num = chunk.indices.size() / 3U;
+			auto material_id = inherited_material_ids.at(chunk_idx);
+			size_t switch_idx = 0U;
+			for (size_t triangle_idx = 0U; triangle_idx < triangle_num; triangle_idx++)
+			{
+				while (switch_idx < chunk.material_switches.size()
+					&& chunk.material_switches.at(switch_idx).triangle_idx <= triangle_idx)
+					material_id = chunk.material_switches.at(switch_idx++).material_id;
+
+				result.material_ids.at(triangle_base + triangle_idx) = material_id;
+			}
+
+			// release chunk memory as soon as it is merged
+			chunk = ObjChunk();
+		});
+}
+
+hephics::asset::obj_parser::ParseResult hephics::asset::obj_parser::parse(const std::string& path)
+{
+	hephics_helper::MappedFile obj_file(path);
+	ParseResult result;
+	ObjMaterialState material_state;
+
+	if (obj_file.GetSize() > 0U)
+		parse_window(reinterpret_cast<const char*>(obj_file.GetData()), obj_file.GetSize(), result, material_state);
+
+	return result;
+}
+
+void hephics::asset::obj_parser::parse_streaming(const std::string& path, const size_t& window_size,
+	const std::function<void(const ParseResult&)>& on_window)
+{
+	hephics_helper::MappedFile obj_file(path);
+	ParseResult result;
+	ObjMaterialState material_state;
+
+	const auto data = reinterpret_cast<const char*>(obj_file.GetData());
+	const auto data_end = data + obj_file.GetSize();
+
+	auto window_begin = data;
+	while (window_begin < data_end)
+	{
+		auto window_end = window_begin + std::min(std::max(window_size, size_t(1U)), static_cast<size_t>(data_end - window_begin));
+		if (window_end < data_end)
+		{
+			auto ptr_newline = static_cast<const char*>(
+				std::memchr(window_end, '\n', static_cast<size_t>(data_end - window_end)));
+			window_end = ptr_newline != nullptr ? ptr_newline + 1 : data_end;
+		}
+
+		parse_window(window_begin, static_cast<size_t>(window_end - window_begin), result, material_state);
+		on_window(result);
+
+		window_begin = window_end;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "../../Hephics.hpp"
+
+using TextureAtlas = hephics::asset::TextureAtlas;
+
+struct AtlasPlacement
+{
+	uint32_t layer = 0U;
+	uint32_t x = 0U;
+	uint32_t y = 0U;
+};
+
+struct AtlasShelf
+{
+	uint32_t layer;
+	uint32_t y;
+	uint32_t height;
+	uint32_t used_width;
+};
+
+// a cell is the image with PADDING on every side, rounded up to PADDING, so every cell starts and ends on
+// a texel boundary of the coarsest level
+static uint32_t get_cell_size(const int32_t& image_size)
+{
+	const auto padded_size = static_cast<uint32_t>(image_size) + 2U * TextureAtlas::PADDING;
+	return (padded_size + TextureAtlas::PADDING - 1U) / TextureAtlas::PADDING * TextureAtlas::PADDING;
+}
+
+// shelf packing, tallest first: every shelf is as tall as its first cell, a cell goes to the first shelf it
+// fits, else opens a shelf below the last one, else a new layer; "layer_extent" bounds every used cell
+static std::vector<AtlasPlacement> pack_cells(const std::vector<std::pair<uint32_t, uint32_t>>& cell_sizes,
+	uint32_t& layer_num, vk::Extent2D& layer_extent)
+{
+	std::vector<size_t> cell_order(cell_sizes.size());
+	std::iota(cell_order.begin(), cell_order.end(), 0U);
+	std::stable_sort(cell_order.begin(), cell_order.end(), [&cell_sizes](const size_t& lhs, const size_t& rhs)
+		{
+			if (cell_sizes.at(lhs).second != cell_sizes.at(rhs).second)
+				return cell_sizes.at(lhs).second > cell_sizes.at(rhs).second;
+			return cell_sizes.at(lhs).first > cell_sizes.at(rhs).first;
+		});
+
+	std::vector<AtlasPlacement> placements(cell_sizes.size());
+	std::vector<AtlasShelf> shelves;
+	std::vector<uint32_t> layer_heights; // used height of every layer
+
+	for (const auto& cell_idx : cell_order)
+	{
+		const auto& [cell_width, cell_height] = cell_sizes.at(cell_idx);
+
+		auto shelf_it = std::find_if(shelves.begin(), shelves.end(), [&](const AtlasShelf& shelf)
+			{
+				return shelf.height >= cell_height && shelf.used_width + cell_width <= TextureAtlas::LAYER_SIZE;
+			});
+
+		if (shelf_it == shelves.end())
+		{
+			if (layer_heights.empty() || layer_heights.back() + cell_height > TextureAtlas::LAYER_SIZE)
+				layer_heights.push_back(0U);
+
+			const auto layer = static_cast<uint32_t>(layer_heights.size() - 1U);
+			shelves.push_back(AtlasShelf{ layer, layer_heights.back(), cell_height, 0U });
+			layer_heights.back() += cell_height;
+			shelf_it = std::prev(shelves.end());
+		}
+
+		placements.at(cell_idx) = AtlasPlacement{ shelf_it->layer, shelf_it->used_width, shelf_it->y };
+		shelf_it->used_width += cell_width;
+		layer_extent.width = std::max(layer_extent.width, shelf_it->used_width);
+	}
+
+	layer_num = static_cast<uint32_t>(layer_heights.size());
+	layer_extent.height = *std::max_element(layer_heights.begin(), layer_heights.end());
+	return placements;
+}
+
+TextureAtlas::TextureAtlas(const std::vector<std::pair<std::string, std::shared_ptr<cv::Mat>>>& images)
+{
+	if (images.empty())
+		throw std::runtime_error("texture_atlas: no images");
+
+	std::vector<std::pair<uint32_t, uint32_t>> cell_sizes;
+	for (const auto& [image_key, ptr_image] : images)
+	{
+		if (!IsPackable(*ptr_image))
+			throw std::runtime_error(std::format("texture_atlas: {} is not a small RGBA8 image", image_key));
+
+		cell_sizes.emplace_back(get_cell_size(ptr_image->cols), get_cell_size(ptr_image->rows));
+	}
+
+	const auto placements = pack_cells(cell_sizes, m_layerNum, m_layerExtent);
+
+	m_levels.resize(m_layerNum * MIP_NUM);
+	for (uint32_t layer_idx = 0U; layer_idx < m_layerNum; layer_idx++)
+		m_levels.at(layer_idx * MIP_NUM) = cv::Mat::zeros(m_layerExtent.height, m_layerExtent.width, CV_8UC4);
+
+	// cells never overlap, so they are written in parallel
+	hephics_helper::WorkerPool::ParallelFor(images.size(), [&](const size_t& image_idx)
+		{
+			const auto& image = *images.at(image_idx).second;
+			const auto& placement = placements.at(image_idx);
+			const auto& [cell_width, cell_height] = cell_sizes.at(image_idx);
+
+			// the edge is repeated into the padding, bilinear taps and coarse levels only ever see the image
+			const auto bottom_padding = static_cast<int32_t>(cell_height - PADDING) - image.rows;
+			const auto right_padding = static_cast<int32_t>(cell_width - PADDING) - image.cols;
+			auto cell = m_levels.at(placement.layer * MIP_NUM)(cv::Rect(placement.x, placement.y, cell_width, cell_height));
+			cv::copyMakeBorder(image, cell, PADDING, bottom_padding, PADDING, right_padding, cv::BORDER_REPLICATE);
+		});
+
+	// halving a cell aligned to PADDING only averages texels of that cell, in linear space like the blits of
+	// a Texture
+	hephics_helper::WorkerPool::ParallelFor(m_layerNum, [&](const size_t& layer_idx)
+		{
+			for (uint32_t mip_idx = 1U; mip_idx < MIP_NUM; mip_idx++)
+			{
+				const cv::Size level_size(static_cast<int32_t>(m_layerExtent.width >> mip_idx),
+					static_cast<int32_t>(m_layerExtent.height >> mip_idx));
+				m_levels.at(layer_idx * MIP_NUM + mip_idx) =
+					hephics::asset::Texture::ResizeSrgb(m_levels.at(layer_idx * MIP_NUM + mip_idx - 1U), level_size);
+			}
+		});
+
+	for (size_t image_idx = 0U; image_idx < images.size(); image_idx++)
+	{
+		const auto& [image_key, ptr_image] = images.at(image_idx);
+		const auto& placement = placements.at(image_idx);
+
+		m_regions.emplace(image_key, AtlasRegion{ placement.layer,
+			glm::vec4(placement.x + PADDING, placement.y + PADDING, ptr_image->cols, ptr_image->rows)
+				/ glm::vec4(m_layerExtent.width, m_layerExtent.height, m_layerExtent.width, m_layerExtent.height) });
+	}
+
+	for (const auto& level : m_levels)
+		m_residentSize += level.total() * level.elemSize();
+
+#ifdef _DEBUG
+	std::cout << std::format("texture_atlas: {} images in {} layers of {}x{}\n", images.size(), m_layerNum,
+		m_layerExtent.width, m_layerExtent.height);
+#endif
+
+	CreateImage();
+}
+
+void TextureAtlas::CreateImage()
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+
+	m_ptrImage = std::make_shared<vk_interface::component::Image>();
+	auto image_create_info = hephics_helper::simple_create_info::get_texture_image_info(
+		gpu_instance, m_layerExtent);
+	image_create_info.setMipLevels(MIP_NUM);
+	image_create_info.setArrayLayers(m_layerNum);
+	m_ptrImage->SetImage(logical_device, image_create_info);
+
+	const auto memory_requirements = logical_device->getImageMemoryRequirements(m_ptrImage->GetImage().get());
+	const auto memory_type_idx =
+		gpu_instance->FindMemoryType(memory_requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+	vk::MemoryAllocateInfo alloc_info(memory_requirements.size, memory_type_idx);
+	m_ptrImage->SetMemory(logical_device, alloc_info);
+
+	m_ptrImage->BindMemory(logical_device);
+
+	auto view_create_info = hephics_helper::simple_create_info::get_texture_image_view_info(m_ptrImage->GetImage());
+	view_create_info.setViewType(vk::ImageViewType::e2DArray);
+	view_create_info.subresourceRange.setLevelCount(MIP_NUM);
+	view_create_info.subresourceRange.setLayerCount(m_layerNum);
+	m_ptrImage->SetImageView(logical_device, view_create_info);
+
+	// regions do not repeat, a wrapped coordinate would sample the neighbour
+	auto sampler_create_info = hephics_helper::simple_create_info::get_texture_sampler_info(gpu_instance);
+	sampler_create_info.setAddressModeU(vk::SamplerAddressMode::eClampToEdge);
+	sampler_create_info.setAddressModeV(vk::SamplerAddressMode::eClampToEdge);
+	sampler_create_info.setAddressModeW(vk::SamplerAddressMode::eClampToEdge);
+	sampler_create_info.setMinLod(0.0f);
+	sampler_create_info.setMaxLod(static_cast<float_t>(MIP_NUM - 1U));
+	m_sampler = logical_device->createSamplerUnique(sampler_create_info);
+}
+
+void TextureAtlas::CopyTexture()
+{
+	if (m_isTextureCopied)
+		return;
+
+	const auto& gpu_instance = GPUHandler::GetInstance();
+
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	const auto& command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
+
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, m_residentSize);
+	auto staging_map_address = static_cast<std::byte*>(staging_buffer->Mapping(logical_device));
+
+	std::vector<vk::BufferImageCopy> image_copy_regions;
+	size_t level_offset = 0U;
+	for (uint32_t layer_idx = 0U; layer_idx < m_layerNum; layer_idx++)
+	{
+		for (uint32_t mip_idx = 0U; mip_idx < MIP_NUM; mip_idx++)
+		{
+			const auto& level = m_levels.at(layer_idx * MIP_NUM + mip_idx);
+			const auto level_size = level.total() * level.elemSize();
+			std::memcpy(staging_map_address + level_offset, level.data, level_size);
+
+			image_copy_regions.emplace_back(level_offset, 0, 0,
+				vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mip_idx, layer_idx, 1),
+				vk::Offset3D(0, 0, 0), vk::Extent3D(level.cols, level.rows, 1U));
+			level_offset += level_size;
+		}
+	}
+	staging_buffer->Unmapping(logical_device);
+
+	command_buffer->TransitionImageCommandLayout(m_ptrImage, vk::Format::eR8G8B8A8Srgb,
+		{ vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal }, MIP_NUM, m_layerNum);
+	command_buffer->GetCommandBuffer()->copyBufferToImage(staging_buffer->GetBuffer().get(),
+		m_ptrImage->GetImage().get(), vk::ImageLayout::eTransferDstOptimal, image_copy_regions);
+	command_buffer->TransitionImageCommandLayout(m_ptrImage, vk::Format::eR8G8B8A8Srgb,
+		{ vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal }, MIP_NUM, m_layerNum);
+
+	auto& staging_buffers = Scene::GetStagingBuffers();
+	staging_buffers.emplace_back(std::move(staging_buffer));
+
+	m_levels.clear();
+	m_isTextureCopied = true;
+}
+
+const hephics::asset::AtlasRegion& TextureAtlas::GetRegion(const std::string& key) const
+{
+	const auto region_it = m_regions.find(key);
+	if (region_it == m_regions.end())
+		throw std::runtime_error(std::format("texture_atlas: {} is not packed", key));
+
+	return region_it->second;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "../../Hephics.hpp"
+
+void hephics::culling::MeshletCuller::LoadData()
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	auto& copy_command_buffer = gpu_instance->GetGraphicCommandBuffer("copy");
+	auto& ref_descriptor_set = m_ptrComputingSystem->GetDescriptorSet();
+
+	const auto& meshlets = m_ptrAsset3D->GetMeshlets();
+	if (meshlets.empty())
+		throw std::runtime_error("meshlet_culler: asset has no meshlets");
+
+	const size_t meshlet_buffer_size = sizeof(asset::Meshlet) * meshlets.size();
+	const size_t draw_command_buffer_size = sizeof(vk::DrawIndexedIndirectCommand) * meshlets.size();
+
+	vk_interface::component::ShaderProvider::AddShader(logical_device, "comp/meshlet_cull.comp", "meshlet_cull");
+	ref_descriptor_set->SetDescriptorSetLayout(logical_device, vk_interface::component::ShaderProvider::GetLayoutBindings(
+		{ vk_interface::component::ShaderProvider::GetShader("comp", "meshlet_cull") }));
+	ref_descriptor_set->SetDescriptorPool(logical_device, hephics::BUFFERING_FRAME_NUM);
+
+	ref_descriptor_set->SetDescriptorSet(logical_device, hephics::BUFFERING_FRAME_NUM);
+
+	auto& uniform_buffers_map = m_ptrComputingSystem->GetUniformBuffersMap();
+	uniform_buffers_map["culling"] = {};
+	for (auto& uniform_buffer : uniform_buffers_map.at("culling"))
+		uniform_buffer.reset(new hephics_helper::UniformBuffer(gpu_instance, sizeof(CullingParameter)));
+
+	auto staging_buffer = std::make_shared<hephics_helper::StagingBuffer>(gpu_instance, meshlet_buffer_size);
+	auto staging_map_address = staging_buffer->Mapping(logical_device);
+	std::memcpy(staging_map_address, meshlets.data(), meshlet_buffer_size);
+	staging_buffer->Unmapping(logical_device);
+
+	m_ptrMeshletBuffer = std::make_shared<hephics_helper::GPUBuffer>(gpu_instance, meshlet_buffer_size,
+		vk::BufferUsageFlagBits::eStorageBuffer);
+	copy_command_buffer->CopyBuffer(staging_buffer, m_ptrMeshletBuffer, meshlet_buffer_size);
+
+	auto& staging_buffers = Scene::GetStagingBuffers();
+	staging_buffers.emplace_back(std::move(staging_buffer));
+
+	for (auto& draw_command_buffer : m_drawCommandBuffers)
+	{
+		draw_command_buffer.reset(new hephics_helper::GPUBuffer(gpu_instance, draw_command_buffer_size,
+			vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer));
+	}
+
+	for (size_t idx = 0; idx < hephics::BUFFERING_FRAME_NUM; idx++)
+	{
+		vk::DescriptorBufferInfo parameter_buffer_info(
+			uniform_buffers_map.at("culling").at(idx)->GetBuffer().get(), 0, sizeof(CullingParameter));
+		vk::DescriptorBufferInfo meshlet_buffer_info(m_ptrMeshletBuffer->GetBuffer().get(), 0, meshlet_buffer_size);
+		vk::DescriptorBufferInfo draw_command_buffer_info(
+			m_drawCommandBuffers.at(idx)->GetBuffer().get(), 0, draw_command_buffer_size);
+
+		vk::WriteDescriptorSet parameter_write_desc_set({}, 0, 0, vk::DescriptorType::eUniformBuffer, nullptr, parameter_buffer_info, nullptr);
+		vk::WriteDescriptorSet meshlet_write_desc_set({}, 1, 0, vk::DescriptorType::eStorageBuffer, nullptr, meshlet_buffer_info, nullptr);
+		vk::WriteDescriptorSet draw_command_write_desc_set({}, 2, 0, vk::DescriptorType::eStorageBuffer, nullptr, draw_command_buffer_info, nullptr);
+		auto write_descriptor_sets = std::vector
+		{ parameter_write_desc_set, meshlet_write_desc_set, draw_command_write_desc_set };
+		ref_descriptor_set->UpdateDescriptorSet(logical_device, idx, std::move(write_descriptor_sets));
+	}
+}
+
+void hephics::culling::MeshletCuller::SetPipeline()
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	auto& ref_compute_pipeline = m_ptrComputingSystem->GetComputePipeline();
+
+	// added by LoadData
+	const auto& compute_shader_module = vk_interface::component::ShaderProvider::GetShader("comp", "meshlet_cull");
+
+	// every culler shares one pipeline
+	vk_interface::compute::PipelineBuilder pipeline_builder;
+	pipeline_builder.SetShaderStage(compute_shader_module->GetModule().get())
+		.SetLayout(logical_device, { compute_shader_module });
+	ref_compute_pipeline = pipeline_builder.Build(logical_device, gpu_instance->GetPipelineCache());
+}
+
+void hephics::culling::MeshletCuller::Initialize()
+{
+	m_ptrComputingSystem = std::make_shared<actor::ComputingSystem>();
+
+	// without the feature every meshlet needs its own indirect draw
+	const auto& physical_device = GPUHandler::GetInstance()->GetPhysicalDevice();
+	m_isMultiDrawIndirect = physical_device.getFeatures().multiDrawIndirect == VK_TRUE;
+
+	LoadData();
+	SetPipeline();
+}
+
+void hephics::culling::MeshletCuller::Update(actor::Actor* const owner)
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& logical_device = gpu_instance->GetLogicalDevice();
+	const auto& computing_sync_object = gpu_instance->GetComputingSyncObject();
+	const auto& current_frame_id = computing_sync_object->GetCurrentFrameId();
+
+	// meshlet bounds are in model space, before dequantization
+	const auto& owner_position = owner->GetPosition();
+	const auto model = owner_position->model
+		* glm::inverse(m_ptrAsset3D->GetVertexQuantization().GetDequantizationMatrix());
+	const auto model_view = owner_position->view * model;
+	const auto frustum_planes = asset::Asset3D::GetFrustumPlanes(owner_position->projection * model_view);
+
+	CullingParameter culling_parameter{};
+	std::copy(frustum_planes.begin(), frustum_planes.end(), culling_parameter.frustum_planes);
+	culling_parameter.camera_position = glm::inverse(model_view)[3];
+	culling_parameter.meshlet_count = static_cast<uint32_t>(m_ptrAsset3D->GetMeshlets().size());
+
+	auto& parameter_buffer = m_ptrComputingSystem->GetUniformBuffersMap().at("culling").at(current_frame_id);
+
+	computing_sync_object->WaitFence(logical_device);
+	auto mapping_address = parameter_buffer->Mapping(logical_device);
+	std::memcpy(mapping_address, &culling_parameter, sizeof(CullingParameter));
+	parameter_buffer->Unmapping(logical_device);
+	computing_sync_object->CancelWaitFence(logical_device);
+
+	{
+		const auto& compute_command_buffer = gpu_instance->GetComputeCommandBuffer("meshlet_cull");
+		compute_command_buffer->ResetCommands({});
+		compute_command_buffer->BeginRecordingCommands({});
+	}
+
+	{
+		const auto& compute_command_buffer = gpu_instance->GetComputeCommandBuffer("meshlet_cull")->GetCommandBuffer();
+		const auto& compute_pipeline = m_ptrComputingSystem->GetComputePipeline();
+		const auto& descriptor_set = m_ptrComputingSystem->GetDescriptorSet();
+
+		compute_command_buffer->bindPipeline(vk::PipelineBindPoint::eCompute, compute_pipeline->GetPipeline().get());
+		compute_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eCompute, compute_pipeline->GetLayout().get(),
+			0, descriptor_set->GetDescriptorSet(current_frame_id).get(), nullptr);
+		compute_command_buffer->dispatch((culling_parameter.meshlet_count + 63U) / 64U, 1, 1);
+
+		// the render submission waits on the computing semaphore and reads the commands as indirect arguments
+		vk::MemoryBarrier draw_command_barrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead);
+		compute_command_buffer->pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+			vk::PipelineStageFlagBits::eDrawIndirect, {}, draw_command_barrier, nullptr, nullptr);
+	}
+
+	{
+		const auto& compute_command_buffer = gpu_instance->GetComputeCommandBuffer("meshlet_cull");
+		compute_command_buffer->EndRecordingCommands();
+
+		std::vector<vk::CommandBuffer> submitted_command_buffers;
+		submitted_command_buffers.push_back(compute_command_buffer->GetCommandBuffer().get());
+		const auto submit_info = computing_sync_object->GetComputingSubmitInfo(submitted_command_buffers);
+		gpu_instance->SubmitComputingCommand(submit_info);
+	}
+}
+
+void hephics::culling::MeshletCuller::DrawIndirect(const vk::UniqueCommandBuffer& render_command_buffer) const
+{
+	const auto& gpu_instance = GPUHandler::GetInstance();
+	const auto& current_frame_id = gpu_instance->GetComputingSyncObject()->GetCurrentFrameId();
+	const auto& draw_command_buffer = m_drawCommandBuffers.at(current_frame_id)->GetBuffer().get();
+
+	const auto meshlet_num = static_cast<uint32_t>(m_ptrAsset3D->GetMeshlets().size());
+	constexpr auto command_stride = static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand));
+
+	if (m_isMultiDrawIndirect)
+	{
+		render_command_buffer->drawIndexedIndirect(draw_command_buffer, 0, meshlet_num, command_stride);
+		return;
+	}
+
+	for (uint32_t meshlet_idx = 0U; meshlet_idx < meshlet_num; meshlet_idx++)
+		render_command_buffer->drawIndexedIndirect(draw_command_buffer, meshlet_idx * command_stride, 1, command_stride);
+}
\ No newline at end of file
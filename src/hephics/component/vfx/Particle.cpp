@@ -28,25 +28,16 @@ void hephics::vfx::particle_system::Engine::LoadData()
 	{
 		const size_t particle_buffer_size = sizeof(Particle) * m_particles.size();
 
-		vk::DescriptorSetLayoutBinding delta_time_layout_binding(10, vk::DescriptorType::eUniformBuffer,
-			1, vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eVertex, nullptr);
-		vk::DescriptorSetLayoutBinding particle_input_layout_binding(11, vk::DescriptorType::eStorageBuffer,
-			1, vk::ShaderStageFlagBits::eCompute, nullptr);
-		vk::DescriptorSetLayoutBinding particle_output_layout_binding(12, vk::DescriptorType::eStorageBuffer,
-			1, vk::ShaderStageFlagBits::eCompute, nullptr);
-
-		auto desc_layout_bindings = std::vector
-		{
-			delta_time_layout_binding, particle_input_layout_binding, particle_output_layout_binding
-		};
-		ref_descriptor_set->SetDescriptorSetLayout(logical_device, desc_layout_bindings);
+		auto shader_futures = vk_interface::component::ShaderProvider::AddShaders(logical_device,
+			{ "vert/particle.vert", "frag/particle.frag", "comp/particle.comp" }, "particle");
+		for (auto& shader_future : shader_futures)
+			shader_future.get();
 
-		vk::DescriptorPoolSize uniform_desc_pool_size(vk::DescriptorType::eUniformBuffer, hephics::BUFFERING_FRAME_NUM);
-		vk::DescriptorPoolSize  storage_desc_pool_size(vk::DescriptorType::eStorageBuffer, hephics::BUFFERING_FRAME_NUM);
-		auto desc_pool_size_list = std::vector{ uniform_desc_pool_size, storage_desc_pool_size, storage_desc_pool_size };
-		vk::DescriptorPoolCreateInfo desc_pool_create_info(
-			vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, hephics::BUFFERING_FRAME_NUM, desc_pool_size_list);
-		ref_descriptor_set->SetDescriptorPool(logical_device, desc_pool_create_info);
+		// the vertex stage reads the delta time too, the merged binding is visible to both
+		ref_descriptor_set->SetDescriptorSetLayout(logical_device, vk_interface::component::ShaderProvider::GetLayoutBindings(
+			{ vk_interface::component::ShaderProvider::GetShader("comp", "particle"),
+				vk_interface::component::ShaderProvider::GetShader("vert", "particle") }));
+		ref_descriptor_set->SetDescriptorPool(logical_device, hephics::BUFFERING_FRAME_NUM);
 
 		ref_descriptor_set->SetDescriptorSet(logical_device, hephics::BUFFERING_FRAME_NUM);
 
@@ -100,59 +91,35 @@ void hephics::vfx::particle_system::Engine::SetPipeline()
 	const auto& gpu_instance = GPUHandler::GetInstance();
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	auto& ref_compute_pipeline = m_ptrComputingSystem->GetComputePipeline();
-	auto& ref_graphic_pipeline = m_ptrRenderer->GetGraphicPipeline();
-
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "vert/particle.vert", "particle");
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "frag/particle.frag", "particle");
-	vk_interface::component::ShaderProvider::AddShader(logical_device, "comp/particle.comp", "particle");
 
+	// added by LoadData
 	const auto& vertex_shader_module = vk_interface::component::ShaderProvider::GetShader("vert", "particle");
 	const auto& fragment_shader_module = vk_interface::component::ShaderProvider::GetShader("frag", "particle");
 	const auto& compute_shader_module = vk_interface::component::ShaderProvider::GetShader("comp", "particle");
 
-	auto& ref_descriptor_set = m_ptrComputingSystem->GetDescriptorSet();
+	// both pipelines bind the one descriptor set, so both take the layout of the stages it was made for
+	const std::vector<std::shared_ptr<vk_interface::component::Shader>> layout_shaders{
+		compute_shader_module, vertex_shader_module };
 
 	{
-		vk::PipelineShaderStageCreateInfo compute_shader_stage_info({}, vk::ShaderStageFlagBits::eCompute,
-			compute_shader_module->GetModule().get(), "main");
-
-		vk::PipelineLayoutCreateInfo pipeline_layout_info({}, ref_descriptor_set->GetDescriptorSetLayout().get(), {});
-		ref_compute_pipeline->SetLayout(logical_device, pipeline_layout_info);
-
-		vk::ComputePipelineCreateInfo pipeline_info({}, compute_shader_stage_info, ref_compute_pipeline->GetLayout().get(), {});
-		ref_compute_pipeline->SetPipeline(logical_device, pipeline_info);
+		const auto& device_limits = gpu_instance->GetPhysicalDevice().getProperties().limits;
+		m_workgroupSize = std::min({ m_workgroupSize, device_limits.maxComputeWorkGroupSize.at(0),
+			device_limits.maxComputeWorkGroupInvocations });
+
+		// every workgroup size and border mode is a pipeline of its own, engines with equal ones share it
+		vk_interface::component::SpecializationConstants specialization_constants;
+		specialization_constants.Set(0U, m_workgroupSize)
+			.Set(1U, static_cast<vk::Bool32>(m_isBouncedAtBorder));
+
+		vk_interface::compute::PipelineBuilder pipeline_builder;
+		pipeline_builder.SetShaderStage(compute_shader_module->GetModule().get(), specialization_constants)
+			.SetLayout(logical_device, layout_shaders);
+		ref_compute_pipeline = pipeline_builder.Build(logical_device, gpu_instance->GetPipelineCache());
 	}
 
 	{
 		const auto& render_pass = gpu_instance->GetSwapChain()->GetRenderPass();
 
-		vk::PipelineShaderStageCreateInfo vertex_shader_stage_info({}, vk::ShaderStageFlagBits::eVertex,
-			vertex_shader_module->GetModule().get(), "main");
-
-		vk::PipelineShaderStageCreateInfo fragment_shader_stage_info({}, vk::ShaderStageFlagBits::eFragment,
-			fragment_shader_module->GetModule().get(), "main");
-
-		const auto shader_stages = { vertex_shader_stage_info, fragment_shader_stage_info };
-
-		auto vertex_binding_descs = std::vector{ Particle::get_binding_description() };
-		auto vertex_attribute_descs = Particle::get_attribute_descriptions();
-		vk::PipelineVertexInputStateCreateInfo vertex_input_info({}, vertex_binding_descs, vertex_attribute_descs);
-
-		vk::PipelineInputAssemblyStateCreateInfo input_assembly({}, vk::PrimitiveTopology::ePointList, VK_FALSE);
-
-		vk::PipelineViewportStateCreateInfo viewport_state({}, 1, {}, 1, {});
-
-		vk::PipelineRasterizationStateCreateInfo rasterizer({}, VK_FALSE, VK_FALSE,
-			vk::PolygonMode::eFill, vk::CullModeFlagBits::eBack, vk::FrontFace::eCounterClockwise,
-			VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f);
-
-		vk::PipelineMultisampleStateCreateInfo multisampling({}, gpu_instance->GetMultiSampleCount(), VK_FALSE);
-
-		vk::PipelineDepthStencilStateCreateInfo depth_stencil({}, VK_TRUE, VK_TRUE,
-			vk::CompareOp::eLessOrEqual, VK_FALSE, VK_FALSE);
-		depth_stencil.setMinDepthBounds(0.0f);
-		depth_stencil.setMaxDepthBounds(1.0f);
-
 		vk::PipelineColorBlendAttachmentState color_blend_attachment(VK_FALSE);
 		color_blend_attachment.setColorWriteMask(
 			vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
@@ -165,21 +132,17 @@ void hephics::vfx::particle_system::Engine::SetPipeline()
 		color_blend_attachment.setSrcAlphaBlendFactor(vk::BlendFactor::eOne);
 		color_blend_attachment.setDstAlphaBlendFactor(vk::BlendFactor::eZero);
 
-		vk::PipelineColorBlendStateCreateInfo color_blending({}, VK_FALSE, vk::LogicOp::eCopy, color_blend_attachment);
-
-		std::vector<vk::DynamicState> dynamic_states =
-		{
-			vk::DynamicState::eScissor, vk::DynamicState::eViewport
-		};
-		vk::PipelineDynamicStateCreateInfo dynamic_state_info({}, dynamic_states);
-
-		vk::PipelineLayoutCreateInfo pipeline_layout_info({}, ref_descriptor_set->GetDescriptorSetLayout().get());
-		ref_graphic_pipeline->SetLayout(logical_device, pipeline_layout_info);
-
-		vk::GraphicsPipelineCreateInfo pipeline_info({}, shader_stages, &vertex_input_info, &input_assembly, {},
-			&viewport_state, &rasterizer, &multisampling, &depth_stencil, &color_blending, &dynamic_state_info,
-			ref_graphic_pipeline->GetLayout().get(), render_pass.get());
-		ref_graphic_pipeline->SetPipeline(logical_device, pipeline_info);
+		vk_interface::graphic::PipelineBuilder pipeline_builder;
+		pipeline_builder.AddShaderStage(vk::ShaderStageFlagBits::eVertex, vertex_shader_module->GetModule().get())
+			.AddShaderStage(vk::ShaderStageFlagBits::eFragment, fragment_shader_module->GetModule().get())
+			.SetVertexInput({ Particle::get_binding_description() }, Particle::get_attribute_descriptions())
+			.SetTopology(vk::PrimitiveTopology::ePointList)
+			.SetSampleCount(gpu_instance->GetMultiSampleCount())
+			.SetDepth(VK_TRUE, VK_TRUE, vk::CompareOp::eLessOrEqual)
+			.SetColorBlendAttachment(color_blend_attachment)
+			.SetLayout(logical_device, layout_shaders)
+			.SetRenderPass(render_pass.get());
+		m_ptrRenderer->SetGraphicPipeline(pipeline_builder.BuildAsync(logical_device, gpu_instance->GetPipelineCache()));
 	}
 }
 
@@ -224,7 +187,8 @@ void hephics::vfx::particle_system::Engine::Update(actor::Actor* const owner)
 		compute_command_buffer->bindPipeline(vk::PipelineBindPoint::eCompute, compute_pipeline->GetPipeline().get());
 		compute_command_buffer->bindDescriptorSets(vk::PipelineBindPoint::eCompute, compute_pipeline->GetLayout().get(),
 			0, descriptor_set->GetDescriptorSet(current_frame_id).get(), nullptr);
-		compute_command_buffer->dispatch(static_cast<uint32_t>(m_particles.size() / 256U), 1, 1);
+		const auto workgroup_num = (static_cast<uint32_t>(m_particles.size()) + m_workgroupSize - 1U) / m_workgroupSize;
+		compute_command_buffer->dispatch(workgroup_num, 1, 1);
 	}
 
 	{
@@ -245,10 +209,14 @@ void hephics::vfx::particle_system::Engine::Render()
 	const auto& logical_device = gpu_instance->GetLogicalDevice();
 	const auto& swap_chain = gpu_instance->GetSwapChain();
 	const auto& render_command_buffer = gpu_instance->GetGraphicCommandBuffer("render")->GetCommandBuffer();
-	const auto& pipeline = m_ptrRenderer->GetGraphicPipeline();
+	const auto& pipeline = m_ptrRenderer->GetReadyGraphicPipeline();
 	const auto& computing_sync_object = gpu_instance->GetComputingSyncObject();
 	const auto& current_frame_id = computing_sync_object->GetCurrentFrameId();
 
+	// the particles keep moving while their pipeline compiles, they are only drawn once it is ready
+	if (!pipeline)
+		return;
+
 	render_command_buffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline().get());
 	render_command_buffer->bindVertexBuffers(0,
 		{ m_vertexStorageBuffers.at(current_frame_id)->GetBuffer().get() }, { 0 });
@@ -0,0 +1,98 @@
+#include "../HephicsHelper.hpp"
+
+static constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t read_u64(const uint8_t* ptr)
+{
+	uint64_t value;
+	std::memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+static inline uint32_t read_u32(const uint8_t* ptr)
+{
+	uint32_t value;
+	std::memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+static inline uint64_t xxh64_round(uint64_t accumulator, const uint64_t& input)
+{
+	accumulator += input * XXH_PRIME64_2;
+	accumulator = std::rotl(accumulator, 31);
+	return accumulator * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge_round(uint64_t accumulator, const uint64_t& value)
+{
+	accumulator ^= xxh64_round(0U, value);
+	return accumulator * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t hephics_helper::hash::compute_xxh64(const void* ptr_data, const size_t& size, const uint64_t& seed)
+{
+	auto ptr = static_cast<const uint8_t*>(ptr_data);
+	const auto ptr_end = ptr + size;
+	uint64_t hash_value;
+
+	if (size >= 32U)
+	{
+		uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+		uint64_t v2 = seed + XXH_PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - XXH_PRIME64_1;
+
+		const auto ptr_limit = ptr_end - 32;
+		do
+		{
+			v1 = xxh64_round(v1, read_u64(ptr));
+			v2 = xxh64_round(v2, read_u64(ptr + 8));
+			v3 = xxh64_round(v3, read_u64(ptr + 16));
+			v4 = xxh64_round(v4, read_u64(ptr + 24));
+			ptr += 32;
+		} while (ptr <= ptr_limit);
+
+		hash_value = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+		hash_value = xxh64_merge_round(hash_value, v1);
+		hash_value = xxh64_merge_round(hash_value, v2);
+		hash_value = xxh64_merge_round(hash_value, v3);
+		hash_value = xxh64_merge_round(hash_value, v4);
+	}
+	else
+		hash_value = seed + XXH_PRIME64_5;
+
+	hash_value += static_cast<uint64_t>(size);
+
+	while (ptr + 8 <= ptr_end)
+	{
+		hash_value ^= xxh64_round(0U, read_u64(ptr));
+		hash_value = std::rotl(hash_value, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		ptr += 8;
+	}
+
+	if (ptr + 4 <= ptr_end)
+	{
+		hash_value ^= static_cast<uint64_t>(read_u32(ptr)) * XXH_PRIME64_1;
+		hash_value = std::rotl(hash_value, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		ptr += 4;
+	}
+
+	while (ptr < ptr_end)
+	{
+		hash_value ^= static_cast<uint64_t>(*ptr) * XXH_PRIME64_5;
+		hash_value = std::rotl(hash_value, 11) * XXH_PRIME64_1;
+		ptr++;
+	}
+
+	hash_value ^= hash_value >> 33;
+	hash_value *= XXH_PRIME64_2;
+	hash_value ^= hash_value >> 29;
+	hash_value *= XXH_PRIME64_3;
+	hash_value ^= hash_value >> 32;
+
+	return hash_value;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "../HephicsHelper.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void hephics_helper::MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+#ifdef _WIN32
+	auto file_handle = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("mapped_file: failed to open " + path.string());
+
+	::LARGE_INTEGER file_size{};
+	::GetFileSizeEx(file_handle, &file_size);
+	m_fileHandle = file_handle;
+	m_size = static_cast<size_t>(file_size.QuadPart);
+
+	if (m_size == 0U) // zero-length files cannot be mapped
+		return;
+
+	m_mappingHandle = ::CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		Close();
+		throw std::runtime_error("mapped_file: failed to map " + path.string());
+	}
+
+	m_ptrData = static_cast<const std::byte*>(::MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+	m_fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (m_fileDescriptor < 0)
+		throw std::runtime_error("mapped_file: failed to open " + path.string());
+
+	struct ::stat file_stat {};
+	::fstat(m_fileDescriptor, &file_stat);
+	m_size = static_cast<size_t>(file_stat.st_size);
+
+	if (m_size == 0U)
+		return;
+
+	auto ptr_mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+	if (ptr_mapped != MAP_FAILED)
+		m_ptrData = static_cast<const std::byte*>(ptr_mapped);
+#endif
+
+	if (m_ptrData == nullptr)
+	{
+		Close();
+		throw std::runtime_error("mapped_file: failed to map " + path.string());
+	}
+}
+
+void hephics_helper::MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_ptrData != nullptr)
+		::UnmapViewOfFile(m_ptrData);
+	if (m_mappingHandle != nullptr)
+		::CloseHandle(m_mappingHandle);
+	if (m_fileHandle != nullptr)
+		::CloseHandle(m_fileHandle);
+
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if (m_ptrData != nullptr)
+		::munmap(const_cast<std::byte*>(m_ptrData), m_size);
+	if (m_fileDescriptor >= 0)
+		::close(m_fileDescriptor);
+
+	m_fileDescriptor = -1;
+#endif
+
+	m_ptrData = nullptr;
+	m_size = 0U;
+}
\ No newline at end of file
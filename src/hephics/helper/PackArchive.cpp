@@ -0,0 +1,389 @@
+#include "../HephicsHelper.hpp"
+
+// compressed entries need LZ4 at build time, archives without them are read either way
+#if __has_include(<lz4.h>)
+#include <lz4.h>
+#define HEPHICS_USE_LZ4
+#endif
+
+std::vector<std::shared_ptr<hephics_helper::PackArchive>> hephics_helper::PackArchive::s_mountedArchives;
+std::mutex hephics_helper::PackArchive::s_mutex;
+
+static size_t align_offset(const size_t& offset, const size_t& alignment)
+{
+	return (offset + alignment - 1U) / alignment * alignment;
+}
+
+// stored payload of a compressed entry: the compressed size of every block, then the blocks back to back
+static std::vector<std::byte> compress_blocks(const std::span<const std::byte>& data, const uint32_t& block_size,
+	uint32_t& block_count)
+{
+	block_count = static_cast<uint32_t>((data.size() + block_size - 1U) / block_size);
+
+#ifdef HEPHICS_USE_LZ4
+	std::vector<std::byte> stored_data(sizeof(uint32_t) * block_count);
+	std::vector<char> block_buffer(::LZ4_compressBound(static_cast<int32_t>(block_size)));
+
+	for (uint32_t block_idx = 0U; block_idx < block_count; block_idx++)
+	{
+		const auto block_offset = size_t(block_idx) * block_size;
+		const auto src_size = std::min(size_t(block_size), data.size() - block_offset);
+
+		const auto compressed_size = ::LZ4_compress_default(reinterpret_cast<const char*>(data.data() + block_offset),
+			block_buffer.data(), static_cast<int32_t>(src_size), static_cast<int32_t>(block_buffer.size()));
+		if (compressed_size <= 0)
+			throw std::runtime_error("pack_archive: failed to compress a block");
+
+		const auto block_stored_size = static_cast<uint32_t>(compressed_size);
+		std::memcpy(stored_data.data() + sizeof(uint32_t) * block_idx, &block_stored_size, sizeof(uint32_t));
+		stored_data.insert(stored_data.end(), reinterpret_cast<const std::byte*>(block_buffer.data()),
+			reinterpret_cast<const std::byte*>(block_buffer.data()) + compressed_size);
+	}
+
+	return stored_data;
+#else
+	throw std::runtime_error("pack_archive: built without lz4");
+#endif
+}
+
+bool hephics_helper::PackArchive::IsCompressionSupported(const Compression& compression)
+{
+	switch (compression)
+	{
+	case Compression::none:
+		return true;
+	case Compression::lz4:
+#ifdef HEPHICS_USE_LZ4
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+std::string hephics_helper::PackArchive::GetEntryName(const std::filesystem::path& asset_path)
+{
+	const auto relative_path = asset_path.lexically_normal().lexically_relative("assets");
+	if (relative_path.empty() || relative_path.begin()->string() == "..")
+		return asset_path.lexically_normal().generic_string();
+
+	return relative_path.generic_string();
+}
+
+void hephics_helper::PackArchive::Open(const std::filesystem::path& path)
+{
+	m_entryMap.clear();
+	m_mappedFile.Open(path);
+
+	const auto file_size = m_mappedFile.GetSize();
+	if (file_size < sizeof(Header))
+		throw std::runtime_error("pack_archive: broken header in " + path.string());
+
+	std::memcpy(&m_header, m_mappedFile.GetData(), sizeof(Header));
+	if (m_header.magic != MAGIC || m_header.version != VERSION || m_header.block_size == 0U)
+		throw std::runtime_error("pack_archive: unsupported archive " + path.string());
+
+	const auto entries = m_mappedFile.GetSpan<Entry>(m_header.toc_offset, m_header.entry_count);
+	const auto names = m_mappedFile.GetSpan<char>(m_header.name_offset, file_size - std::min(file_size, m_header.name_offset));
+	m_names = names;
+
+	m_entryMap.reserve(entries.size());
+	for (const auto& entry : entries)
+	{
+		if (size_t(entry.name_offset) + entry.name_length > names.size()
+			|| size_t(entry.dependency_offset) + entry.dependency_length > names.size()
+			|| entry.offset > file_size || entry.stored_size > file_size - entry.offset)
+			throw std::runtime_error("pack_archive: broken table of contents in " + path.string());
+
+		if (entry.compression == Compression::none ? entry.stored_size != entry.size
+			: (entry.block_count != (entry.size + m_header.block_size - 1U) / m_header.block_size
+				|| sizeof(uint32_t) * entry.block_count > entry.stored_size))
+			throw std::runtime_error("pack_archive: broken table of contents in " + path.string());
+
+		m_entryMap.insert_or_assign(std::string_view(names.data() + entry.name_offset, entry.name_length), entry);
+	}
+}
+
+// blocks are independent: every one decompresses on its own worker
+static void decompress_blocks(const std::span<const std::byte>& stored_data, const uint32_t& block_count,
+	const size_t& block_size, const std::span<std::byte>& dst)
+{
+#ifdef HEPHICS_USE_LZ4
+	if (sizeof(uint32_t) * block_count > stored_data.size())
+		throw std::runtime_error("pack_archive: broken entry");
+
+	std::vector<uint32_t> block_stored_sizes(block_count);
+	std::memcpy(block_stored_sizes.data(), stored_data.data(), sizeof(uint32_t) * block_count);
+
+	std::vector<size_t> block_offsets(block_count);
+	size_t stored_offset = sizeof(uint32_t) * block_count;
+	for (uint32_t block_idx = 0U; block_idx < block_count; block_idx++)
+	{
+		block_offsets.at(block_idx) = stored_offset;
+		stored_offset += block_stored_sizes.at(block_idx);
+	}
+	if (stored_offset > stored_data.size())
+		throw std::runtime_error("pack_archive: broken entry");
+
+	const auto ptr_stored_data = reinterpret_cast<const char*>(stored_data.data());
+
+	hephics_helper::WorkerPool::ParallelFor(block_count, [&](const size_t& block_idx)
+		{
+			const auto dst_offset = block_idx * block_size;
+			const auto dst_size = static_cast<int32_t>(std::min(block_size, dst.size() - dst_offset));
+
+			const auto decompressed_size = ::LZ4_decompress_safe(ptr_stored_data + block_offsets.at(block_idx),
+				reinterpret_cast<char*>(dst.data() + dst_offset), static_cast<int32_t>(block_stored_sizes.at(block_idx)), dst_size);
+			if (decompressed_size != dst_size)
+				throw std::runtime_error("pack_archive: broken block");
+		});
+#else
+	throw std::runtime_error("pack_archive: built without lz4");
+#endif
+}
+
+void hephics_helper::PackArchive::Decompress(const Entry& entry, std::byte* ptr_dst) const
+{
+	decompress_blocks(std::span(m_mappedFile.GetData() + entry.offset, entry.stored_size), entry.block_count,
+		m_header.block_size, std::span(ptr_dst, entry.size));
+}
+
+std::vector<std::byte> hephics_helper::PackArchive::CompressBytes(const std::span<const std::byte>& data)
+{
+	uint32_t block_count = 0U;
+	return compress_blocks(data, BLOCK_SIZE, block_count);
+}
+
+void hephics_helper::PackArchive::DecompressBytes(const std::span<const std::byte>& compressed_data,
+	const std::span<std::byte>& dst)
+{
+	const auto block_count = static_cast<uint32_t>((dst.size() + BLOCK_SIZE - 1U) / BLOCK_SIZE);
+	decompress_blocks(compressed_data, block_count, BLOCK_SIZE, dst);
+}
+
+std::optional<uint64_t> hephics_helper::PackArchive::FindContentHash(const std::string& name) const
+{
+	const auto entry_iter = m_entryMap.find(name);
+	if (entry_iter == m_entryMap.end())
+		return std::nullopt;
+
+	return entry_iter->second.content_hash;
+}
+
+std::optional<std::string> hephics_helper::PackArchive::FindDependency(const std::string& name) const
+{
+	const auto entry_iter = m_entryMap.find(name);
+	if (entry_iter == m_entryMap.end())
+		return std::nullopt;
+
+	const auto& entry = entry_iter->second;
+	return std::string(m_names.data() + entry.dependency_offset, entry.dependency_length);
+}
+
+hephics_helper::PackArchive::EntryData hephics_helper::PackArchive::Read(const std::string& name) const
+{
+	const auto entry_iter = m_entryMap.find(name);
+	if (entry_iter == m_entryMap.end())
+		throw std::runtime_error("pack_archive: not found " + name);
+
+	const auto& entry = entry_iter->second;
+	if (!IsCompressionSupported(entry.compression))
+		throw std::runtime_error("pack_archive: unsupported compression in " + name);
+
+	EntryData entry_data;
+	entry_data.ptr_archive = weak_from_this().lock();
+
+	if (entry.compression == Compression::none)
+	{
+		entry_data.view = m_mappedFile.GetSpan<std::byte>(entry.offset, entry.size);
+	}
+	else
+	{
+		entry_data.buffer.resize(entry.size);
+		Decompress(entry, entry_data.buffer.data());
+	}
+
+#ifdef _DEBUG
+	const auto bytes = entry_data.GetBytes();
+	if (hash::compute_xxh64(bytes.data(), bytes.size()) != entry.content_hash)
+		throw std::runtime_error("pack_archive: content hash mismatch in " + name);
+#endif
+
+	return entry_data;
+}
+
+void hephics_helper::PackArchive::Write(const std::filesystem::path& path, const std::vector<SourceEntry>& entries)
+{
+	std::vector<Entry> toc_entries(entries.size());
+	std::vector<std::vector<std::byte>> stored_data_list(entries.size());
+
+	WorkerPool::ParallelFor(entries.size(), [&](const size_t& entry_idx)
+		{
+			const auto& source_entry = entries.at(entry_idx);
+			auto& toc_entry = toc_entries.at(entry_idx);
+
+			toc_entry.size = source_entry.data.size();
+			toc_entry.content_hash = hash::compute_xxh64(source_entry.data.data(), source_entry.data.size());
+			toc_entry.compression = Compression::none;
+			toc_entry.block_count = 0U;
+
+			if (source_entry.compression == Compression::lz4 && !source_entry.data.empty())
+			{
+				uint32_t block_count = 0U;
+				auto stored_data = compress_blocks(source_entry.data, BLOCK_SIZE, block_count);
+				if (stored_data.size() < source_entry.data.size())
+				{
+					toc_entry.compression = Compression::lz4;
+					toc_entry.block_count = block_count;
+					stored_data_list.at(entry_idx) = std::move(stored_data);
+				}
+			}
+		});
+
+	Header header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.entry_count = static_cast<uint32_t>(entries.size());
+	header.block_size = BLOCK_SIZE;
+
+	std::string names;
+	size_t data_offset = sizeof(Header);
+	for (size_t entry_idx = 0U; entry_idx < entries.size(); entry_idx++)
+	{
+		auto& toc_entry = toc_entries.at(entry_idx);
+		const auto& name = entries.at(entry_idx).name;
+
+		toc_entry.name_offset = static_cast<uint32_t>(names.size());
+		toc_entry.name_length = static_cast<uint32_t>(name.size());
+		names += name;
+
+		const auto& dependency = entries.at(entry_idx).dependency;
+		toc_entry.dependency_offset = static_cast<uint32_t>(names.size());
+		toc_entry.dependency_length = static_cast<uint32_t>(dependency.size());
+		names += dependency;
+
+		data_offset = align_offset(data_offset, ENTRY_ALIGNMENT);
+		toc_entry.offset = data_offset;
+		toc_entry.stored_size = toc_entry.compression == Compression::none
+			? toc_entry.size : stored_data_list.at(entry_idx).size();
+		data_offset += toc_entry.stored_size;
+	}
+
+	header.toc_offset = align_offset(data_offset, alignof(Entry));
+	header.name_offset = header.toc_offset + sizeof(Entry) * toc_entries.size();
+
+	auto temp_path = path;
+	temp_path += ".tmp";
+
+	try
+	{
+		if (path.has_parent_path())
+			std::filesystem::create_directories(path.parent_path());
+
+		{
+			std::ofstream ofs(temp_path, std::ios::binary | std::ios::trunc);
+			if (!ofs.is_open())
+				throw std::runtime_error("Failed to open file: " + temp_path.string());
+
+			const auto write_padding = [&ofs](const size_t& offset)
+				{
+					static constexpr std::array<char, ENTRY_ALIGNMENT> padding{};
+					const auto padding_size = offset - static_cast<size_t>(ofs.tellp());
+					ofs.write(padding.data(), padding_size);
+				};
+
+			ofs.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			for (size_t entry_idx = 0U; entry_idx < entries.size(); entry_idx++)
+			{
+				const auto& toc_entry = toc_entries.at(entry_idx);
+				const auto& stored_data = toc_entry.compression == Compression::none
+					? entries.at(entry_idx).data : stored_data_list.at(entry_idx);
+
+				write_padding(toc_entry.offset);
+				ofs.write(reinterpret_cast<const char*>(stored_data.data()), stored_data.size());
+			}
+
+			write_padding(header.toc_offset);
+			ofs.write(reinterpret_cast<const char*>(toc_entries.data()), sizeof(Entry) * toc_entries.size());
+			ofs.write(names.data(), names.size());
+			if (!ofs.good())
+				throw std::runtime_error("Failed to write file: " + temp_path.string());
+		}
+
+		std::filesystem::rename(temp_path, path);
+	}
+	catch (const std::exception&)
+	{
+		std::error_code error_code;
+		std::filesystem::remove(temp_path, error_code);
+		throw;
+	}
+}
+
+bool hephics_helper::PackArchive::Mount(const std::filesystem::path& path)
+{
+	std::error_code error_code;
+	if (!std::filesystem::exists(path, error_code))
+		return false;
+
+	auto ptr_archive = std::make_shared<PackArchive>(path);
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_mountedArchives.emplace_back(std::move(ptr_archive));
+
+#ifdef _DEBUG
+	std::cout << std::format("pack_archive: mounted {} ({} entries)\n", path.string(),
+		s_mountedArchives.back()->m_entryMap.size());
+#endif
+
+	return true;
+}
+
+void hephics_helper::PackArchive::UnmountAll()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_mountedArchives.clear();
+}
+
+std::optional<uint64_t> hephics_helper::PackArchive::FindMountedContentHash(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	for (auto archive_iter = s_mountedArchives.rbegin(); archive_iter != s_mountedArchives.rend(); archive_iter++)
+	{
+		if (const auto content_hash = (*archive_iter)->FindContentHash(name))
+			return content_hash;
+	}
+
+	return std::nullopt;
+}
+
+std::optional<std::string> hephics_helper::PackArchive::FindMountedDependency(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	for (auto archive_iter = s_mountedArchives.rbegin(); archive_iter != s_mountedArchives.rend(); archive_iter++)
+	{
+		if (auto dependency = (*archive_iter)->FindDependency(name))
+			return dependency;
+	}
+
+	return std::nullopt;
+}
+
+std::optional<hephics_helper::PackArchive::EntryData> hephics_helper::PackArchive::Load(const std::string& name)
+{
+	std::shared_ptr<const PackArchive> ptr_archive;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		const auto archive_iter = std::find_if(s_mountedArchives.rbegin(), s_mountedArchives.rend(),
+			[&name](const auto& ptr_mounted_archive) { return ptr_mounted_archive->Contains(name); });
+		if (archive_iter == s_mountedArchives.rend())
+			return std::nullopt;
+
+		ptr_archive = *archive_iter;
+	}
+
+	// decompression runs outside the lock
+	return ptr_archive->Read(name);
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "../HephicsHelper.hpp"
+
+std::vector<std::jthread> hephics_helper::WorkerPool::s_workers;
+std::deque<std::function<void()>> hephics_helper::WorkerPool::s_taskQueue;
+std::mutex hephics_helper::WorkerPool::s_mutex;
+std::condition_variable_any hephics_helper::WorkerPool::s_condition;
+bool hephics_helper::WorkerPool::s_isShutdown = false;
+
+void hephics_helper::WorkerPool::Enqueue(std::function<void()>&& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		if (s_isShutdown)
+			throw std::runtime_error("worker_pool: task submitted after shutdown");
+
+		if (s_workers.empty())
+			StartWorkers(0U);
+
+		s_taskQueue.emplace_back(std::move(task));
+	}
+	s_condition.notify_one();
+}
+
+void hephics_helper::WorkerPool::StartWorkers(const uint32_t& worker_num)
+{
+	// leave one hardware thread for the render loop
+	const auto hardware_thread_num = std::max(2U, std::thread::hardware_concurrency());
+	const auto new_worker_num = worker_num > 0U ? worker_num : hardware_thread_num - 1U;
+
+	for (uint32_t worker_id = 0U; worker_id < new_worker_num; worker_id++)
+		s_workers.emplace_back(&WorkerPool::RunWorker);
+}
+
+void hephics_helper::WorkerPool::RunWorker(std::stop_token stop_token)
+{
+	while (true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(s_mutex);
+			if (!s_condition.wait(lock, stop_token, [] { return !s_taskQueue.empty(); }))
+				return;
+
+			task = std::move(s_taskQueue.front());
+			s_taskQueue.pop_front();
+		}
+
+		task();
+	}
+}
+
+void hephics_helper::WorkerPool::Initialize(const uint32_t& worker_num)
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_isShutdown = false;
+	if (!s_workers.empty())
+		return;
+
+	StartWorkers(worker_num);
+}
+
+void hephics_helper::WorkerPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_isShutdown = true;
+	}
+
+	for (auto& worker : s_workers)
+		worker.request_stop();
+	s_condition.notify_all();
+
+	s_workers.clear(); // joins
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_taskQueue.clear();
+}
+
+uint32_t hephics_helper::WorkerPool::GetWorkerNum()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	if (!s_isShutdown && s_workers.empty())
+		StartWorkers(0U);
+
+	return static_cast<uint32_t>(s_workers.size());
+}
+
+void hephics_helper::WorkerPool::ParallelFor(const size_t& count, const std::function<void(const size_t&)>& function)
+{
+	if (count == 0U)
+		return;
+
+	if (count == 1U)
+	{
+		function(0U);
+		return;
+	}
+
+	struct LoopState
+	{
+		std::atomic<size_t> next_idx = 0U;
+		std::atomic<size_t> finished_num = 0U;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::exception_ptr exception;
+	};
+
+	auto ptr_state = std::make_shared<LoopState>();
+
+	// helpers that start after the loop is drained return without touching "function",
+	// so the caller may leave as soon as every index has finished
+	const auto run_loop = [ptr_state, &function, count]
+		{
+			for (auto idx = ptr_state->next_idx.fetch_add(1U); idx < count; idx = ptr_state->next_idx.fetch_add(1U))
+			{
+				try
+				{
+					function(idx);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(ptr_state->mutex);
+					if (!ptr_state->exception)
+						ptr_state->exception = std::current_exception();
+				}
+
+				if (ptr_state->finished_num.fetch_add(1U) + 1U == count)
+				{
+					std::lock_guard<std::mutex> lock(ptr_state->mutex);
+					ptr_state->condition.notify_all();
+				}
+			}
+		};
+
+	const auto helper_num = std::min(static_cast<size_t>(GetWorkerNum()), count - 1U);
+	for (size_t helper_id = 0U; helper_id < helper_num; helper_id++)
+		Enqueue(run_loop);
+
+	run_loop();
+
+	{
+		std::unique_lock<std::mutex> lock(ptr_state->mutex);
+		ptr_state->condition.wait(lock, [&] { return ptr_state->finished_num.load() == count; });
+	}
+
+	if (ptr_state->exception)
+		std::rethrow_exception(ptr_state->exception);
+}
\ No newline at end of file
@@ -54,8 +54,13 @@ namespace vk_interface
 		class DescriptorSet
 		{
 		protected:
+			// layouts by a hash of their bindings, equal bindings share one layout until ResetLayouts
+			static std::unordered_map<uint64_t, std::shared_ptr<vk::UniqueDescriptorSetLayout>> s_layoutDictionary;
+			static std::mutex s_layoutMutex;
+
 			vk::UniqueDescriptorPool m_descriptorPool;
-			vk::UniqueDescriptorSetLayout m_descriptorSetLayout;
+			std::shared_ptr<vk::UniqueDescriptorSetLayout> m_ptrDescriptorSetLayout;
+			std::vector<vk::DescriptorSetLayoutBinding> m_layoutBindings;
 			std::vector<vk::UniqueDescriptorSet> m_descriptorSets;
 
 		public:
@@ -64,30 +69,43 @@ namespace vk_interface
 
 			DescriptorSet(DescriptorSet&& other) noexcept
 			{
-				m_descriptorSetLayout = std::move(other.m_descriptorSetLayout);
+				m_ptrDescriptorSetLayout = std::move(other.m_ptrDescriptorSetLayout);
+				m_layoutBindings = std::move(other.m_layoutBindings);
 				m_descriptorPool = std::move(other.m_descriptorPool);
 			}
 
 			DescriptorSet& operator=(DescriptorSet&& other) noexcept
 			{
-				m_descriptorSetLayout = std::move(other.m_descriptorSetLayout);
+				m_ptrDescriptorSetLayout = std::move(other.m_ptrDescriptorSetLayout);
+				m_layoutBindings = std::move(other.m_layoutBindings);
 				m_descriptorPool = std::move(other.m_descriptorPool);
 			}
 
+			// immutable samplers are part of the hash, so they are compared by handle
 			void SetDescriptorSetLayout(const vk::UniqueDevice& logical_device,
 				const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
 
 			void SetDescriptorPool(const vk::UniqueDevice& logical_device,
 				const vk::DescriptorPoolCreateInfo& create_info);
 
-			void SetDescriptorSet(const vk::UniqueDevice& logical_device, const uint8_t& concurrent_frame_num);
+			// a pool for "set_num" sets of the layout, one size per descriptor type
+			void SetDescriptorPool(const vk::UniqueDevice& logical_device, const uint32_t& set_num);
+
+			// "set_num" sets of the layout, one per frame or per frame and material
+			void SetDescriptorSet(const vk::UniqueDevice& logical_device, const uint32_t& set_num);
 
 			void UpdateDescriptorSet(const vk::UniqueDevice& logical_device, const size_t& target_idx,
 				std::vector<vk::WriteDescriptorSet>&& write_descriptor_sets);
 
-			const auto& GetDescriptorSetLayout() const { return m_descriptorSetLayout; }
+			const auto& GetDescriptorSetLayout() const { return *m_ptrDescriptorSetLayout; }
 			const auto& GetDescriptorSetPool() const { return m_descriptorPool; }
 			const auto& GetDescriptorSet(const size_t& target_idx) const { return m_descriptorSets.at(target_idx); }
+
+			// the shared layout of equal bindings, made if there is none; pipeline layouts take it from here
+			static std::shared_ptr<vk::UniqueDescriptorSetLayout> GetSharedLayout(const vk::UniqueDevice& logical_device,
+				const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+			static void ResetLayouts();
 		};
 
 		class Buffer
@@ -135,10 +153,19 @@ namespace vk_interface
 			void BindMemory(const vk::UniqueDevice& logical_device);
 		};
 
+		// a resource variable of a shader, read from its SPIR-V
+		struct ReflectedBinding
+		{
+			uint32_t set;
+			vk::DescriptorSetLayoutBinding layout_binding;
+		};
+
 		class Shader
 		{
 		protected:
 			vk::UniqueShaderModule m_module;
+			std::vector<ReflectedBinding> m_reflectedBindings;
+			std::optional<vk::PushConstantRange> m_reflectedPushConstantRange; // a stage has one push constant block at most
 
 		public:
 			Shader() = default;
@@ -147,35 +174,143 @@ namespace vk_interface
 			Shader(Shader&& other) noexcept
 			{
 				m_module = std::move(other.m_module);
+				m_reflectedBindings = std::move(other.m_reflectedBindings);
+				m_reflectedPushConstantRange = std::move(other.m_reflectedPushConstantRange);
 			}
 
 			Shader& operator=(Shader&& other) noexcept
 			{
 				m_module = std::move(other.m_module);
+				m_reflectedBindings = std::move(other.m_reflectedBindings);
+				m_reflectedPushConstantRange = std::move(other.m_reflectedPushConstantRange);
 			}
 
+			// also reflects the descriptor bindings and the push constant range of the code
 			void SetModule(const vk::UniqueDevice& logical_device, const vk::ShaderModuleCreateInfo& create_info);
 
 			const auto& GetModule() const { return m_module; }
+			const auto& GetReflectedBindings() const { return m_reflectedBindings; }
+			const auto& GetReflectedPushConstantRange() const { return m_reflectedPushConstantRange; }
+		};
+
+		// values of a shader's constant_id constants, given at pipeline creation: one module serves every variant
+		// and the driver folds the values like literals. Only 32 bit constants, a bool is set as vk::Bool32
+		class SpecializationConstants
+		{
+		protected:
+			std::vector<vk::SpecializationMapEntry> m_mapEntries;
+			std::vector<uint32_t> m_values;
+
+		public:
+			SpecializationConstants() = default;
+			~SpecializationConstants() {}
+
+			template<typename T>
+			SpecializationConstants& Set(const uint32_t& constant_id, const T& value)
+			{
+				static_assert(sizeof(T) == sizeof(uint32_t) && std::is_trivially_copyable_v<T>,
+					"specialization_constants: 32 bit values only");
+
+				uint32_t value_bits;
+				std::memcpy(&value_bits, &value, sizeof(uint32_t));
+
+				const auto entry_it = std::find_if(m_mapEntries.begin(), m_mapEntries.end(),
+					[&constant_id](const vk::SpecializationMapEntry& map_entry) { return map_entry.constantID == constant_id; });
+				if (entry_it != m_mapEntries.end())
+				{
+					m_values.at(entry_it->offset / sizeof(uint32_t)) = value_bits;
+					return *this;
+				}
+
+				m_mapEntries.emplace_back(constant_id, static_cast<uint32_t>(sizeof(uint32_t) * m_values.size()), sizeof(uint32_t));
+				m_values.push_back(value_bits);
+				return *this;
+			}
+
+			bool IsEmpty() const { return m_mapEntries.empty(); }
+
+			// points into this object, which has to outlive the pipeline creation
+			vk::SpecializationInfo GetInfo() const
+			{
+				return vk::SpecializationInfo(m_mapEntries, vk::ArrayProxyNoTemporaries<const uint32_t>(m_values));
+			}
+
+			// the specialization key: equal for equal constant ids and values, whatever order they were set in
+			uint64_t GetHash() const;
 		};
 
 		// static
 		class ShaderProvider
 		{
+		public:
+			// spirv-opt pass set run on freshly compiled SPIR-V, before the module is created and cached
+			enum class Optimization
+			{
+				none,
+				performance, // spirv-opt -O
+				size, // spirv-opt -Os
+			};
+
+			// instruction counts of a compile: glslang's module and the one kept, equal when it was not optimized;
+			// a cache hit only knows the kept one
+			struct CompileStat
+			{
+				bool is_cached = false;
+				size_t compiled_instruction_num = 0U;
+				size_t instruction_num = 0U;
+			};
+
 		private:
 			static std::unordered_map<std::string, std::unordered_map<std::string, std::shared_ptr<Shader>>> s_shaderDictionary;
+			static std::mutex s_mutex; // the dictionary and the glslang state, shaders are added from workers
+			static bool s_isGlslangInitialized;
+			static Optimization s_optimization; // performance when built with SPIRV-Tools
 
 			ShaderProvider() = delete;
 			~ShaderProvider() = delete;
 
+			// once per process until Reset, glslang's tables are shared by every compile
+			static void InitializeGlslang();
+
 		public:
+			// cooked SPIR-V of a mounted pack archive comes before the GLSL under assets/shader, whose compiled
+			// SPIR-V is kept in output/cache/shader and mapped on later launches
 			static void AddShader(const vk::UniqueDevice& logical_device,
 				const std::string& shader_code_path, const std::string& shader_key);
 
+			// every shader is added on the worker pool, "shader_key" stays the same for all of them;
+			// a future is ready once its shader can be taken by GetShader, get() rethrows a failed compile
+			static std::vector<std::future<void>> AddShaders(const vk::UniqueDevice& logical_device,
+				const std::vector<std::string>& shader_code_paths, const std::string& shader_key);
+
+			static bool IsOptimizationSupported(const Optimization& optimization);
+
+			// set before shaders are added, modules already added keep their code
+			static void SetOptimization(const Optimization& optimization);
+			static Optimization GetOptimization();
+
+			// GLSL under assets/shader to SPIR-V, through the same cache; safe to call from several threads
+			static std::vector<uint32_t> CompileShader(const std::string& shader_code_path);
+			static std::vector<uint32_t> CompileShader(const std::string& shader_code_path, CompileStat& compile_stat);
+
 			static const std::shared_ptr<Shader>& GetShader(
 				const std::string& shader_type_key, const std::string& shader_key);
 
-			static void Reset() { s_shaderDictionary.clear(); }
+			// the layout bindings of one descriptor set as the given stages declare it, a binding used by several
+			// stages gets all of their stage flags
+			static std::vector<vk::DescriptorSetLayoutBinding> GetLayoutBindings(
+				const std::vector<std::shared_ptr<Shader>>& shaders, const uint32_t& set = 0U);
+
+			// the layout bindings of every set up to the highest one the stages declare, a set between them that
+			// no stage uses has no bindings
+			static std::vector<std::vector<vk::DescriptorSetLayoutBinding>> GetSetLayoutBindings(
+				const std::vector<std::shared_ptr<Shader>>& shaders);
+
+			// one range per distinct block, stages with an equal block share its range
+			static std::vector<vk::PushConstantRange> GetPushConstantRanges(const std::vector<std::shared_ptr<Shader>>& shaders);
+
+			// also finalizes glslang
+			static void Reset();
 		};
 
 		class Image
@@ -245,7 +380,8 @@ namespace vk_interface
 				m_layout = std::move(other.m_layout);
 			}
 
-			virtual void SetPipeline(const vk::UniqueDevice& logical_device, const T& create_info) = 0;
+			virtual void SetPipeline(const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache,
+				const T& create_info) = 0;
 
 			virtual void SetLayout(const vk::UniqueDevice& logical_device, const vk::PipelineLayoutCreateInfo& create_info)
 			{
@@ -426,14 +562,19 @@ namespace vk_interface
 			void SetViewportAndScissor(const std::shared_ptr<SwapChain>& swap_chain);
 
 			void TransitionImageCommandLayout(const vk::Image& vk_image, const vk::Format& vk_format,
-				const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel);
+				const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel,
+				const uint32_t& layer_num = 1U);
 
 			void TransitionImageCommandLayout(const std::shared_ptr<Image>& vk_image, const vk::Format& vk_format,
-				const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel);
+				const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel,
+				const uint32_t& layer_num = 1U);
 
 			void CopyBuffer(const std::shared_ptr<Buffer>& src_buffer,
 				const std::shared_ptr<Buffer>& dst_buffer, const size_t& device_size);
 
+			void CopyBuffer(const std::shared_ptr<Buffer>& src_buffer, const std::shared_ptr<Buffer>& dst_buffer,
+				const size_t& device_size, const size_t& src_offset, const size_t& dst_offset);
+
 			void CopyTexture(const std::shared_ptr<Buffer>& staging_buffer,
 				const std::shared_ptr<Image>& texture_image, const vk::Extent2D& extent);
 
@@ -453,9 +594,95 @@ namespace vk_interface
 			Pipeline() = default;
 			~Pipeline() {}
 
-			virtual void SetPipeline(const vk::UniqueDevice& logical_device,
+			virtual void SetPipeline(const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache,
 				const vk::GraphicsPipelineCreateInfo& create_info) override;
 		};
+
+		// the whole state of a graphic pipeline; Build hashes it and hands out one shared pipeline per state, so
+		// every actor drawn the same way binds the same pipeline. Viewport and scissor are always dynamic
+		class PipelineBuilder
+		{
+		public:
+			using PipelineFuture = std::shared_future<std::shared_ptr<Pipeline>>;
+
+		protected:
+			struct ShaderStage
+			{
+				vk::ShaderStageFlagBits stage;
+				vk::ShaderModule module;
+				std::string entry_name;
+				component::SpecializationConstants specialization_constants;
+			};
+
+			// pipelines by state hash, kept until Reset; a pipeline still compiling is found as well
+			static std::unordered_map<uint64_t, PipelineFuture> s_pipelineDictionary;
+			static std::mutex s_mutex;
+
+			std::vector<ShaderStage> m_shaderStages;
+			std::vector<vk::VertexInputBindingDescription> m_vertexBindingDescs;
+			std::vector<vk::VertexInputAttributeDescription> m_vertexAttributeDescs;
+			vk::PrimitiveTopology m_topology = vk::PrimitiveTopology::eTriangleList;
+			vk::PolygonMode m_polygonMode = vk::PolygonMode::eFill;
+			vk::CullModeFlags m_cullMode = vk::CullModeFlagBits::eBack;
+			vk::FrontFace m_frontFace = vk::FrontFace::eCounterClockwise;
+			vk::SampleCountFlagBits m_sampleCount = vk::SampleCountFlagBits::e1;
+			vk::Bool32 m_isDepthTested = VK_TRUE;
+			vk::Bool32 m_isDepthWritten = VK_TRUE;
+			vk::CompareOp m_depthCompareOp = vk::CompareOp::eLess;
+			vk::PipelineColorBlendAttachmentState m_colorBlendAttachment;
+			std::vector<vk::DescriptorSetLayout> m_descriptorSetLayouts;
+			std::vector<vk::PushConstantRange> m_pushConstantRanges;
+			vk::RenderPass m_renderPass;
+			uint32_t m_subpass = 0U;
+
+		public:
+			PipelineBuilder();
+			~PipelineBuilder() {}
+
+			// each variant of the specialization constants is a pipeline of its own, the module is shared
+			PipelineBuilder& AddShaderStage(const vk::ShaderStageFlagBits& stage, const vk::ShaderModule& module,
+				const component::SpecializationConstants& specialization_constants = {}, const std::string& entry_name = "main");
+			PipelineBuilder& SetVertexInput(const vk::ArrayProxy<const vk::VertexInputBindingDescription>& binding_descs,
+				const vk::ArrayProxy<const vk::VertexInputAttributeDescription>& attribute_descs);
+			PipelineBuilder& SetTopology(const vk::PrimitiveTopology& topology);
+			PipelineBuilder& SetRasterization(const vk::PolygonMode& polygon_mode, const vk::CullModeFlags& cull_mode,
+				const vk::FrontFace& front_face);
+			PipelineBuilder& SetSampleCount(const vk::SampleCountFlagBits& sample_count);
+			PipelineBuilder& SetDepth(const vk::Bool32& is_tested, const vk::Bool32& is_written, const vk::CompareOp& compare_op);
+			PipelineBuilder& SetColorBlendAttachment(const vk::PipelineColorBlendAttachmentState& color_blend_attachment);
+			PipelineBuilder& SetLayout(const vk::ArrayProxy<const vk::DescriptorSetLayout>& descriptor_set_layouts,
+				const vk::ArrayProxy<const vk::PushConstantRange>& push_constant_ranges = {});
+			// the layout the stages declare: a descriptor set layout per set, the one every DescriptorSet of equal
+			// bindings shares, and their push constant ranges
+			PipelineBuilder& SetLayout(const vk::UniqueDevice& logical_device,
+				const std::vector<std::shared_ptr<component::Shader>>& shaders);
+			PipelineBuilder& SetRenderPass(const vk::RenderPass& render_pass, const uint32_t& subpass = 0U);
+
+			uint64_t GetHash() const;
+
+			// the pipeline built earlier from an equal state, even one still compiling, else a new one compiled on
+			// the worker pool; get() rethrows a failed compile
+			PipelineFuture BuildAsync(const vk::UniqueDevice& logical_device,
+				const vk::UniquePipelineCache& pipeline_cache) const;
+
+			// starts the pipelines of a scene or of actors spawned later while loading goes on: every factory runs
+			// on the worker pool, so the shaders it adds compile there too, and BuildAsync of an equal state picks
+			// the pipeline up; a factory must not wait for other tasks of the pool
+			static void Prewarm(const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache,
+				const std::vector<std::function<PipelineBuilder()>>& builder_factories);
+
+			static void Reset();
+
+		protected:
+			using PipelinePromise = std::promise<std::shared_ptr<Pipeline>>;
+
+			// the future of an equal state, else a new entry whose promise the caller has to keep
+			PipelineFuture FindOrReserve(const uint64_t& state_hash, std::shared_ptr<PipelinePromise>& ptr_promise) const;
+			void Fulfill(const uint64_t& state_hash, PipelinePromise& promise, const vk::UniqueDevice& logical_device,
+				const vk::UniquePipelineCache& pipeline_cache) const;
+			std::shared_ptr<Pipeline> Create(const vk::UniqueDevice& logical_device,
+				const vk::UniquePipelineCache& pipeline_cache) const;
+		};
 	};
 
 	namespace compute
@@ -468,9 +695,48 @@ namespace vk_interface
 			Pipeline() = default;
 			~Pipeline() {}
 
-			virtual void SetPipeline(const vk::UniqueDevice& logical_device,
+			virtual void SetPipeline(const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache,
 				const vk::ComputePipelineCreateInfo& create_info) override;
 		};
+
+		// the compute counterpart of graphic::PipelineBuilder: pipelines are shared by the hash of their state,
+		// specialization key included, but built on the calling thread since a dispatch is recorded right after
+		class PipelineBuilder
+		{
+		protected:
+			// pipelines by state hash, kept until Reset
+			static std::unordered_map<uint64_t, std::shared_ptr<Pipeline>> s_pipelineDictionary;
+			static std::mutex s_mutex;
+
+			vk::ShaderModule m_module;
+			std::string m_entryName = "main";
+			component::SpecializationConstants m_specializationConstants;
+			std::vector<vk::DescriptorSetLayout> m_descriptorSetLayouts;
+			std::vector<vk::PushConstantRange> m_pushConstantRanges;
+
+		public:
+			PipelineBuilder() = default;
+			~PipelineBuilder() {}
+
+			// each variant of the specialization constants is a pipeline of its own, the module is shared
+			PipelineBuilder& SetShaderStage(const vk::ShaderModule& module,
+				const component::SpecializationConstants& specialization_constants = {}, const std::string& entry_name = "main");
+			PipelineBuilder& SetLayout(const vk::ArrayProxy<const vk::DescriptorSetLayout>& descriptor_set_layouts,
+				const vk::ArrayProxy<const vk::PushConstantRange>& push_constant_ranges = {});
+			// the layout the stages declare: a descriptor set layout per set, the one every DescriptorSet of equal
+			// bindings shares, and their push constant ranges
+			PipelineBuilder& SetLayout(const vk::UniqueDevice& logical_device,
+				const std::vector<std::shared_ptr<component::Shader>>& shaders);
+
+			uint64_t GetHash() const;
+
+			// the pipeline built earlier from an equal state, else a new one; two threads building an equal
+			// state at once both compile, the first one is kept
+			std::shared_ptr<Pipeline> Build(const vk::UniqueDevice& logical_device,
+				const vk::UniquePipelineCache& pipeline_cache) const;
+
+			static void Reset();
+		};
 	};
 
 	namespace ray_tracing
@@ -483,7 +749,7 @@ namespace vk_interface
 			Pipeline() = default;
 			~Pipeline() {}
 
-			virtual void SetPipeline(const vk::UniqueDevice& logical_device,
+			virtual void SetPipeline(const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache,
 				const vk::RayTracingPipelineCreateInfoKHR& create_info) override;
 		};
 	};
@@ -498,6 +764,7 @@ namespace vk_interface
 		vk::UniqueSurfaceKHR m_windowSurface;
 		vk::PhysicalDevice m_physicalDevice;
 		vk::UniqueDevice m_logicalDevice;
+		vk::UniquePipelineCache m_pipelineCache; // every pipeline of the device is created through it
 		std::unordered_map<vk::QueueFlags, std::unordered_map<std::string, vk::Queue>>
 			m_queuesDictionary;
 		std::shared_ptr<component::SwapChain> m_ptrSwapChain;
@@ -524,6 +791,7 @@ namespace vk_interface
 		}
 
 		const auto& GetLogicalDevice() const { return m_logicalDevice; }
+		const auto& GetPipelineCache() const { return m_pipelineCache; }
 		const auto& GetSwapChain() const { return m_ptrSwapChain; }
 		const auto& GetPhysicalDevice() const { return m_physicalDevice; }
 		const auto& GetWindowSurface() const { return m_windowSurface; }
@@ -40,7 +40,8 @@ void vk_interface::component::CommandBuffer::SetViewportAndScissor(const std::sh
 }
 
 void vk_interface::component::CommandBuffer::TransitionImageCommandLayout(const vk::Image& vk_image,
-	const vk::Format& vk_format, const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel)
+	const vk::Format& vk_format, const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel,
+	const uint32_t& layer_num)
 {
 	const auto& [old_image_layout, new_image_layout] = transition_layout_pair;
 
@@ -48,6 +49,7 @@ void vk_interface::component::CommandBuffer::TransitionImageCommandLayout(const
 		vk::AccessFlagBits::eNone, old_image_layout, new_image_layout, 0, 0, vk_image,
 		vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
 	image_memory_barrier.subresourceRange.setLevelCount(miplevel);
+	image_memory_barrier.subresourceRange.setLayerCount(layer_num);
 
 	vk::PipelineStageFlags src_stage_flags;
 	vk::PipelineStageFlags dst_stage_flags;
@@ -91,9 +93,10 @@ void vk_interface::component::CommandBuffer::TransitionImageCommandLayout(const
 }
 
 void vk_interface::component::CommandBuffer::TransitionImageCommandLayout(const std::shared_ptr<Image>& vk_image,
-	const vk::Format& vk_format, const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel)
+	const vk::Format& vk_format, const std::pair<vk::ImageLayout, vk::ImageLayout>& transition_layout_pair, const uint32_t& miplevel,
+	const uint32_t& layer_num)
 {
-	TransitionImageCommandLayout(vk_image->GetImage().get(), vk_format, transition_layout_pair, miplevel);
+	TransitionImageCommandLayout(vk_image->GetImage().get(), vk_format, transition_layout_pair, miplevel, layer_num);
 }
 
 void vk_interface::component::CommandBuffer::CopyBuffer(const std::shared_ptr<Buffer>& src_buffer,
@@ -103,6 +106,13 @@ void vk_interface::component::CommandBuffer::CopyBuffer(const std::shared_ptr<Bu
 	m_commandBuffer->copyBuffer(src_buffer->GetBuffer().get(), dst_buffer->GetBuffer().get(), { copy_region });
 }
 
+void vk_interface::component::CommandBuffer::CopyBuffer(const std::shared_ptr<Buffer>& src_buffer,
+	const std::shared_ptr<Buffer>& dst_buffer, const size_t& device_size, const size_t& src_offset, const size_t& dst_offset)
+{
+	vk::BufferCopy copy_region(src_offset, dst_offset, device_size);
+	m_commandBuffer->copyBuffer(src_buffer->GetBuffer().get(), dst_buffer->GetBuffer().get(), { copy_region });
+}
+
 void vk_interface::component::CommandBuffer::CopyTexture(const std::shared_ptr<Buffer>& staging_buffer,
 	const std::shared_ptr<Image>& texture_image, const vk::Extent2D& extent)
 {
@@ -1,10 +1,31 @@
-#include "../Interface.hpp"
+#include "../../HephicsHelper.hpp"
+
+std::unordered_map<uint64_t, std::shared_ptr<vk::UniqueDescriptorSetLayout>>
+vk_interface::component::DescriptorSet::s_layoutDictionary;
+std::mutex vk_interface::component::DescriptorSet::s_layoutMutex;
+
+static uint64_t get_layout_hash(const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+	uint64_t layout_hash = 0U;
+	for (const auto& binding : bindings)
+	{
+		const std::array<uint32_t, 4> binding_values{ binding.binding, static_cast<uint32_t>(binding.descriptorType),
+			binding.descriptorCount, static_cast<uint32_t>(binding.stageFlags) };
+		layout_hash = hephics_helper::hash::compute_xxh64(binding_values.data(), sizeof(binding_values), layout_hash);
+
+		if (binding.pImmutableSamplers != nullptr)
+			layout_hash = hephics_helper::hash::compute_xxh64(binding.pImmutableSamplers,
+				sizeof(vk::Sampler) * binding.descriptorCount, layout_hash);
+	}
+
+	return layout_hash;
+}
 
 void vk_interface::component::DescriptorSet::SetDescriptorSetLayout(const vk::UniqueDevice& logical_device,
 	const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
 {
-	vk::DescriptorSetLayoutCreateInfo layout_create_info({}, bindings);
-	m_descriptorSetLayout = logical_device->createDescriptorSetLayoutUnique(layout_create_info, nullptr);
+	m_ptrDescriptorSetLayout = GetSharedLayout(logical_device, bindings);
+	m_layoutBindings = bindings;
 }
 
 void vk_interface::component::DescriptorSet::SetDescriptorPool(const vk::UniqueDevice& logical_device,
@@ -13,9 +34,24 @@ void vk_interface::component::DescriptorSet::SetDescriptorPool(const vk::UniqueD
 	m_descriptorPool = logical_device->createDescriptorPoolUnique(create_info);
 }
 
-void vk_interface::component::DescriptorSet::SetDescriptorSet(const vk::UniqueDevice& logical_device, const uint8_t& concurrent_frame_num)
+void vk_interface::component::DescriptorSet::SetDescriptorPool(const vk::UniqueDevice& logical_device,
+	const uint32_t& set_num)
 {
-	std::vector<vk::DescriptorSetLayout> desc_set_layouts(concurrent_frame_num, m_descriptorSetLayout.get());
+	std::map<vk::DescriptorType, uint32_t> descriptor_nums;
+	for (const auto& binding : m_layoutBindings)
+		descriptor_nums[binding.descriptorType] += binding.descriptorCount * set_num;
+
+	std::vector<vk::DescriptorPoolSize> pool_sizes;
+	for (const auto& [descriptor_type, descriptor_num] : descriptor_nums)
+		pool_sizes.emplace_back(descriptor_type, descriptor_num);
+
+	vk::DescriptorPoolCreateInfo create_info(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, set_num, pool_sizes);
+	SetDescriptorPool(logical_device, create_info);
+}
+
+void vk_interface::component::DescriptorSet::SetDescriptorSet(const vk::UniqueDevice& logical_device, const uint32_t& set_num)
+{
+	std::vector<vk::DescriptorSetLayout> desc_set_layouts(set_num, m_ptrDescriptorSetLayout->get());
 	vk::DescriptorSetAllocateInfo alloc_info(m_descriptorPool.get(), desc_set_layouts);
 	m_descriptorSets = logical_device->allocateDescriptorSetsUnique(alloc_info);
 }
@@ -27,4 +63,31 @@ void vk_interface::component::DescriptorSet::UpdateDescriptorSet(const vk::Uniqu
 		write_descriptor.setDstSet(m_descriptorSets.at(target_idx).get());
 
 	logical_device->updateDescriptorSets(write_descriptor_sets, nullptr);
+}
+
+std::shared_ptr<vk::UniqueDescriptorSetLayout> vk_interface::component::DescriptorSet::GetSharedLayout(
+	const vk::UniqueDevice& logical_device, const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+	const auto layout_hash = get_layout_hash(bindings);
+
+	{
+		std::lock_guard<std::mutex> lock(s_layoutMutex);
+		const auto layout_it = s_layoutDictionary.find(layout_hash);
+		if (layout_it != s_layoutDictionary.end())
+			return layout_it->second;
+	}
+
+	vk::DescriptorSetLayoutCreateInfo layout_create_info({}, bindings);
+	auto ptr_layout = std::make_shared<vk::UniqueDescriptorSetLayout>(
+		logical_device->createDescriptorSetLayoutUnique(layout_create_info, nullptr));
+
+	// an equal layout made meanwhile on another thread wins, this one is dropped
+	std::lock_guard<std::mutex> lock(s_layoutMutex);
+	return s_layoutDictionary.try_emplace(layout_hash, std::move(ptr_layout)).first->second;
+}
+
+void vk_interface::component::DescriptorSet::ResetLayouts()
+{
+	std::lock_guard<std::mutex> lock(s_layoutMutex);
+	s_layoutDictionary.clear();
 }
\ No newline at end of file
@@ -1,9 +1,44 @@
-#include "../Interface.hpp"
+#include "../../HephicsHelper.hpp"
+
+std::unordered_map<uint64_t, vk_interface::graphic::PipelineBuilder::PipelineFuture>
+vk_interface::graphic::PipelineBuilder::s_pipelineDictionary;
+std::mutex vk_interface::graphic::PipelineBuilder::s_mutex;
+std::unordered_map<uint64_t, std::shared_ptr<vk_interface::compute::Pipeline>>
+vk_interface::compute::PipelineBuilder::s_pipelineDictionary;
+std::mutex vk_interface::compute::PipelineBuilder::s_mutex;
+
+template<typename T>
+static void hash_value(uint64_t& state_hash, const T& value)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "hash_value: hashed by its bytes");
+	state_hash = hephics_helper::hash::compute_xxh64(&value, sizeof(T), state_hash);
+}
+
+// the count is hashed too, so [a, b][] and [a][b] differ
+template<typename T>
+static void hash_values(uint64_t& state_hash, const std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "hash_values: hashed by their bytes");
+	hash_value(state_hash, values.size());
+	state_hash = hephics_helper::hash::compute_xxh64(values.data(), sizeof(T) * values.size(), state_hash);
+}
+
+// the layouts stay in DescriptorSet's dictionary until ResetLayouts, a builder keeps only their handles
+static std::vector<vk::DescriptorSetLayout> get_reflected_set_layouts(const vk::UniqueDevice& logical_device,
+	const std::vector<std::shared_ptr<vk_interface::component::Shader>>& shaders)
+{
+	std::vector<vk::DescriptorSetLayout> descriptor_set_layouts;
+	for (const auto& layout_bindings : vk_interface::component::ShaderProvider::GetSetLayoutBindings(shaders))
+		descriptor_set_layouts.push_back(
+			vk_interface::component::DescriptorSet::GetSharedLayout(logical_device, layout_bindings)->get());
+
+	return descriptor_set_layouts;
+}
 
 void vk_interface::graphic::Pipeline::SetPipeline(const vk::UniqueDevice& logical_device,
-	const vk::GraphicsPipelineCreateInfo& create_info)
+	const vk::UniquePipelineCache& pipeline_cache, const vk::GraphicsPipelineCreateInfo& create_info)
 {
-	auto create_option = logical_device->createGraphicsPipelineUnique({}, create_info);
+	auto create_option = logical_device->createGraphicsPipelineUnique(pipeline_cache.get(), create_info);
 	if (create_option.result == vk::Result::eSuccess)
 		m_pipeline = std::move(create_option.value);
 	else
@@ -11,9 +46,9 @@ void vk_interface::graphic::Pipeline::SetPipeline(const vk::UniqueDevice& logica
 }
 
 void vk_interface::compute::Pipeline::SetPipeline(const vk::UniqueDevice& logical_device,
-	const vk::ComputePipelineCreateInfo& create_info)
+	const vk::UniquePipelineCache& pipeline_cache, const vk::ComputePipelineCreateInfo& create_info)
 {
-	auto create_option = logical_device->createComputePipelineUnique({}, create_info);
+	auto create_option = logical_device->createComputePipelineUnique(pipeline_cache.get(), create_info);
 	if (create_option.result == vk::Result::eSuccess)
 		m_pipeline = std::move(create_option.value);
 	else
@@ -21,11 +56,339 @@ void vk_interface::compute::Pipeline::SetPipeline(const vk::UniqueDevice& logica
 }
 
 void vk_interface::ray_tracing::Pipeline::SetPipeline(const vk::UniqueDevice& logical_device,
-	const vk::RayTracingPipelineCreateInfoKHR& create_info)
+	const vk::UniquePipelineCache& pipeline_cache, const vk::RayTracingPipelineCreateInfoKHR& create_info)
 {
-	auto create_option = logical_device->createRayTracingPipelineKHRUnique({}, {}, create_info);
+	auto create_option = logical_device->createRayTracingPipelineKHRUnique({}, pipeline_cache.get(), create_info);
 	if (create_option.result == vk::Result::eSuccess)
 		m_pipeline = std::move(create_option.value);
 	else
 		throw std::runtime_error("failed to create a pipeline!");
+}
+
+vk_interface::graphic::PipelineBuilder::PipelineBuilder()
+{
+	m_colorBlendAttachment.setColorWriteMask(
+		vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
+		| vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::AddShaderStage(
+	const vk::ShaderStageFlagBits& stage, const vk::ShaderModule& module,
+	const component::SpecializationConstants& specialization_constants, const std::string& entry_name)
+{
+	m_shaderStages.emplace_back(ShaderStage{ stage, module, entry_name, specialization_constants });
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetVertexInput(
+	const vk::ArrayProxy<const vk::VertexInputBindingDescription>& binding_descs,
+	const vk::ArrayProxy<const vk::VertexInputAttributeDescription>& attribute_descs)
+{
+	m_vertexBindingDescs.assign(binding_descs.begin(), binding_descs.end());
+	m_vertexAttributeDescs.assign(attribute_descs.begin(), attribute_descs.end());
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetTopology(
+	const vk::PrimitiveTopology& topology)
+{
+	m_topology = topology;
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetRasterization(
+	const vk::PolygonMode& polygon_mode, const vk::CullModeFlags& cull_mode, const vk::FrontFace& front_face)
+{
+	m_polygonMode = polygon_mode;
+	m_cullMode = cull_mode;
+	m_frontFace = front_face;
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetSampleCount(
+	const vk::SampleCountFlagBits& sample_count)
+{
+	m_sampleCount = sample_count;
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetDepth(
+	const vk::Bool32& is_tested, const vk::Bool32& is_written, const vk::CompareOp& compare_op)
+{
+	m_isDepthTested = is_tested;
+	m_isDepthWritten = is_written;
+	m_depthCompareOp = compare_op;
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetColorBlendAttachment(
+	const vk::PipelineColorBlendAttachmentState& color_blend_attachment)
+{
+	m_colorBlendAttachment = color_blend_attachment;
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetLayout(
+	const vk::ArrayProxy<const vk::DescriptorSetLayout>& descriptor_set_layouts,
+	const vk::ArrayProxy<const vk::PushConstantRange>& push_constant_ranges)
+{
+	m_descriptorSetLayouts.assign(descriptor_set_layouts.begin(), descriptor_set_layouts.end());
+	m_pushConstantRanges.assign(push_constant_ranges.begin(), push_constant_ranges.end());
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetLayout(
+	const vk::UniqueDevice& logical_device, const std::vector<std::shared_ptr<component::Shader>>& shaders)
+{
+	m_descriptorSetLayouts = get_reflected_set_layouts(logical_device, shaders);
+	m_pushConstantRanges = component::ShaderProvider::GetPushConstantRanges(shaders);
+	return *this;
+}
+
+vk_interface::graphic::PipelineBuilder& vk_interface::graphic::PipelineBuilder::SetRenderPass(
+	const vk::RenderPass& render_pass, const uint32_t& subpass)
+{
+	m_renderPass = render_pass;
+	m_subpass = subpass;
+	return *this;
+}
+
+// handles stand for their objects: shader modules and descriptor set layouts are shared by their providers,
+// so equal descriptions arrive here as equal handles
+uint64_t vk_interface::graphic::PipelineBuilder::GetHash() const
+{
+	uint64_t state_hash = 0U;
+
+	hash_value(state_hash, m_shaderStages.size());
+	for (const auto& [stage, module, entry_name, specialization_constants] : m_shaderStages)
+	{
+		hash_value(state_hash, stage);
+		hash_value(state_hash, module);
+		state_hash = hephics_helper::hash::compute_xxh64(entry_name.data(), entry_name.size(), state_hash);
+		hash_value(state_hash, specialization_constants.GetHash());
+	}
+
+	hash_values(state_hash, m_vertexBindingDescs);
+	hash_values(state_hash, m_vertexAttributeDescs);
+	hash_value(state_hash, m_topology);
+	hash_value(state_hash, m_polygonMode);
+	hash_value(state_hash, m_cullMode);
+	hash_value(state_hash, m_frontFace);
+	hash_value(state_hash, m_sampleCount);
+	hash_value(state_hash, m_isDepthTested);
+	hash_value(state_hash, m_isDepthWritten);
+	hash_value(state_hash, m_depthCompareOp);
+	hash_value(state_hash, m_colorBlendAttachment);
+	hash_values(state_hash, m_descriptorSetLayouts);
+	hash_values(state_hash, m_pushConstantRanges);
+	hash_value(state_hash, m_renderPass);
+	hash_value(state_hash, m_subpass);
+
+	return state_hash;
+}
+
+vk_interface::graphic::PipelineBuilder::PipelineFuture vk_interface::graphic::PipelineBuilder::BuildAsync(
+	const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache) const
+{
+	const auto state_hash = GetHash();
+
+	std::shared_ptr<PipelinePromise> ptr_promise;
+	auto pipeline_future = FindOrReserve(state_hash, ptr_promise);
+	if (ptr_promise)
+	{
+		// the builder is copied, the device and the cache live as long as the instance
+		hephics_helper::WorkerPool::Submit(
+			[pipeline_builder = *this, state_hash, ptr_promise, &logical_device, &pipeline_cache]
+			{
+				pipeline_builder.Fulfill(state_hash, *ptr_promise, logical_device, pipeline_cache);
+			});
+	}
+
+	return pipeline_future;
+}
+
+void vk_interface::graphic::PipelineBuilder::Prewarm(const vk::UniqueDevice& logical_device,
+	const vk::UniquePipelineCache& pipeline_cache, const std::vector<std::function<PipelineBuilder()>>& builder_factories)
+{
+	// a failed factory is dropped here, the actor that needs the pipeline hits the error again
+	for (const auto& builder_factory : builder_factories)
+	{
+		hephics_helper::WorkerPool::Submit([builder_factory, &logical_device, &pipeline_cache]
+			{
+				const auto pipeline_builder = builder_factory();
+				const auto state_hash = pipeline_builder.GetHash();
+
+				std::shared_ptr<PipelinePromise> ptr_promise;
+				pipeline_builder.FindOrReserve(state_hash, ptr_promise);
+				if (ptr_promise)
+					pipeline_builder.Fulfill(state_hash, *ptr_promise, logical_device, pipeline_cache);
+			});
+	}
+}
+
+vk_interface::graphic::PipelineBuilder::PipelineFuture vk_interface::graphic::PipelineBuilder::FindOrReserve(
+	const uint64_t& state_hash, std::shared_ptr<PipelinePromise>& ptr_promise) const
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	const auto pipeline_it = s_pipelineDictionary.find(state_hash);
+	if (pipeline_it != s_pipelineDictionary.end())
+		return pipeline_it->second;
+
+	ptr_promise = std::make_shared<PipelinePromise>();
+	return s_pipelineDictionary.emplace(state_hash, ptr_promise->get_future().share()).first->second;
+}
+
+void vk_interface::graphic::PipelineBuilder::Fulfill(const uint64_t& state_hash, PipelinePromise& promise,
+	const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache) const
+{
+	try
+	{
+		promise.set_value(Create(logical_device, pipeline_cache));
+#ifdef _DEBUG
+		std::cout << std::format("graphic_pipeline: {:016x} created\n", state_hash);
+#endif
+	}
+	catch (const std::exception&)
+	{
+		// whoever waits gets the error, the next request of this state compiles again
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_pipelineDictionary.erase(state_hash);
+		}
+		promise.set_exception(std::current_exception());
+	}
+}
+
+std::shared_ptr<vk_interface::graphic::Pipeline> vk_interface::graphic::PipelineBuilder::Create(
+	const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache) const
+{
+	// reserved, the stage infos point into it
+	std::vector<vk::SpecializationInfo> specialization_infos;
+	specialization_infos.reserve(m_shaderStages.size());
+
+	std::vector<vk::PipelineShaderStageCreateInfo> shader_stage_infos;
+	for (const auto& [stage, module, entry_name, specialization_constants] : m_shaderStages)
+	{
+		const auto& specialization_info = specialization_infos.emplace_back(specialization_constants.GetInfo());
+		shader_stage_infos.emplace_back(vk::PipelineShaderStageCreateFlags{}, stage, module, entry_name.c_str(),
+			specialization_constants.IsEmpty() ? nullptr : &specialization_info);
+	}
+
+	vk::PipelineVertexInputStateCreateInfo vertex_input_info({}, m_vertexBindingDescs, m_vertexAttributeDescs);
+
+	vk::PipelineInputAssemblyStateCreateInfo input_assembly({}, m_topology, VK_FALSE);
+
+	vk::PipelineViewportStateCreateInfo viewport_state({}, 1, {}, 1, {});
+
+	vk::PipelineRasterizationStateCreateInfo rasterizer({}, VK_FALSE, VK_FALSE,
+		m_polygonMode, m_cullMode, m_frontFace, VK_FALSE, 0.0f, 0.0f, 0.0f, 1.0f);
+
+	vk::PipelineMultisampleStateCreateInfo multisampling({}, m_sampleCount, VK_FALSE);
+
+	vk::PipelineDepthStencilStateCreateInfo depth_stencil({}, m_isDepthTested, m_isDepthWritten,
+		m_depthCompareOp, VK_FALSE, VK_FALSE);
+	depth_stencil.setMinDepthBounds(0.0f);
+	depth_stencil.setMaxDepthBounds(1.0f);
+
+	vk::PipelineColorBlendStateCreateInfo color_blending({}, VK_FALSE, vk::LogicOp::eCopy, m_colorBlendAttachment);
+
+	std::vector<vk::DynamicState> dynamic_states =
+	{
+		vk::DynamicState::eScissor, vk::DynamicState::eViewport
+	};
+	vk::PipelineDynamicStateCreateInfo dynamic_state_info({}, dynamic_states);
+
+	auto ptr_pipeline = std::make_shared<Pipeline>();
+	vk::PipelineLayoutCreateInfo pipeline_layout_info({}, m_descriptorSetLayouts, m_pushConstantRanges);
+	ptr_pipeline->SetLayout(logical_device, pipeline_layout_info);
+
+	vk::GraphicsPipelineCreateInfo pipeline_info({}, shader_stage_infos, &vertex_input_info, &input_assembly, {},
+		&viewport_state, &rasterizer, &multisampling, &depth_stencil, &color_blending, &dynamic_state_info,
+		ptr_pipeline->GetLayout().get(), m_renderPass, m_subpass);
+	ptr_pipeline->SetPipeline(logical_device, pipeline_cache, pipeline_info);
+
+	return ptr_pipeline;
+}
+
+void vk_interface::graphic::PipelineBuilder::Reset()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_pipelineDictionary.clear();
+}
+
+vk_interface::compute::PipelineBuilder& vk_interface::compute::PipelineBuilder::SetShaderStage(
+	const vk::ShaderModule& module, const component::SpecializationConstants& specialization_constants,
+	const std::string& entry_name)
+{
+	m_module = module;
+	m_specializationConstants = specialization_constants;
+	m_entryName = entry_name;
+	return *this;
+}
+
+vk_interface::compute::PipelineBuilder& vk_interface::compute::PipelineBuilder::SetLayout(
+	const vk::ArrayProxy<const vk::DescriptorSetLayout>& descriptor_set_layouts,
+	const vk::ArrayProxy<const vk::PushConstantRange>& push_constant_ranges)
+{
+	m_descriptorSetLayouts.assign(descriptor_set_layouts.begin(), descriptor_set_layouts.end());
+	m_pushConstantRanges.assign(push_constant_ranges.begin(), push_constant_ranges.end());
+	return *this;
+}
+
+vk_interface::compute::PipelineBuilder& vk_interface::compute::PipelineBuilder::SetLayout(
+	const vk::UniqueDevice& logical_device, const std::vector<std::shared_ptr<component::Shader>>& shaders)
+{
+	m_descriptorSetLayouts = get_reflected_set_layouts(logical_device, shaders);
+	m_pushConstantRanges = component::ShaderProvider::GetPushConstantRanges(shaders);
+	return *this;
+}
+
+// handles stand for their objects, like the graphic state
+uint64_t vk_interface::compute::PipelineBuilder::GetHash() const
+{
+	uint64_t state_hash = 0U;
+
+	hash_value(state_hash, m_module);
+	state_hash = hephics_helper::hash::compute_xxh64(m_entryName.data(), m_entryName.size(), state_hash);
+	hash_value(state_hash, m_specializationConstants.GetHash());
+	hash_values(state_hash, m_descriptorSetLayouts);
+	hash_values(state_hash, m_pushConstantRanges);
+
+	return state_hash;
+}
+
+std::shared_ptr<vk_interface::compute::Pipeline> vk_interface::compute::PipelineBuilder::Build(
+	const vk::UniqueDevice& logical_device, const vk::UniquePipelineCache& pipeline_cache) const
+{
+	const auto state_hash = GetHash();
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		const auto pipeline_it = s_pipelineDictionary.find(state_hash);
+		if (pipeline_it != s_pipelineDictionary.end())
+			return pipeline_it->second;
+	}
+
+	const auto specialization_info = m_specializationConstants.GetInfo();
+	vk::PipelineShaderStageCreateInfo shader_stage_info({}, vk::ShaderStageFlagBits::eCompute, m_module,
+		m_entryName.c_str(), m_specializationConstants.IsEmpty() ? nullptr : &specialization_info);
+
+	auto ptr_pipeline = std::make_shared<Pipeline>();
+	vk::PipelineLayoutCreateInfo pipeline_layout_info({}, m_descriptorSetLayouts, m_pushConstantRanges);
+	ptr_pipeline->SetLayout(logical_device, pipeline_layout_info);
+
+	vk::ComputePipelineCreateInfo pipeline_info({}, shader_stage_info, ptr_pipeline->GetLayout().get(), {});
+	ptr_pipeline->SetPipeline(logical_device, pipeline_cache, pipeline_info);
+
+#ifdef _DEBUG
+	std::cout << std::format("compute_pipeline: {:016x} created\n", state_hash);
+#endif
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	return s_pipelineDictionary.emplace(state_hash, std::move(ptr_pipeline)).first->second;
+}
+
+void vk_interface::compute::PipelineBuilder::Reset()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_pipelineDictionary.clear();
 }
\ No newline at end of file
@@ -1,12 +1,338 @@
-#include "../Interface.hpp"
+#include "../../HephicsHelper.hpp"
+
+// the optimizer needs SPIRV-Tools at build time, without it glslang's output is used as is
+#if __has_include(<spirv-tools/optimizer.hpp>)
+#include <spirv-tools/optimizer.hpp>
+#define HEPHICS_USE_SPIRV_OPT
+#endif
 
 std::unordered_map<std::string, std::unordered_map<std::string, std::shared_ptr<vk_interface::component::Shader>>>
 vk_interface::component::ShaderProvider::s_shaderDictionary;
+std::mutex vk_interface::component::ShaderProvider::s_mutex;
+bool vk_interface::component::ShaderProvider::s_isGlslangInitialized = false;
+#ifdef HEPHICS_USE_SPIRV_OPT
+vk_interface::component::ShaderProvider::Optimization vk_interface::component::ShaderProvider::s_optimization =
+	Optimization::performance;
+#else
+vk_interface::component::ShaderProvider::Optimization vk_interface::component::ShaderProvider::s_optimization =
+	Optimization::none;
+#endif
+
+constexpr auto SPIRV_TARGET_VERSION = glslang::EShTargetLanguageVersion::EShTargetSpv_1_5;
+constexpr uint32_t SPIRV_MAGIC = 0x07230203U;
+
+// the few SPIR-V opcodes, decorations and enumerants resource reflection needs, see the SPIR-V specification
+namespace spirv
+{
+	constexpr uint32_t HEADER_WORD_NUM = 5U;
+
+	constexpr uint32_t OP_ENTRY_POINT = 15U;
+	constexpr uint32_t OP_TYPE_INT = 21U;
+	constexpr uint32_t OP_TYPE_FLOAT = 22U;
+	constexpr uint32_t OP_TYPE_VECTOR = 23U;
+	constexpr uint32_t OP_TYPE_MATRIX = 24U;
+	constexpr uint32_t OP_TYPE_IMAGE = 25U;
+	constexpr uint32_t OP_TYPE_SAMPLER = 26U;
+	constexpr uint32_t OP_TYPE_SAMPLED_IMAGE = 27U;
+	constexpr uint32_t OP_TYPE_ARRAY = 28U;
+	constexpr uint32_t OP_TYPE_RUNTIME_ARRAY = 29U;
+	constexpr uint32_t OP_TYPE_STRUCT = 30U;
+	constexpr uint32_t OP_TYPE_POINTER = 32U;
+	constexpr uint32_t OP_CONSTANT = 43U;
+	constexpr uint32_t OP_VARIABLE = 59U;
+	constexpr uint32_t OP_DECORATE = 71U;
+	constexpr uint32_t OP_MEMBER_DECORATE = 72U;
+	constexpr uint32_t OP_TYPE_ACCELERATION_STRUCTURE = 5341U;
+
+	constexpr uint32_t DECORATION_BLOCK = 2U;
+	constexpr uint32_t DECORATION_BUFFER_BLOCK = 3U;
+	constexpr uint32_t DECORATION_ARRAY_STRIDE = 6U;
+	constexpr uint32_t DECORATION_MATRIX_STRIDE = 7U;
+	constexpr uint32_t DECORATION_BINDING = 33U;
+	constexpr uint32_t DECORATION_DESCRIPTOR_SET = 34U;
+	constexpr uint32_t DECORATION_OFFSET = 35U;
+
+	constexpr uint32_t STORAGE_CLASS_UNIFORM_CONSTANT = 0U;
+	constexpr uint32_t STORAGE_CLASS_UNIFORM = 2U;
+	constexpr uint32_t STORAGE_CLASS_PUSH_CONSTANT = 9U;
+	constexpr uint32_t STORAGE_CLASS_STORAGE_BUFFER = 12U;
+
+	constexpr uint32_t DIM_BUFFER = 5U;
+	constexpr uint32_t DIM_SUBPASS_DATA = 6U;
+};
+
+// every instruction starts with its word count in the upper half of its first word
+static size_t count_instructions(const std::span<const uint32_t>& spv_words)
+{
+	size_t instruction_num = 0U;
+	for (size_t word_idx = spirv::HEADER_WORD_NUM; word_idx < spv_words.size(); instruction_num++)
+	{
+		const auto word_num = spv_words[word_idx] >> 16U;
+		if (word_num == 0U)
+			break;
+
+		word_idx += word_num;
+	}
+
+	return instruction_num;
+}
+
+static vk::ShaderStageFlags translate_execution_model(const uint32_t& execution_model)
+{
+	switch (execution_model)
+	{
+	case 0U: return vk::ShaderStageFlagBits::eVertex;
+	case 4U: return vk::ShaderStageFlagBits::eFragment;
+	case 5U: return vk::ShaderStageFlagBits::eCompute;
+	case 5313U: return vk::ShaderStageFlagBits::eRaygenKHR;
+	case 5314U: return vk::ShaderStageFlagBits::eIntersectionKHR;
+	case 5315U: return vk::ShaderStageFlagBits::eAnyHitKHR;
+	case 5316U: return vk::ShaderStageFlagBits::eClosestHitKHR;
+	case 5317U: return vk::ShaderStageFlagBits::eMissKHR;
+	default: throw std::runtime_error("shader_reflection: unsupported execution model");
+	}
+}
+
+struct ShaderReflection
+{
+	std::vector<vk_interface::component::ReflectedBinding> bindings;
+	std::optional<vk::PushConstantRange> push_constant_range;
+};
+
+// every variable with a descriptor set and a binding, its type decides the descriptor type; arrays of resources
+// count their elements, a runtime array counts as one. The push constant block spans from its first member to
+// the end of its last one, as its explicit offsets and strides lay it out
+static ShaderReflection reflect_shader(const std::span<const uint32_t>& spv_words)
+{
+	if (spv_words.size() < spirv::HEADER_WORD_NUM || spv_words.front() != SPIRV_MAGIC)
+		throw std::runtime_error("shader_reflection: not a SPIR-V module");
+
+	struct TypeInfo
+	{
+		uint32_t opcode = 0U;
+		std::vector<uint32_t> operands; // the words after the result id
+	};
+
+	std::unordered_map<uint32_t, TypeInfo> types;
+	std::unordered_map<uint32_t, uint32_t> constants;
+	std::unordered_map<uint32_t, uint32_t> descriptor_sets;
+	std::unordered_map<uint32_t, uint32_t> bindings;
+	std::unordered_map<uint32_t, uint32_t> array_strides;
+	std::map<std::pair<uint32_t, uint32_t>, uint32_t> member_offsets; // by struct type id and member index
+	std::map<std::pair<uint32_t, uint32_t>, uint32_t> member_matrix_strides;
+	std::unordered_set<uint32_t> blocks;
+	std::unordered_set<uint32_t> buffer_blocks;
+	std::vector<std::pair<uint32_t, uint32_t>> variables; // result id, pointer type id
+	std::vector<uint32_t> push_constant_pointer_type_ids;
+	vk::ShaderStageFlags stage_flags;
+
+	for (size_t word_idx = spirv::HEADER_WORD_NUM; word_idx < spv_words.size();)
+	{
+		const auto word_num = spv_words[word_idx] >> 16U;
+		const auto opcode = spv_words[word_idx] & 0xffffU;
+		if (word_num == 0U || word_idx + word_num > spv_words.size())
+			throw std::runtime_error("shader_reflection: broken instruction");
+
+		const auto instruction = spv_words.subspan(word_idx, word_num);
+		switch (opcode)
+		{
+		case spirv::OP_ENTRY_POINT:
+			stage_flags |= translate_execution_model(instruction[1]);
+			break;
+		case spirv::OP_DECORATE:
+			if (instruction[2] == spirv::DECORATION_DESCRIPTOR_SET)
+				descriptor_sets[instruction[1]] = instruction[3];
+			else if (instruction[2] == spirv::DECORATION_BINDING)
+				bindings[instruction[1]] = instruction[3];
+			else if (instruction[2] == spirv::DECORATION_BLOCK)
+				blocks.insert(instruction[1]);
+			else if (instruction[2] == spirv::DECORATION_BUFFER_BLOCK)
+				buffer_blocks.insert(instruction[1]);
+			else if (instruction[2] == spirv::DECORATION_ARRAY_STRIDE)
+				array_strides[instruction[1]] = instruction[3];
+			break;
+		case spirv::OP_MEMBER_DECORATE:
+			if (instruction[3] == spirv::DECORATION_OFFSET)
+				member_offsets[{ instruction[1], instruction[2] }] = instruction[4];
+			else if (instruction[3] == spirv::DECORATION_MATRIX_STRIDE)
+				member_matrix_strides[{ instruction[1], instruction[2] }] = instruction[4];
+			break;
+		case spirv::OP_TYPE_INT:
+		case spirv::OP_TYPE_FLOAT:
+		case spirv::OP_TYPE_VECTOR:
+		case spirv::OP_TYPE_MATRIX:
+		case spirv::OP_TYPE_IMAGE:
+		case spirv::OP_TYPE_SAMPLER:
+		case spirv::OP_TYPE_SAMPLED_IMAGE:
+		case spirv::OP_TYPE_ARRAY:
+		case spirv::OP_TYPE_RUNTIME_ARRAY:
+		case spirv::OP_TYPE_STRUCT:
+		case spirv::OP_TYPE_POINTER:
+		case spirv::OP_TYPE_ACCELERATION_STRUCTURE:
+		{
+			types.emplace(instruction[1], TypeInfo{ opcode, std::vector<uint32_t>(instruction.begin() + 2U, instruction.end()) });
+			break;
+		}
+		case spirv::OP_CONSTANT:
+			constants[instruction[2]] = instruction[3]; // the low word is enough for an array length
+			break;
+		case spirv::OP_VARIABLE:
+			if (instruction[3] == spirv::STORAGE_CLASS_UNIFORM_CONSTANT || instruction[3] == spirv::STORAGE_CLASS_UNIFORM
+				|| instruction[3] == spirv::STORAGE_CLASS_STORAGE_BUFFER)
+				variables.emplace_back(instruction[2], instruction[1]);
+			else if (instruction[3] == spirv::STORAGE_CLASS_PUSH_CONSTANT)
+				push_constant_pointer_type_ids.push_back(instruction[1]);
+			break;
+		}
+
+		word_idx += word_num;
+	}
+
+	ShaderReflection reflection;
+	for (const auto& [variable_id, pointer_type_id] : variables)
+	{
+		if (!bindings.contains(variable_id))
+			continue;
+
+		const auto& pointer_type = types.at(pointer_type_id);
+		const auto storage_class = pointer_type.operands.at(0);
+		auto type_id = pointer_type.operands.at(1);
+
+		uint32_t descriptor_count = 1U;
+		while (types.at(type_id).opcode == spirv::OP_TYPE_ARRAY || types.at(type_id).opcode == spirv::OP_TYPE_RUNTIME_ARRAY)
+		{
+			const auto& array_type = types.at(type_id);
+			if (array_type.opcode == spirv::OP_TYPE_ARRAY)
+				descriptor_count *= constants.at(array_type.operands.at(1));
+			type_id = array_type.operands.at(0);
+		}
+
+		const auto& type = types.at(type_id);
+		vk::DescriptorType descriptor_type;
+		switch (type.opcode)
+		{
+		case spirv::OP_TYPE_STRUCT:
+			if (storage_class == spirv::STORAGE_CLASS_STORAGE_BUFFER || buffer_blocks.contains(type_id))
+				descriptor_type = vk::DescriptorType::eStorageBuffer;
+			else if (blocks.contains(type_id))
+				descriptor_type = vk::DescriptorType::eUniformBuffer;
+			else
+				throw std::runtime_error("shader_reflection: buffer without a block decoration");
+			break;
+		case spirv::OP_TYPE_SAMPLED_IMAGE:
+			descriptor_type = vk::DescriptorType::eCombinedImageSampler;
+			break;
+		case spirv::OP_TYPE_SAMPLER:
+			descriptor_type = vk::DescriptorType::eSampler;
+			break;
+		case spirv::OP_TYPE_IMAGE:
+		{
+			// operands: sampled type, dim, depth, arrayed, multisampled, sampled (1: with a sampler, 2: storage)
+			const auto dim = type.operands.at(1);
+			const auto is_storage = type.operands.at(5) == 2U;
+			if (dim == spirv::DIM_SUBPASS_DATA)
+				descriptor_type = vk::DescriptorType::eInputAttachment;
+			else if (dim == spirv::DIM_BUFFER)
+				descriptor_type = is_storage ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+			else
+				descriptor_type = is_storage ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+			break;
+		}
+		case spirv::OP_TYPE_ACCELERATION_STRUCTURE:
+			descriptor_type = vk::DescriptorType::eAccelerationStructureKHR;
+			break;
+		default:
+			throw std::runtime_error("shader_reflection: unsupported resource type");
+		}
+
+		const auto set = descriptor_sets.contains(variable_id) ? descriptor_sets.at(variable_id) : 0U;
+		reflection.bindings.emplace_back(vk_interface::component::ReflectedBinding{ set,
+			vk::DescriptorSetLayoutBinding(bindings.at(variable_id), descriptor_type, descriptor_count, stage_flags, nullptr) });
+	}
+
+	if (push_constant_pointer_type_ids.empty())
+		return reflection;
+	if (push_constant_pointer_type_ids.size() > 1U)
+		throw std::runtime_error("shader_reflection: more than one push constant block");
+
+	// a matrix takes the stride of the member holding it, an array without a stride is packed
+	const std::function<uint32_t(const uint32_t&, const uint32_t&)> get_type_size =
+		[&](const uint32_t& type_id, const uint32_t& matrix_stride) -> uint32_t
+	{
+		const auto& type = types.at(type_id);
+		switch (type.opcode)
+		{
+		case spirv::OP_TYPE_INT:
+		case spirv::OP_TYPE_FLOAT:
+			return type.operands.at(0) / 8U;
+		case spirv::OP_TYPE_VECTOR:
+			return get_type_size(type.operands.at(0), 0U) * type.operands.at(1);
+		case spirv::OP_TYPE_MATRIX:
+			return (matrix_stride != 0U ? matrix_stride : get_type_size(type.operands.at(0), 0U)) * type.operands.at(1);
+		case spirv::OP_TYPE_ARRAY:
+		{
+			const auto array_stride = array_strides.contains(type_id)
+				? array_strides.at(type_id) : get_type_size(type.operands.at(0), matrix_stride);
+			return array_stride * constants.at(type.operands.at(1));
+		}
+		case spirv::OP_TYPE_STRUCT:
+		{
+			uint32_t struct_size = 0U;
+			for (uint32_t member_idx = 0U; member_idx < type.operands.size(); member_idx++)
+			{
+				const auto member_key = std::make_pair(type_id, member_idx);
+				const auto member_offset = member_offsets.contains(member_key) ? member_offsets.at(member_key) : 0U;
+				const auto member_matrix_stride =
+					member_matrix_strides.contains(member_key) ? member_matrix_strides.at(member_key) : 0U;
+				struct_size = std::max(struct_size,
+					member_offset + get_type_size(type.operands.at(member_idx), member_matrix_stride));
+			}
+			return struct_size;
+		}
+		case spirv::OP_TYPE_POINTER:
+			return 8U; // a buffer reference
+		default:
+			throw std::runtime_error("shader_reflection: unsupported push constant member type");
+		}
+	};
+
+	const auto block_type_id = types.at(push_constant_pointer_type_ids.front()).operands.at(1);
+	const auto& block_type = types.at(block_type_id);
+	if (block_type.opcode != spirv::OP_TYPE_STRUCT || block_type.operands.empty())
+		throw std::runtime_error("shader_reflection: push constants without a block");
+
+	auto block_offset = std::numeric_limits<uint32_t>::max();
+	for (uint32_t member_idx = 0U; member_idx < block_type.operands.size(); member_idx++)
+	{
+		const auto member_key = std::make_pair(block_type_id, member_idx);
+		block_offset = std::min(block_offset, member_offsets.contains(member_key) ? member_offsets.at(member_key) : 0U);
+	}
+
+	// ranges are counted in whole words
+	const auto block_size = get_type_size(block_type_id, 0U) - block_offset;
+	reflection.push_constant_range = vk::PushConstantRange(stage_flags, block_offset, (block_size + 3U) & ~3U);
+
+	return reflection;
+}
 
 void vk_interface::component::Shader::SetModule(const vk::UniqueDevice& logical_device,
 	const vk::ShaderModuleCreateInfo& create_info)
 {
 	m_module = logical_device->createShaderModuleUnique(create_info);
+
+	auto reflection = reflect_shader(std::span<const uint32_t>(create_info.pCode, create_info.codeSize / sizeof(uint32_t)));
+	m_reflectedBindings = std::move(reflection.bindings);
+	m_reflectedPushConstantRange = reflection.push_constant_range;
+}
+
+uint64_t vk_interface::component::SpecializationConstants::GetHash() const
+{
+	std::vector<std::pair<uint32_t, uint32_t>> constants;
+	for (const auto& map_entry : m_mapEntries)
+		constants.emplace_back(map_entry.constantID, m_values.at(map_entry.offset / sizeof(uint32_t)));
+	std::sort(constants.begin(), constants.end());
+
+	return hephics_helper::hash::compute_xxh64(constants.data(), sizeof(std::pair<uint32_t, uint32_t>) * constants.size());
 }
 
 static std::pair<std::string, ::EShLanguage> translate_shader_stage(const std::string& shader_code_path)
@@ -139,19 +465,17 @@ static TBuiltInResource init_t_built_in_resources()
 	return resources;
 }
 
+// glslang is initialized by the caller, every call has its own TShader and TProgram and may run on any thread
 static auto compile_shader(const ::EShLanguage& shader_stage, const std::string& shader_code)
 {
-	glslang::InitializeProcess();
-
 	std::vector shader_c_strings = { shader_code.data() };
 
 	glslang::TShader shader(shader_stage);
-	shader.setEnvTarget(glslang::EShTargetLanguage::EShTargetSpv,
-		glslang::EShTargetLanguageVersion::EShTargetSpv_1_5);
+	shader.setEnvTarget(glslang::EShTargetLanguage::EShTargetSpv, SPIRV_TARGET_VERSION);
 	shader.setStrings(shader_c_strings.data(), static_cast<int32_t>(shader_c_strings.size()));
 
 	EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
-	const auto t_built_in_resources = init_t_built_in_resources();
+	static const auto t_built_in_resources = init_t_built_in_resources();
 	if (!shader.parse(&t_built_in_resources, 100, false, messages))
 		throw std::runtime_error(shader_code + "\n" + shader.getInfoLog());
 
@@ -163,22 +487,65 @@ static auto compile_shader(const ::EShLanguage& shader_stage, const std::string&
 
 	std::vector<uint32_t> spv_binary;
 	glslang::GlslangToSpv(*program.getIntermediate(shader_stage), spv_binary);
-	glslang::FinalizeProcess();
 
 	return spv_binary;
 }
 
-void vk_interface::component::ShaderProvider::AddShader(const vk::UniqueDevice& logical_device,
-	const std::string& shader_code_path, const std::string& shader_key)
+// bindings and specialization constants are kept even when unused: the layouts are reflected from the
+// result and the pipelines still set every constant_id
+static void optimize_spirv(std::vector<uint32_t>& spv_binary,
+	[[maybe_unused]] const vk_interface::component::ShaderProvider::Optimization& optimization,
+	[[maybe_unused]] const std::string& shader_code_path,
+	vk_interface::component::ShaderProvider::CompileStat& compile_stat)
 {
-	const auto [shader_type_str, shader_stage] = translate_shader_stage(shader_code_path);
+	compile_stat.compiled_instruction_num = count_instructions(spv_binary);
+	compile_stat.instruction_num = compile_stat.compiled_instruction_num;
 
-	if (!s_shaderDictionary.contains(shader_type_str))
-		s_shaderDictionary[shader_type_str] = {};
+#ifdef HEPHICS_USE_SPIRV_OPT
+	using Optimization = vk_interface::component::ShaderProvider::Optimization;
+	if (optimization == Optimization::none)
+		return;
 
-	if (s_shaderDictionary.at(shader_type_str).contains(shader_key))
+	spvtools::Optimizer optimizer(SPV_ENV_VULKAN_1_2); // SPIR-V 1.5, the glslang target
+	std::string optimizer_message;
+	optimizer.SetMessageConsumer([&optimizer_message](spv_message_level_t, const char*,
+		const spv_position_t&, const char* message)
+		{
+			optimizer_message += std::format("{}\n", message);
+		});
+
+	if (optimization == Optimization::size)
+		optimizer.RegisterSizePasses();
+	else
+		optimizer.RegisterPerformancePasses();
+
+	spvtools::OptimizerOptions optimizer_options;
+	optimizer_options.set_preserve_bindings(true);
+	optimizer_options.set_preserve_spec_constants(true);
+
+	std::vector<uint32_t> optimized_binary;
+	if (!optimizer.Run(spv_binary.data(), spv_binary.size(), &optimized_binary, optimizer_options))
+	{
+		// the optimization is optional, the module glslang gave is still valid
+#ifdef _DEBUG
+		std::cerr << std::format("shader_opt: {} is kept unoptimized\n{}", shader_code_path, optimizer_message);
+#endif
 		return;
+	}
+
+	compile_stat.instruction_num = count_instructions(optimized_binary);
+
+#ifdef _DEBUG
+	std::cout << std::format("shader_opt: {} {} -> {} instructions\n", shader_code_path,
+		compile_stat.compiled_instruction_num, compile_stat.instruction_num);
+#endif
 
+	spv_binary = std::move(optimized_binary);
+#endif
+}
+
+static std::string read_shader_code(const std::string& shader_code_path)
+{
 	std::ifstream ifs(std::format("assets/shader/{}", shader_code_path));
 	if (!ifs.is_open())
 		throw std::runtime_error("Failed to open file: " + shader_code_path);
@@ -186,18 +553,247 @@ void vk_interface::component::ShaderProvider::AddShader(const vk::UniqueDevice&
 	std::stringstream buffer;
 	buffer << ifs.rdbuf();
 
-	const auto spv_binary = compile_shader(shader_stage, buffer.str());
+	return buffer.str();
+}
+
+// named by a hash of everything the binary depends on: the source text, the stage, the SPIR-V target, the
+// optimization and the glslang and SPIRV-Tools versions, so a stale entry is never found and needs no check
+static std::filesystem::path get_spirv_cache_path(const std::string& shader_code_path, const std::string& shader_code,
+	const ::EShLanguage& shader_stage, const vk_interface::component::ShaderProvider::Optimization& optimization)
+{
+	const auto glslang_version = glslang::GetVersion();
+	const std::array<int64_t, 6> compile_settings{ shader_stage, SPIRV_TARGET_VERSION, static_cast<int64_t>(optimization),
+		glslang_version.major, glslang_version.minor, glslang_version.patch };
+	auto compile_hash = hephics_helper::hash::compute_xxh64(compile_settings.data(), sizeof(compile_settings));
+	if (glslang_version.flavor != nullptr)
+	{
+		const std::string_view flavor(glslang_version.flavor);
+		compile_hash = hephics_helper::hash::compute_xxh64(flavor.data(), flavor.size(), compile_hash);
+	}
+
+#ifdef HEPHICS_USE_SPIRV_OPT
+	// the version string names the release and the commit it was built from
+	const std::string_view spirv_tools_version(spvSoftwareVersionDetailsString());
+	compile_hash = hephics_helper::hash::compute_xxh64(spirv_tools_version.data(), spirv_tools_version.size(), compile_hash);
+#endif
+
+	const auto source_hash = hephics_helper::hash::compute_xxh64(shader_code.data(), shader_code.size(), compile_hash);
+	const auto shader_file_name = std::filesystem::path(shader_code_path).filename().string();
+
+	return std::filesystem::path(std::format("output/cache/shader/{}_{:016x}.spv", shader_file_name, source_hash));
+}
+
+// nullptr: not cached yet, or the file is no SPIR-V module
+static std::unique_ptr<hephics_helper::MappedFile> map_spirv_cache(const std::filesystem::path& cache_path)
+{
+	std::error_code error_code;
+	if (!std::filesystem::exists(cache_path, error_code))
+		return nullptr;
+
+	auto ptr_mapped_file = std::make_unique<hephics_helper::MappedFile>();
+	try
+	{
+		ptr_mapped_file->Open(cache_path);
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+
+	const auto& spv_size = ptr_mapped_file->GetSize();
+	if (spv_size < sizeof(uint32_t) || spv_size % sizeof(uint32_t) != 0U
+		|| ptr_mapped_file->GetSpan<uint32_t>(0U, 1U).front() != SPIRV_MAGIC)
+		return nullptr;
+
+	return ptr_mapped_file;
+}
+
+static void write_spirv_cache(const std::filesystem::path& cache_path, const std::vector<uint32_t>& spv_binary)
+{
+	auto temp_path = cache_path;
+	temp_path += ".tmp";
+
+	try
+	{
+		std::filesystem::create_directories(cache_path.parent_path());
+
+		{
+			std::ofstream ofs(temp_path, std::ios::binary | std::ios::trunc);
+			if (!ofs.is_open())
+				throw std::runtime_error("Failed to open file: " + temp_path.string());
+
+			ofs.write(reinterpret_cast<const char*>(spv_binary.data()), sizeof(uint32_t) * spv_binary.size());
+			if (!ofs.good())
+				throw std::runtime_error("Failed to write file: " + temp_path.string());
+		}
+
+		// a reader never maps a half written module
+		std::filesystem::rename(temp_path, cache_path);
+	}
+	catch ([[maybe_unused]] const std::exception& exception)
+	{
+		// the cache is an optimization only: the next launch compiles again
+		std::error_code error_code;
+		std::filesystem::remove(temp_path, error_code);
+#ifdef _DEBUG
+		std::cerr << std::format("shader_cache: {}\n", exception.what());
+#endif
+	}
+}
+
+void vk_interface::component::ShaderProvider::InitializeGlslang()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	if (s_isGlslangInitialized)
+		return;
+
+	glslang::InitializeProcess();
+	s_isGlslangInitialized = true;
+}
+
+bool vk_interface::component::ShaderProvider::IsOptimizationSupported(const Optimization& optimization)
+{
+	switch (optimization)
+	{
+	case Optimization::none:
+		return true;
+	case Optimization::performance:
+	case Optimization::size:
+#ifdef HEPHICS_USE_SPIRV_OPT
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+void vk_interface::component::ShaderProvider::SetOptimization(const Optimization& optimization)
+{
+	if (!IsOptimizationSupported(optimization))
+		throw std::runtime_error("shader: built without SPIRV-Tools");
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_optimization = optimization;
+}
+
+vk_interface::component::ShaderProvider::Optimization vk_interface::component::ShaderProvider::GetOptimization()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	return s_optimization;
+}
+
+std::vector<uint32_t> vk_interface::component::ShaderProvider::CompileShader(const std::string& shader_code_path)
+{
+	CompileStat compile_stat;
+	return CompileShader(shader_code_path, compile_stat);
+}
+
+std::vector<uint32_t> vk_interface::component::ShaderProvider::CompileShader(const std::string& shader_code_path,
+	CompileStat& compile_stat)
+{
+	const auto [shader_type_str, shader_stage] = translate_shader_stage(shader_code_path);
+
+	const auto optimization = GetOptimization();
+	const auto shader_code = read_shader_code(shader_code_path);
+	const auto cache_path = get_spirv_cache_path(shader_code_path, shader_code, shader_stage, optimization);
+	if (const auto ptr_cached_spirv = map_spirv_cache(cache_path))
+	{
+		const auto spv_words = ptr_cached_spirv->GetSpan<uint32_t>(0U, ptr_cached_spirv->GetSize() / sizeof(uint32_t));
+		compile_stat = CompileStat{ true, 0U, count_instructions(spv_words) };
+		return std::vector<uint32_t>(spv_words.begin(), spv_words.end());
+	}
+
+	InitializeGlslang();
+	auto spv_binary = compile_shader(shader_stage, shader_code);
+	optimize_spirv(spv_binary, optimization, shader_code_path, compile_stat);
+	write_spirv_cache(cache_path, spv_binary);
+
+	return spv_binary;
+}
+
+void vk_interface::component::ShaderProvider::AddShader(const vk::UniqueDevice& logical_device,
+	const std::string& shader_code_path, const std::string& shader_key)
+{
+	const auto [shader_type_str, shader_stage] = translate_shader_stage(shader_code_path);
+
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		if (!s_shaderDictionary.contains(shader_type_str))
+			s_shaderDictionary[shader_type_str] = {};
+
+		if (s_shaderDictionary.at(shader_type_str).contains(shader_key))
+			return;
+	}
+
 	vk::ShaderModuleCreateInfo create_info;
-	create_info.setCode(spv_binary);
+	std::vector<uint32_t> spv_binary;
+	std::unique_ptr<hephics_helper::MappedFile> ptr_cached_spirv; // mapped until the module is created
+
+	// cooked entries are aligned, the module is created straight from the mapped pack
+	const auto cooked_shader = hephics_helper::PackArchive::Load(
+		hephics_helper::PackArchive::GetEntryName(std::format("assets/shader/{}", shader_code_path)));
+	if (cooked_shader)
+	{
+		const auto spv_bytes = cooked_shader->GetBytes();
+		if (spv_bytes.empty() || spv_bytes.size() % sizeof(uint32_t) != 0U)
+			throw std::runtime_error("shader: broken cooked SPIR-V in " + shader_code_path);
+
+		create_info.setCodeSize(spv_bytes.size());
+		create_info.setPCode(reinterpret_cast<const uint32_t*>(spv_bytes.data()));
+	}
+	else
+	{
+		// a cache hit skips glslang, the module is created straight from the mapped file
+		const auto optimization = GetOptimization();
+		const auto shader_code = read_shader_code(shader_code_path);
+		const auto cache_path = get_spirv_cache_path(shader_code_path, shader_code, shader_stage, optimization);
+		ptr_cached_spirv = map_spirv_cache(cache_path);
+		if (ptr_cached_spirv)
+		{
+			create_info.setCodeSize(ptr_cached_spirv->GetSize());
+			create_info.setPCode(reinterpret_cast<const uint32_t*>(ptr_cached_spirv->GetData()));
+		}
+		else
+		{
+			InitializeGlslang();
+			spv_binary = compile_shader(shader_stage, shader_code);
+			CompileStat compile_stat;
+			optimize_spirv(spv_binary, optimization, shader_code_path, compile_stat);
+			write_spirv_cache(cache_path, spv_binary);
+			create_info.setCode(spv_binary);
+		}
+	}
 
 	Shader shader;
 	shader.SetModule(logical_device, create_info);
+
+	// the same shader added twice at once keeps the module that came first
+	std::lock_guard<std::mutex> lock(s_mutex);
 	s_shaderDictionary.at(shader_type_str).emplace(shader_key, std::make_shared<Shader>(std::move(shader)));
 }
 
+std::vector<std::future<void>> vk_interface::component::ShaderProvider::AddShaders(const vk::UniqueDevice& logical_device,
+	const std::vector<std::string>& shader_code_paths, const std::string& shader_key)
+{
+	std::vector<std::future<void>> futures;
+	for (const auto& shader_code_path : shader_code_paths)
+	{
+		futures.emplace_back(hephics_helper::WorkerPool::Submit([&logical_device, shader_code_path, shader_key]
+			{
+				AddShader(logical_device, shader_code_path, shader_key);
+			}));
+	}
+
+	return futures;
+}
+
 const std::shared_ptr<vk_interface::component::Shader>&
 vk_interface::component::ShaderProvider::GetShader(const std::string& shader_type_key, const std::string& shader_key)
 {
+	// elements keep their address while other shaders are added
+	std::lock_guard<std::mutex> lock(s_mutex);
 	if (!s_shaderDictionary.contains(shader_type_key))
 		throw std::runtime_error("shader: not found");
 
@@ -205,4 +801,87 @@ vk_interface::component::ShaderProvider::GetShader(const std::string& shader_typ
 		throw std::runtime_error("shader: not found");
 
 	return s_shaderDictionary.at(shader_type_key).at(shader_key);
+}
+
+std::vector<vk::DescriptorSetLayoutBinding> vk_interface::component::ShaderProvider::GetLayoutBindings(
+	const std::vector<std::shared_ptr<Shader>>& shaders, const uint32_t& set)
+{
+	std::map<uint32_t, vk::DescriptorSetLayoutBinding> layout_bindings;
+	for (const auto& ptr_shader : shaders)
+	{
+		for (const auto& [binding_set, layout_binding] : ptr_shader->GetReflectedBindings())
+		{
+			if (binding_set != set)
+				continue;
+
+			const auto [binding_it, is_inserted] = layout_bindings.emplace(layout_binding.binding, layout_binding);
+			if (is_inserted)
+				continue;
+
+			if (binding_it->second.descriptorType != layout_binding.descriptorType
+				|| binding_it->second.descriptorCount != layout_binding.descriptorCount)
+				throw std::runtime_error(std::format("shader_reflection: binding {} differs between stages", layout_binding.binding));
+
+			binding_it->second.stageFlags |= layout_binding.stageFlags;
+		}
+	}
+
+	std::vector<vk::DescriptorSetLayoutBinding> sorted_bindings;
+	for (const auto& [binding, layout_binding] : layout_bindings)
+		sorted_bindings.push_back(layout_binding);
+
+	return sorted_bindings;
+}
+
+std::vector<std::vector<vk::DescriptorSetLayoutBinding>> vk_interface::component::ShaderProvider::GetSetLayoutBindings(
+	const std::vector<std::shared_ptr<Shader>>& shaders)
+{
+	uint32_t set_num = 0U;
+	for (const auto& ptr_shader : shaders)
+	{
+		for (const auto& reflected_binding : ptr_shader->GetReflectedBindings())
+			set_num = std::max(set_num, reflected_binding.set + 1U);
+	}
+
+	std::vector<std::vector<vk::DescriptorSetLayoutBinding>> set_layout_bindings;
+	for (uint32_t set = 0U; set < set_num; set++)
+		set_layout_bindings.push_back(GetLayoutBindings(shaders, set));
+
+	return set_layout_bindings;
+}
+
+std::vector<vk::PushConstantRange> vk_interface::component::ShaderProvider::GetPushConstantRanges(
+	const std::vector<std::shared_ptr<Shader>>& shaders)
+{
+	std::vector<vk::PushConstantRange> push_constant_ranges;
+	for (const auto& ptr_shader : shaders)
+	{
+		const auto& reflected_range = ptr_shader->GetReflectedPushConstantRange();
+		if (!reflected_range.has_value())
+			continue;
+
+		const auto range_it = std::find_if(push_constant_ranges.begin(), push_constant_ranges.end(),
+			[&reflected_range](const vk::PushConstantRange& push_constant_range)
+			{
+				return push_constant_range.offset == reflected_range->offset && push_constant_range.size == reflected_range->size;
+			});
+		if (range_it != push_constant_ranges.end())
+			range_it->stageFlags |= reflected_range->stageFlags;
+		else
+			push_constant_ranges.push_back(reflected_range.value());
+	}
+
+	return push_constant_ranges;
+}
+
+void vk_interface::component::ShaderProvider::Reset()
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_shaderDictionary.clear();
+
+	if (s_isGlslangInitialized)
+	{
+		glslang::FinalizeProcess();
+		s_isGlslangInitialized = false;
+	}
 }
\ No newline at end of file